@@ -0,0 +1,363 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "TPSAdaptiveNetSubsystem.h"
+#include "Engine/World.h"
+#include "Engine/NetDriver.h"
+#include "GameFramework/Actor.h"
+#include "Misc/App.h"
+#include "HAL/IConsoleManager.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "ThirdPersonMP.h"
+
+CSV_DEFINE_CATEGORY(AdaptiveNet, true);
+
+namespace TPSAdaptiveNet
+{
+	static bool bEnabled = true;
+	static FAutoConsoleVariableRef CVarEnabled(
+		TEXT("TPS.Net.Adaptive.Enabled"),
+		bEnabled,
+		TEXT("If true, the server scales its tick rate, net update frequencies and AI LOD distances with its frame time."));
+
+	static int32 NumLevels = 4;
+	static FAutoConsoleVariableRef CVarNumLevels(
+		TEXT("TPS.Net.Adaptive.NumLevels"),
+		NumLevels,
+		TEXT("Number of load levels between full fidelity and the configured minimums."));
+
+	static int32 ForceLevel = -1;
+	static FAutoConsoleVariableRef CVarForceLevel(
+		TEXT("TPS.Net.Adaptive.ForceLevel"),
+		ForceLevel,
+		TEXT("If zero or greater, the load level is locked to this value instead of following the frame time."));
+
+	static float RaiseLoad = 0.9f;
+	static FAutoConsoleVariableRef CVarRaiseLoad(
+		TEXT("TPS.Net.Adaptive.RaiseLoad"),
+		RaiseLoad,
+		TEXT("Fraction of the frame budget above which the load level is raised."));
+
+	static float LowerLoad = 0.6f;
+	static FAutoConsoleVariableRef CVarLowerLoad(
+		TEXT("TPS.Net.Adaptive.LowerLoad"),
+		LowerLoad,
+		TEXT("Fraction of the frame budget below which the load level is lowered."));
+
+	static float RaiseDelay = 0.5f;
+	static FAutoConsoleVariableRef CVarRaiseDelay(
+		TEXT("TPS.Net.Adaptive.RaiseDelay"),
+		RaiseDelay,
+		TEXT("Time the load must stay above the raise threshold before the level goes up, in seconds."));
+
+	static float LowerDelay = 3.0f;
+	static FAutoConsoleVariableRef CVarLowerDelay(
+		TEXT("TPS.Net.Adaptive.LowerDelay"),
+		LowerDelay,
+		TEXT("Time the load must stay below the lower threshold before the level goes down, in seconds."));
+
+	static float SmoothingTime = 0.25f;
+	static FAutoConsoleVariableRef CVarSmoothingTime(
+		TEXT("TPS.Net.Adaptive.SmoothingTime"),
+		SmoothingTime,
+		TEXT("Time constant of the frame time smoothing, in seconds."));
+
+	static int32 MinTickRate = 20;
+	static FAutoConsoleVariableRef CVarMinTickRate(
+		TEXT("TPS.Net.Adaptive.MinTickRate"),
+		MinTickRate,
+		TEXT("Server max tick rate applied at the highest load level."));
+
+	static float ProjectileMinScale = 0.5f;
+	static FAutoConsoleVariableRef CVarProjectileMinScale(
+		TEXT("TPS.Net.Adaptive.ProjectileMinScale"),
+		ProjectileMinScale,
+		TEXT("Scale applied to the projectile net update frequency at the highest load level."));
+
+	static float EnemyMinScale = 0.33f;
+	static FAutoConsoleVariableRef CVarEnemyMinScale(
+		TEXT("TPS.Net.Adaptive.EnemyMinScale"),
+		EnemyMinScale,
+		TEXT("Scale applied to the enemy net update frequency at the highest load level."));
+
+	static float PropMinScale = 0.25f;
+	static FAutoConsoleVariableRef CVarPropMinScale(
+		TEXT("TPS.Net.Adaptive.PropMinScale"),
+		PropMinScale,
+		TEXT("Scale applied to the prop net update frequency at the highest load level."));
+
+	static float AILODMinScale = 0.5f;
+	static FAutoConsoleVariableRef CVarAILODMinScale(
+		TEXT("TPS.Net.Adaptive.AILODMinScale"),
+		AILODMinScale,
+		TEXT("Scale applied to the AI LOD distances at the highest load level."));
+
+	static FAutoConsoleCommandWithWorld DumpCommand(
+		TEXT("TPS.Net.Adaptive.Dump"),
+		TEXT("Logs the server load, the current load level and the values applied for it."),
+		FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+		{
+			if (UTPSAdaptiveNetSubsystem* AdaptiveNet = UTPSAdaptiveNetSubsystem::Get(World))
+			{
+				AdaptiveNet->DumpToLog();
+			}
+		}));
+
+	/** Returns the net update frequency scale at the highest load level for a class */
+	static float GetMinScale(ETPSAdaptiveNetClass NetClass)
+	{
+		switch (NetClass)
+		{
+		case ETPSAdaptiveNetClass::Projectile:
+			return ProjectileMinScale;
+
+		case ETPSAdaptiveNetClass::Enemy:
+			return EnemyMinScale;
+
+		default:
+			return PropMinScale;
+		}
+	}
+}
+
+UTPSAdaptiveNetSubsystem* UTPSAdaptiveNetSubsystem::Get(const UWorld* World)
+{
+	return World ? World->GetSubsystem<UTPSAdaptiveNetSubsystem>() : nullptr;
+}
+
+void UTPSAdaptiveNetSubsystem::RegisterActor(AActor* Actor, ETPSAdaptiveNetClass NetClass)
+{
+	// only server actors replicate anything
+	if (!Actor || NetClass >= ETPSAdaptiveNetClass::Num || !Actor->HasAuthority() || !IsServer())
+	{
+		return;
+	}
+
+	const float BaseFrequency = Actor->GetNetUpdateFrequency();
+	ClassActors[static_cast<uint8>(NetClass)].Add(Actor, BaseFrequency);
+
+	// catch up with the current level
+	if (Level > 0)
+	{
+		ApplyNetUpdateFrequency(Actor, NetClass, BaseFrequency);
+	}
+}
+
+void UTPSAdaptiveNetSubsystem::UnregisterActor(AActor* Actor, ETPSAdaptiveNetClass NetClass)
+{
+	if (NetClass < ETPSAdaptiveNetClass::Num)
+	{
+		ClassActors[static_cast<uint8>(NetClass)].Remove(Actor);
+	}
+}
+
+void UTPSAdaptiveNetSubsystem::DumpToLog() const
+{
+	UE_LOG(LogThirdPersonMP, Log, TEXT("Adaptive net: frame %.2f ms, load %.2f, level %d/%d. Tick rate: %d (base %d), AI LOD distance scale: %.2f"),
+		SmoothedFrameMs,
+		Load,
+		Level,
+		TPSAdaptiveNet::NumLevels,
+		GetWorld()->GetNetDriver() ? GetWorld()->GetNetDriver()->GetNetServerMaxTickRate() : 0,
+		BaseTickRate,
+		AILODDistanceScale);
+
+	for (uint8 i = 0; i < static_cast<uint8>(ETPSAdaptiveNetClass::Num); ++i)
+	{
+		const float Scale = FMath::Lerp(1.0f, TPSAdaptiveNet::GetMinScale(static_cast<ETPSAdaptiveNetClass>(i)), GetLevelAlpha());
+
+		UE_LOG(LogThirdPersonMP, Log, TEXT("  Class %d: %d actors, net update frequency scale %.2f"), i, ClassActors[i].Num(), Scale);
+	}
+}
+
+void UTPSAdaptiveNetSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (!IsServer())
+	{
+		return;
+	}
+
+	// latch the configured tick rate the first time the net driver is around
+	UNetDriver* NetDriver = GetWorld()->GetNetDriver();
+
+	if (NetDriver && BaseTickRate == 0)
+	{
+		BaseTickRate = NetDriver->GetNetServerMaxTickRate();
+	}
+
+	// drop back to full fidelity if we've been turned off
+	if (!TPSAdaptiveNet::bEnabled)
+	{
+		if (Level > 0)
+		{
+			SetLevel(0, TEXT("disabled"));
+		}
+
+		return;
+	}
+
+	// measure the work done this frame, excluding the time spent idling to hold the tick rate
+	const float FrameMs = static_cast<float>(FMath::Max(0.0, FApp::GetDeltaTime() - FApp::GetIdleTime()) * 1000.0);
+	const float SmoothingAlpha = 1.0f - FMath::Exp(-DeltaTime / FMath::Max(TPSAdaptiveNet::SmoothingTime, UE_KINDA_SMALL_NUMBER));
+	SmoothedFrameMs = FMath::Lerp(SmoothedFrameMs, FrameMs, SmoothingAlpha);
+
+	// compare against the base budget so our own tick rate changes don't feed back into the load
+	const float BudgetMs = 1000.0f / FMath::Max(BaseTickRate > 0 ? BaseTickRate : 30, 1);
+	Load = SmoothedFrameMs / BudgetMs;
+
+	CSV_CUSTOM_STAT(AdaptiveNet, FrameMs, SmoothedFrameMs, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(AdaptiveNet, Load, Load, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(AdaptiveNet, Level, Level, ECsvCustomStatOp::Set);
+
+	const int32 MaxLevel = FMath::Max(0, TPSAdaptiveNet::NumLevels);
+
+	// a forced level skips the controller entirely
+	if (TPSAdaptiveNet::ForceLevel >= 0)
+	{
+		const int32 ForcedLevel = FMath::Min(TPSAdaptiveNet::ForceLevel, MaxLevel);
+
+		if (ForcedLevel != Level)
+		{
+			SetLevel(ForcedLevel, TEXT("forced"));
+		}
+
+		return;
+	}
+
+	// accumulate time spent on either side of the hysteresis band
+	if (Load > TPSAdaptiveNet::RaiseLoad)
+	{
+		OverloadTime += DeltaTime;
+		UnderloadTime = 0.0f;
+	}
+	else if (Load < TPSAdaptiveNet::LowerLoad)
+	{
+		UnderloadTime += DeltaTime;
+		OverloadTime = 0.0f;
+	}
+	else
+	{
+		OverloadTime = 0.0f;
+		UnderloadTime = 0.0f;
+	}
+
+	// step one level at a time
+	if (OverloadTime >= TPSAdaptiveNet::RaiseDelay && Level < MaxLevel)
+	{
+		SetLevel(Level + 1, TEXT("overload"));
+	}
+	else if (UnderloadTime >= TPSAdaptiveNet::LowerDelay && Level > 0)
+	{
+		SetLevel(Level - 1, TEXT("headroom"));
+	}
+	else if (Level > MaxLevel)
+	{
+		SetLevel(MaxLevel, TEXT("level count changed"));
+	}
+}
+
+TStatId UTPSAdaptiveNetSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UTPSAdaptiveNetSubsystem, STATGROUP_Tickables);
+}
+
+bool UTPSAdaptiveNetSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UTPSAdaptiveNetSubsystem::Deinitialize()
+{
+	RestoreDefaults();
+
+	for (TMap<TWeakObjectPtr<AActor>, float>& Actors : ClassActors)
+	{
+		Actors.Reset();
+	}
+
+	Super::Deinitialize();
+}
+
+bool UTPSAdaptiveNetSubsystem::IsServer() const
+{
+	const ENetMode NetMode = GetWorld()->GetNetMode();
+
+	return NetMode == NM_DedicatedServer || NetMode == NM_ListenServer;
+}
+
+void UTPSAdaptiveNetSubsystem::SetLevel(int32 NewLevel, const TCHAR* Reason)
+{
+	UE_LOG(LogThirdPersonMP, Log, TEXT("Adaptive net: level %d -> %d (%s). Frame %.2f ms, load %.2f"), Level, NewLevel, Reason, SmoothedFrameMs, Load);
+	CSV_EVENT(AdaptiveNet, TEXT("Level %d -> %d (%s) load %.2f"), Level, NewLevel, Reason, Load);
+
+	Level = NewLevel;
+	OverloadTime = 0.0f;
+	UnderloadTime = 0.0f;
+
+	ApplyLevel();
+}
+
+void UTPSAdaptiveNetSubsystem::ApplyLevel()
+{
+	const float Alpha = GetLevelAlpha();
+
+	// scale the server tick rate
+	if (UNetDriver* NetDriver = GetWorld()->GetNetDriver())
+	{
+		if (BaseTickRate > 0)
+		{
+			const int32 MinTickRate = FMath::Clamp(TPSAdaptiveNet::MinTickRate, 1, BaseTickRate);
+			const int32 TickRate = FMath::RoundToInt(FMath::Lerp(static_cast<float>(BaseTickRate), static_cast<float>(MinTickRate), Alpha));
+
+			NetDriver->SetNetServerMaxTickRate(TickRate);
+
+			CSV_CUSTOM_STAT(AdaptiveNet, TickRate, TickRate, ECsvCustomStatOp::Set);
+		}
+	}
+
+	// scale the net update frequency of each registered class
+	for (uint8 i = 0; i < static_cast<uint8>(ETPSAdaptiveNetClass::Num); ++i)
+	{
+		for (auto It = ClassActors[i].CreateIterator(); It; ++It)
+		{
+			if (AActor* Actor = It.Key().Get())
+			{
+				ApplyNetUpdateFrequency(Actor, static_cast<ETPSAdaptiveNetClass>(i), It.Value());
+			}
+			else
+			{
+				It.RemoveCurrent();
+			}
+		}
+	}
+
+	// pull the AI LOD distances in
+	AILODDistanceScale = FMath::Lerp(1.0f, FMath::Clamp(TPSAdaptiveNet::AILODMinScale, 0.1f, 1.0f), Alpha);
+
+	CSV_CUSTOM_STAT(AdaptiveNet, AILODDistanceScale, AILODDistanceScale, ECsvCustomStatOp::Set);
+}
+
+void UTPSAdaptiveNetSubsystem::ApplyNetUpdateFrequency(AActor* Actor, ETPSAdaptiveNetClass NetClass, float BaseFrequency) const
+{
+	const float Scale = FMath::Lerp(1.0f, FMath::Clamp(TPSAdaptiveNet::GetMinScale(NetClass), 0.01f, 1.0f), GetLevelAlpha());
+
+	Actor->SetNetUpdateFrequency(FMath::Max(BaseFrequency * Scale, Actor->GetMinNetUpdateFrequency()));
+}
+
+float UTPSAdaptiveNetSubsystem::GetLevelAlpha() const
+{
+	return TPSAdaptiveNet::NumLevels > 0 ? FMath::Clamp(static_cast<float>(Level) / TPSAdaptiveNet::NumLevels, 0.0f, 1.0f) : 0.0f;
+}
+
+void UTPSAdaptiveNetSubsystem::RestoreDefaults()
+{
+	if (Level == 0)
+	{
+		return;
+	}
+
+	Level = 0;
+	ApplyLevel();
+}
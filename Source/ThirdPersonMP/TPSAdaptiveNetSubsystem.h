@@ -0,0 +1,109 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "TPSAdaptiveNetSubsystem.generated.h"
+
+/**
+ *  Groups of replicated actors whose net update frequency is scaled independently under load
+ */
+enum class ETPSAdaptiveNetClass : uint8
+{
+	Projectile,
+	Enemy,
+	Prop,
+
+	Num
+};
+
+/**
+ *  Watches the server's frame time and trades replication and simulation fidelity for headroom during load spikes.
+ *  Load is measured as the smoothed game thread work time over the frame budget of the base server tick rate.
+ *  Sustained overload raises the load level one step at a time, sustained headroom lowers it again, with separate delays for each direction.
+ *  Each level lerps the server max tick rate, the net update frequency of each registered actor class and the AI LOD distances
+ *  towards their configured minimums. Every decision is logged and recorded as a CSV event so the bounds can be tuned.
+ */
+UCLASS()
+class THIRDPERSONMP_API UTPSAdaptiveNetSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+	/** Registered actors and their authored net update frequency, per class */
+	TMap<TWeakObjectPtr<AActor>, float> ClassActors[static_cast<uint8>(ETPSAdaptiveNetClass::Num)];
+
+	/** Server max tick rate before any scaling was applied */
+	int32 BaseTickRate = 0;
+
+	/** Smoothed game thread work time, in ms */
+	float SmoothedFrameMs = 0.0f;
+
+	/** Smoothed frame time over the frame budget */
+	float Load = 0.0f;
+
+	/** Current load level. Zero means full fidelity */
+	int32 Level = 0;
+
+	/** Time the load has been above the raise threshold */
+	float OverloadTime = 0.0f;
+
+	/** Time the load has been below the lower threshold */
+	float UnderloadTime = 0.0f;
+
+	/** Current scale applied to the AI LOD distances */
+	float AILODDistanceScale = 1.0f;
+
+public:
+
+	/** Returns the subsystem for the provided world, if any */
+	static UTPSAdaptiveNetSubsystem* Get(const UWorld* World);
+
+	/** Starts scaling a server actor's net update frequency with the load level */
+	void RegisterActor(AActor* Actor, ETPSAdaptiveNetClass NetClass);
+
+	/** Stops scaling an actor's net update frequency */
+	void UnregisterActor(AActor* Actor, ETPSAdaptiveNetClass NetClass);
+
+	/** Returns the scale to apply to the AI LOD distances. Lower values drop enemies to cheaper buckets sooner */
+	float GetAILODDistanceScale() const { return AILODDistanceScale; }
+
+	/** Returns the current load level */
+	int32 GetLevel() const { return Level; }
+
+	/** Logs the current load, level and applied values */
+	void DumpToLog() const;
+
+public:
+
+	// ~begin FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	// ~end FTickableGameObject interface
+
+protected:
+
+	/** Only create this subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Cleanup */
+	virtual void Deinitialize() override;
+
+	/** Returns true if this world is running as a server */
+	bool IsServer() const;
+
+	/** Moves to a new load level and applies its settings */
+	void SetLevel(int32 NewLevel, const TCHAR* Reason);
+
+	/** Applies the current level's settings to the net driver, the registered actors and the AI LOD distances */
+	void ApplyLevel();
+
+	/** Applies the current level's net update frequency to a single actor */
+	void ApplyNetUpdateFrequency(AActor* Actor, ETPSAdaptiveNetClass NetClass, float BaseFrequency) const;
+
+	/** Returns the blend from full fidelity to the configured minimums for the current level */
+	float GetLevelAlpha() const;
+
+	/** Restores the base tick rate and the authored net update frequencies */
+	void RestoreDefaults();
+};
@@ -0,0 +1,40 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "TPSCharacterMovementComponent.h"
+#include "TPSMovementCorrectionSubsystem.h"
+#include "GameFramework/Character.h"
+#include "Engine/World.h"
+#include "HAL/PlatformTime.h"
+#include "ThirdPersonMP.h"
+
+DECLARE_CYCLE_STAT(TEXT("TPS Character Movement Tick"), STAT_TPSCharacterMovementTick, STATGROUP_ThirdPersonMP);
+
+void UTPSCharacterMovementComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	SCOPE_CYCLE_COUNTER(STAT_TPSCharacterMovementTick);
+
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	TickCycles += FPlatformTime::Cycles64() - StartCycles;
+}
+
+bool UTPSCharacterMovementComponent::ServerCheckClientError(float ClientTimeStamp, float DeltaTime, const FVector& Accel, const FVector& ClientWorldLocation, const FVector& RelativeClientLocation, UPrimitiveComponent* ClientMovementBase, FName ClientBaseBoneName, uint8 ClientMovementMode)
+{
+	const bool bNeedsCorrection = Super::ServerCheckClientError(ClientTimeStamp, DeltaTime, Accel, ClientWorldLocation, RelativeClientLocation, ClientMovementBase, ClientBaseBoneName, ClientMovementMode);
+
+	// only record corrections that will actually be sent to the client
+	if (bNeedsCorrection && CharacterOwner && UpdatedComponent)
+	{
+		if (UTPSMovementCorrectionSubsystem* Telemetry = UTPSMovementCorrectionSubsystem::Get(GetWorld()))
+		{
+			const FVector ServerLocation = UpdatedComponent->GetComponentLocation();
+
+			Telemetry->RecordCorrection(CharacterOwner, ServerLocation, (ServerLocation - ClientWorldLocation).Size(), MovementMode, CustomMovementMode);
+		}
+	}
+
+	return bNeedsCorrection;
+}
@@ -0,0 +1,33 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "TPSCharacterMovementComponent.generated.h"
+
+/**
+ *  Character Movement Component shared by the player character variants.
+ *  Reports every server-side client correction to the movement correction telemetry subsystem.
+ */
+UCLASS()
+class THIRDPERSONMP_API UTPSCharacterMovementComponent : public UCharacterMovementComponent
+{
+	GENERATED_BODY()
+
+	/** Game thread cycles spent ticking this component, for movement benchmarks */
+	uint64 TickCycles = 0;
+
+public:
+
+	/** Returns the game thread cycles spent ticking this component so far */
+	uint64 GetTickCycles() const { return TickCycles; }
+
+	/** Ticks movement and accumulates the time spent */
+	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+protected:
+
+	/** Checks the client's reported location against the server's and records the correction if one is needed */
+	virtual bool ServerCheckClientError(float ClientTimeStamp, float DeltaTime, const FVector& Accel, const FVector& ClientWorldLocation, const FVector& RelativeClientLocation, UPrimitiveComponent* ClientMovementBase, FName ClientBaseBoneName, uint8 ClientMovementMode) override;
+};
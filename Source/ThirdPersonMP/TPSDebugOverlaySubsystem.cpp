@@ -0,0 +1,276 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "TPSDebugOverlaySubsystem.h"
+#include "Engine/World.h"
+#include "Engine/Engine.h"
+
+#if TPS_WITH_DEBUG_OVERLAY
+#include "Engine/Canvas.h"
+#include "CanvasItem.h"
+#include "Debug/DebugDrawService.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+#endif
+
+#if TPS_WITH_DEBUG_OVERLAY
+
+namespace TPSDebugOverlay
+{
+	/** Gameplay starts enabled so the character health readouts show up as they did before the overlay */
+	static bool CategoryEnabled[static_cast<uint8>(ETPSDebugCategory::Num)] = { false, false, false, false, false, true };
+
+	static FAutoConsoleVariableRef CVarMovement(
+		TEXT("TPS.Debug.Overlay.Movement"),
+		CategoryEnabled[static_cast<uint8>(ETPSDebugCategory::Movement)],
+		TEXT("If true, movement debug messages are drawn in the world."));
+
+	static FAutoConsoleVariableRef CVarNetwork(
+		TEXT("TPS.Debug.Overlay.Network"),
+		CategoryEnabled[static_cast<uint8>(ETPSDebugCategory::Network)],
+		TEXT("If true, networking debug messages are drawn in the world."));
+
+	static FAutoConsoleVariableRef CVarCombat(
+		TEXT("TPS.Debug.Overlay.Combat"),
+		CategoryEnabled[static_cast<uint8>(ETPSDebugCategory::Combat)],
+		TEXT("If true, combat debug messages are drawn in the world."));
+
+	static FAutoConsoleVariableRef CVarAI(
+		TEXT("TPS.Debug.Overlay.AI"),
+		CategoryEnabled[static_cast<uint8>(ETPSDebugCategory::AI)],
+		TEXT("If true, AI debug messages are drawn in the world."));
+
+	static FAutoConsoleVariableRef CVarProjectile(
+		TEXT("TPS.Debug.Overlay.Projectile"),
+		CategoryEnabled[static_cast<uint8>(ETPSDebugCategory::Projectile)],
+		TEXT("If true, projectile debug messages are drawn in the world."));
+
+	static FAutoConsoleVariableRef CVarGameplay(
+		TEXT("TPS.Debug.Overlay.Gameplay"),
+		CategoryEnabled[static_cast<uint8>(ETPSDebugCategory::Gameplay)],
+		TEXT("If true, general gameplay debug messages are drawn in the world."));
+
+	static int32 MaxMessages = 256;
+	static FAutoConsoleVariableRef CVarMaxMessages(
+		TEXT("TPS.Debug.Overlay.MaxMessages"),
+		MaxMessages,
+		TEXT("Number of messages kept in the debug overlay ring buffer. The oldest message is overwritten when it's full."));
+
+	static float TextScale = 1.2f;
+	static FAutoConsoleVariableRef CVarTextScale(
+		TEXT("TPS.Debug.Overlay.TextScale"),
+		TextScale,
+		TEXT("Scale applied to the debug overlay text."));
+
+	static FAutoConsoleCommandWithWorld ClearCommand(
+		TEXT("TPS.Debug.Overlay.Clear"),
+		TEXT("Removes all messages from the debug overlay."),
+		FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+		{
+			if (UTPSDebugOverlaySubsystem* Overlay = UTPSDebugOverlaySubsystem::Get(World))
+			{
+				Overlay->Clear();
+			}
+		}));
+}
+
+#endif
+
+UTPSDebugOverlaySubsystem* UTPSDebugOverlaySubsystem::Get(const UWorld* World)
+{
+	return World ? World->GetSubsystem<UTPSDebugOverlaySubsystem>() : nullptr;
+}
+
+UTPSDebugOverlaySubsystem* UTPSDebugOverlaySubsystem::GetIfEnabled(const UObject* WorldContextObject, ETPSDebugCategory Category)
+{
+#if TPS_WITH_DEBUG_OVERLAY
+	// check the category first so disabled messages cost a single branch
+	if (!IsCategoryEnabled(Category) || !GEngine)
+	{
+		return nullptr;
+	}
+
+	return Get(GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull));
+#else
+	return nullptr;
+#endif
+}
+
+bool UTPSDebugOverlaySubsystem::IsCategoryEnabled(ETPSDebugCategory Category)
+{
+#if TPS_WITH_DEBUG_OVERLAY
+	return Category < ETPSDebugCategory::Num && TPSDebugOverlay::CategoryEnabled[static_cast<uint8>(Category)];
+#else
+	return false;
+#endif
+}
+
+void UTPSDebugOverlaySubsystem::AddMessage(ETPSDebugCategory Category, const FVector& Location, float Duration, const FColor& Color, FString&& Text)
+{
+#if TPS_WITH_DEBUG_OVERLAY
+	FMessage Message;
+	Message.Text = MoveTemp(Text);
+	Message.Location = Location;
+	Message.ExpireTime = GetWorld()->GetTimeSeconds() + Duration;
+	Message.Color = Color;
+	Message.Category = Category;
+
+	PushMessage(MoveTemp(Message));
+#endif
+}
+
+void UTPSDebugOverlaySubsystem::AddActorMessage(ETPSDebugCategory Category, const AActor* Actor, const FVector& Offset, float Duration, const FColor& Color, FString&& Text)
+{
+#if TPS_WITH_DEBUG_OVERLAY
+	if (!Actor)
+	{
+		return;
+	}
+
+	const double ExpireTime = GetWorld()->GetTimeSeconds() + Duration;
+
+	// replace the actor's previous message in this category, if it's still around
+	for (FMessage& Existing : Messages)
+	{
+		if (Existing.Category == Category && Existing.Actor == Actor)
+		{
+			Existing.Text = MoveTemp(Text);
+			Existing.Location = Offset;
+			Existing.ExpireTime = ExpireTime;
+			Existing.Color = Color;
+			return;
+		}
+	}
+
+	FMessage Message;
+	Message.Text = MoveTemp(Text);
+	Message.Location = Offset;
+	Message.Actor = Actor;
+	Message.ExpireTime = ExpireTime;
+	Message.Color = Color;
+	Message.Category = Category;
+
+	PushMessage(MoveTemp(Message));
+#endif
+}
+
+void UTPSDebugOverlaySubsystem::Clear()
+{
+#if TPS_WITH_DEBUG_OVERLAY
+	Messages.Reset();
+	Head = 0;
+#endif
+}
+
+bool UTPSDebugOverlaySubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+#if TPS_WITH_DEBUG_OVERLAY
+	// nothing is ever drawn on a dedicated server
+	return !IsRunningDedicatedServer() && Super::ShouldCreateSubsystem(Outer);
+#else
+	return false;
+#endif
+}
+
+bool UTPSDebugOverlaySubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UTPSDebugOverlaySubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+#if TPS_WITH_DEBUG_OVERLAY
+	DrawHandle = UDebugDrawService::Register(TEXT("Game"), FDebugDrawDelegate::CreateUObject(this, &UTPSDebugOverlaySubsystem::Draw));
+#endif
+}
+
+void UTPSDebugOverlaySubsystem::Deinitialize()
+{
+#if TPS_WITH_DEBUG_OVERLAY
+	UDebugDrawService::Unregister(DrawHandle);
+	DrawHandle.Reset();
+
+	Clear();
+#endif
+
+	Super::Deinitialize();
+}
+
+#if TPS_WITH_DEBUG_OVERLAY
+
+void UTPSDebugOverlaySubsystem::PushMessage(FMessage&& Message)
+{
+	const int32 Capacity = FMath::Max(1, TPSDebugOverlay::MaxMessages);
+
+	// start over if the capacity was changed from the console
+	if (Messages.Num() > Capacity)
+	{
+		Clear();
+	}
+
+	// grow until full, then overwrite the oldest message
+	if (Messages.Num() < Capacity)
+	{
+		Messages.Add(MoveTemp(Message));
+		Head = Messages.Num() % Capacity;
+	}
+	else
+	{
+		Messages[Head] = MoveTemp(Message);
+		Head = (Head + 1) % Capacity;
+	}
+}
+
+void UTPSDebugOverlaySubsystem::Draw(UCanvas* Canvas, APlayerController* PlayerController)
+{
+	// the draw service is shared by all viewports, so only draw on the ones looking at this world
+	if (!Canvas || !PlayerController || PlayerController->GetWorld() != GetWorld() || Messages.IsEmpty())
+	{
+		return;
+	}
+
+	const double CurrentTime = GetWorld()->GetTimeSeconds();
+	UFont* Font = GEngine->GetSmallFont();
+
+	for (const FMessage& Message : Messages)
+	{
+		if (Message.ExpireTime < CurrentTime || !IsCategoryEnabled(Message.Category))
+		{
+			continue;
+		}
+
+		// resolve attached messages, skipping the ones whose actor went away
+		FVector WorldLocation = Message.Location;
+
+		if (!Message.Actor.IsExplicitlyNull())
+		{
+			const AActor* Actor = Message.Actor.Get();
+
+			if (!Actor)
+			{
+				continue;
+			}
+
+			WorldLocation += Actor->GetActorLocation();
+		}
+
+		// project to screen space, skipping anything behind the camera
+		const FVector ScreenLocation = Canvas->Project(WorldLocation);
+
+		if (ScreenLocation.Z <= 0.0f)
+		{
+			continue;
+		}
+
+		FCanvasTextItem TextItem(FVector2D(ScreenLocation.X, ScreenLocation.Y), FText::FromString(Message.Text), Font, Message.Color);
+		TextItem.bCentreX = true;
+		TextItem.Scale = FVector2D(TPSDebugOverlay::TextScale);
+		TextItem.EnableShadow(FLinearColor::Black);
+
+		Canvas->DrawItem(TextItem);
+	}
+}
+
+#endif
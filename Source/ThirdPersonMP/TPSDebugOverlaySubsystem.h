@@ -0,0 +1,149 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "TPSDebugOverlaySubsystem.generated.h"
+
+class UCanvas;
+class APlayerController;
+
+/** The debug overlay and all of its messages are compiled out of Shipping and dedicated server builds */
+#define TPS_WITH_DEBUG_OVERLAY (!UE_BUILD_SHIPPING && !UE_SERVER)
+
+/**
+ *  Debug overlay categories. Each one is toggled with its own TPS.Debug.Overlay.<Category> console variable
+ */
+enum class ETPSDebugCategory : uint8
+{
+	Movement,
+	Network,
+	Combat,
+	AI,
+	Projectile,
+	Gameplay,
+
+	Num
+};
+
+/**
+ *  Draws world-space debug text for the local viewports.
+ *  Messages are only formatted when their category is enabled, and are kept in a bounded ring buffer
+ *  that is drawn once per frame through the debug draw service, so each PIE window shows its own world.
+ *  Messages attached to an actor follow it and replace that actor's previous message in the same category.
+ *  Not created in Shipping builds or on dedicated servers. Use the TPS_DEBUG_MESSAGE macros rather than calling it directly.
+ */
+UCLASS()
+class THIRDPERSONMP_API UTPSDebugOverlaySubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+#if TPS_WITH_DEBUG_OVERLAY
+
+	/** A single overlay message */
+	struct FMessage
+	{
+		/** Message text */
+		FString Text;
+
+		/** World location, or offset from the actor for attached messages */
+		FVector Location = FVector::ZeroVector;
+
+		/** Actor the message follows, if any */
+		TWeakObjectPtr<const AActor> Actor;
+
+		/** World time after which the message is no longer drawn */
+		double ExpireTime = -1.0;
+
+		/** Text color */
+		FColor Color = FColor::White;
+
+		/** Category the message was added under */
+		ETPSDebugCategory Category = ETPSDebugCategory::Gameplay;
+	};
+
+	/** Message ring buffer. Grows up to the configured capacity and then overwrites the oldest message */
+	TArray<FMessage> Messages;
+
+	/** Index the next message will be written to */
+	int32 Head = 0;
+
+	/** Handle for the debug draw delegate */
+	FDelegateHandle DrawHandle;
+
+#endif
+
+public:
+
+	/** Returns the subsystem for the provided world, if any */
+	static UTPSDebugOverlaySubsystem* Get(const UWorld* World);
+
+	/** Returns the subsystem for the world context object's world, but only if the category is enabled */
+	static UTPSDebugOverlaySubsystem* GetIfEnabled(const UObject* WorldContextObject, ETPSDebugCategory Category);
+
+	/** Returns true if messages in the category are currently being drawn */
+	static bool IsCategoryEnabled(ETPSDebugCategory Category);
+
+	/** Adds a message at a fixed world location */
+	void AddMessage(ETPSDebugCategory Category, const FVector& Location, float Duration, const FColor& Color, FString&& Text);
+
+	/** Adds a message that follows an actor, replacing any message previously attached to it in the same category */
+	void AddActorMessage(ETPSDebugCategory Category, const AActor* Actor, const FVector& Offset, float Duration, const FColor& Color, FString&& Text);
+
+	/** Removes all messages */
+	void Clear();
+
+protected:
+
+	/** Only create this subsystem when the overlay can be drawn */
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+
+	/** Only create this subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Initialization */
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	/** Cleanup */
+	virtual void Deinitialize() override;
+
+#if TPS_WITH_DEBUG_OVERLAY
+
+	/** Writes a message into the ring buffer */
+	void PushMessage(FMessage&& Message);
+
+	/** Draws the live messages on a viewport belonging to this world */
+	void Draw(UCanvas* Canvas, APlayerController* PlayerController);
+
+#endif
+};
+
+#if TPS_WITH_DEBUG_OVERLAY
+
+	/** Draws formatted text at a world location. The format arguments are only evaluated if the category is enabled */
+	#define TPS_DEBUG_MESSAGE(WorldContext, Category, Location, Duration, Color, Format, ...) \
+		do \
+		{ \
+			if (UTPSDebugOverlaySubsystem* DebugOverlay = UTPSDebugOverlaySubsystem::GetIfEnabled(WorldContext, ETPSDebugCategory::Category)) \
+			{ \
+				DebugOverlay->AddMessage(ETPSDebugCategory::Category, Location, Duration, Color, FString::Printf(Format, ##__VA_ARGS__)); \
+			} \
+		} while (0)
+
+	/** Draws formatted text that follows an actor. The format arguments are only evaluated if the category is enabled */
+	#define TPS_DEBUG_ACTOR_MESSAGE(Actor, Category, Offset, Duration, Color, Format, ...) \
+		do \
+		{ \
+			if (UTPSDebugOverlaySubsystem* DebugOverlay = UTPSDebugOverlaySubsystem::GetIfEnabled(Actor, ETPSDebugCategory::Category)) \
+			{ \
+				DebugOverlay->AddActorMessage(ETPSDebugCategory::Category, Actor, Offset, Duration, Color, FString::Printf(Format, ##__VA_ARGS__)); \
+			} \
+		} while (0)
+
+#else
+
+	#define TPS_DEBUG_MESSAGE(WorldContext, Category, Location, Duration, Color, Format, ...) do {} while (0)
+	#define TPS_DEBUG_ACTOR_MESSAGE(Actor, Category, Offset, Duration, Color, Format, ...) do {} while (0)
+
+#endif
@@ -0,0 +1,476 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "TPSDeterminismSubsystem.h"
+#include "EnhancedInputSubsystems.h"
+#include "EnhancedPlayerInput.h"
+#include "InputAction.h"
+#include "GameFramework/PlayerController.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/LocalPlayer.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/App.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Algo/StableSort.h"
+#include "ThirdPersonMP.h"
+
+namespace TPSDeterminism
+{
+	static bool bEnabled = false;
+	static FAutoConsoleVariableRef CVarEnabled(
+		TEXT("TPS.Determinism.Enabled"),
+		bEnabled,
+		TEXT("If true, worlds run at a fixed time step with a seeded gameplay random stream, and record per-frame state hashes. Applies to worlds created afterwards."));
+
+	static float FixedDeltaTime = 1.0f / 60.0f;
+	static FAutoConsoleVariableRef CVarFixedDeltaTime(
+		TEXT("TPS.Determinism.FixedDeltaTime"),
+		FixedDeltaTime,
+		TEXT("Tick delta used by the deterministic simulation mode, in seconds."));
+
+	static int32 Seed = 0;
+	static FAutoConsoleVariableRef CVarSeed(
+		TEXT("TPS.Determinism.Seed"),
+		Seed,
+		TEXT("Seed for the gameplay random stream in the deterministic simulation mode."));
+
+	static bool bLogHashes = false;
+	static FAutoConsoleVariableRef CVarLogHashes(
+		TEXT("TPS.Determinism.LogHashes"),
+		bLogHashes,
+		TEXT("If true, the state hash of every frame is logged."));
+
+	/** Number of worlds holding the engine at a fixed time step. The setting is process wide, so the first world captures it and the last one restores it */
+	static int32 FixedTimeStepRefCount = 0;
+
+	/** Fixed time step settings from before the first world applied its own */
+	static bool bPreviousUseFixedTimeStep = false;
+	static double PreviousFixedDeltaTime = 0.0;
+
+	static FAutoConsoleCommandWithWorldAndArgs RecordInputCommand(
+		TEXT("TPS.Determinism.RecordInput"),
+		TEXT("Starts recording the local player's input. Usage: TPS.Determinism.RecordInput [Name=Input]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			if (UTPSDeterminismSubsystem* Determinism = UTPSDeterminismSubsystem::Get(World))
+			{
+				Determinism->StartInputRecording(Args.Num() > 0 ? Args[0] : TEXT("Input"));
+			}
+		}));
+
+	static FAutoConsoleCommandWithWorld StopInputCommand(
+		TEXT("TPS.Determinism.StopRecording"),
+		TEXT("Stops recording input and saves the recording."),
+		FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+		{
+			if (UTPSDeterminismSubsystem* Determinism = UTPSDeterminismSubsystem::Get(World))
+			{
+				Determinism->StopInputRecording();
+			}
+		}));
+
+	static FAutoConsoleCommandWithWorldAndArgs PlayInputCommand(
+		TEXT("TPS.Determinism.PlayInput"),
+		TEXT("Plays back a recorded input file on the local player. Usage: TPS.Determinism.PlayInput [Name=Input]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			if (UTPSDeterminismSubsystem* Determinism = UTPSDeterminismSubsystem::Get(World))
+			{
+				Determinism->StartInputPlayback(Args.Num() > 0 ? Args[0] : TEXT("Input"));
+			}
+		}));
+
+	static FAutoConsoleCommandWithWorldAndArgs SaveHashesCommand(
+		TEXT("TPS.Determinism.SaveHashes"),
+		TEXT("Saves the frame state hashes recorded so far. Usage: TPS.Determinism.SaveHashes [Name=Hashes]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			if (UTPSDeterminismSubsystem* Determinism = UTPSDeterminismSubsystem::Get(World))
+			{
+				Determinism->SaveFrameHashes(Args.Num() > 0 ? Args[0] : TEXT("Hashes"));
+			}
+		}));
+
+	static FAutoConsoleCommandWithWorldAndArgs CompareHashesCommand(
+		TEXT("TPS.Determinism.CompareHashes"),
+		TEXT("Compares the frame state hashes recorded so far against a saved run. Usage: TPS.Determinism.CompareHashes [Name=Hashes]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			if (UTPSDeterminismSubsystem* Determinism = UTPSDeterminismSubsystem::Get(World))
+			{
+				Determinism->CompareFrameHashes(Args.Num() > 0 ? Args[0] : TEXT("Hashes"));
+			}
+		}));
+
+	/** Returns the Enhanced Input subsystem of the first local player */
+	static UEnhancedInputLocalPlayerSubsystem* GetLocalInputSubsystem(const UWorld* World)
+	{
+		const APlayerController* PC = World ? World->GetFirstPlayerController() : nullptr;
+
+		return (PC && PC->GetLocalPlayer()) ? ULocalPlayer::GetSubsystem<UEnhancedInputLocalPlayerSubsystem>(PC->GetLocalPlayer()) : nullptr;
+	}
+
+	/** Quantizes a value so hashes don't depend on floating point noise below the reported precision */
+	static int64 Quantize(double Value)
+	{
+		return FMath::RoundToInt64(Value * 100.0);
+	}
+}
+
+UTPSDeterminismSubsystem* UTPSDeterminismSubsystem::Get(const UWorld* World)
+{
+	return World ? World->GetSubsystem<UTPSDeterminismSubsystem>() : nullptr;
+}
+
+bool UTPSDeterminismSubsystem::IsDeterministic()
+{
+	return TPSDeterminism::bEnabled;
+}
+
+int32 UTPSDeterminismSubsystem::RandRange(const UObject* WorldContextObject, int32 Min, int32 Max)
+{
+	if (UTPSDeterminismSubsystem* Determinism = Get(WorldContextObject ? WorldContextObject->GetWorld() : nullptr))
+	{
+		return Determinism->RandomStream.RandRange(Min, Max);
+	}
+
+	return FMath::RandRange(Min, Max);
+}
+
+float UTPSDeterminismSubsystem::FRandRange(const UObject* WorldContextObject, float Min, float Max)
+{
+	if (UTPSDeterminismSubsystem* Determinism = Get(WorldContextObject ? WorldContextObject->GetWorld() : nullptr))
+	{
+		return Determinism->RandomStream.FRandRange(Min, Max);
+	}
+
+	return FMath::FRandRange(Min, Max);
+}
+
+void UTPSDeterminismSubsystem::StartInputRecording(const FString& Name)
+{
+	RecordedInputs.Reset();
+	RecordingName = Name;
+	RecordingStartFrame = SimFrame;
+	bRecordingInput = true;
+
+	UE_LOG(LogThirdPersonMP, Log, TEXT("Recording input to %s from frame %u."), *GetFilePath(Name, TEXT("csv")), SimFrame);
+}
+
+void UTPSDeterminismSubsystem::StopInputRecording()
+{
+	if (!bRecordingInput)
+	{
+		return;
+	}
+
+	bRecordingInput = false;
+
+	// one line per frame and action: Frame,Action,X,Y,Z. Frames are relative to the start of the recording
+	FString Contents;
+
+	for (const FTPSRecordedInput& Input : RecordedInputs)
+	{
+		Contents += FString::Printf(TEXT("%u,%s,%f,%f,%f\n"), Input.Frame - RecordingStartFrame, *FSoftObjectPath(Input.Action).ToString(), Input.Value.X, Input.Value.Y, Input.Value.Z);
+	}
+
+	const FString FilePath = GetFilePath(RecordingName, TEXT("csv"));
+	FFileHelper::SaveStringToFile(Contents, *FilePath);
+
+	UE_LOG(LogThirdPersonMP, Log, TEXT("Saved %d recorded inputs to %s."), RecordedInputs.Num(), *FilePath);
+
+	RecordedInputs.Reset();
+}
+
+bool UTPSDeterminismSubsystem::StartInputPlayback(const FString& Name)
+{
+	const FString FilePath = GetFilePath(Name, TEXT("csv"));
+
+	TArray<FString> Lines;
+
+	if (!FFileHelper::LoadFileToStringArray(Lines, *FilePath))
+	{
+		UE_LOG(LogThirdPersonMP, Warning, TEXT("Couldn't load input recording %s."), *FilePath);
+		return false;
+	}
+
+	PlaybackInputs.Reset(Lines.Num());
+
+	for (const FString& Line : Lines)
+	{
+		TArray<FString> Fields;
+
+		if (Line.ParseIntoArray(Fields, TEXT(",")) != 5)
+		{
+			continue;
+		}
+
+		const UInputAction* Action = Cast<UInputAction>(FSoftObjectPath(Fields[1]).TryLoad());
+
+		if (!Action)
+		{
+			continue;
+		}
+
+		// play the inputs back starting on the next frame
+		FTPSRecordedInput& Input = PlaybackInputs.AddDefaulted_GetRef();
+		Input.Frame = SimFrame + 1 + FCString::Atoi(*Fields[0]);
+		Input.Action = Action;
+		Input.Value = FVector(FCString::Atod(*Fields[2]), FCString::Atod(*Fields[3]), FCString::Atod(*Fields[4]));
+	}
+
+	Algo::StableSortBy(PlaybackInputs, &FTPSRecordedInput::Frame);
+
+	PlaybackIndex = 0;
+	bPlayingInput = true;
+
+	UE_LOG(LogThirdPersonMP, Log, TEXT("Playing back %d inputs from %s."), PlaybackInputs.Num(), *FilePath);
+
+	return true;
+}
+
+void UTPSDeterminismSubsystem::SaveFrameHashes(const FString& Name) const
+{
+	FString Contents;
+
+	for (const uint32 Hash : FrameHashes)
+	{
+		Contents += FString::Printf(TEXT("%08x\n"), Hash);
+	}
+
+	const FString FilePath = GetFilePath(Name, TEXT("txt"));
+	FFileHelper::SaveStringToFile(Contents, *FilePath);
+
+	UE_LOG(LogThirdPersonMP, Log, TEXT("Saved %d frame hashes to %s."), FrameHashes.Num(), *FilePath);
+}
+
+void UTPSDeterminismSubsystem::CompareFrameHashes(const FString& Name) const
+{
+	const FString FilePath = GetFilePath(Name, TEXT("txt"));
+
+	TArray<FString> Lines;
+
+	if (!FFileHelper::LoadFileToStringArray(Lines, *FilePath))
+	{
+		UE_LOG(LogThirdPersonMP, Warning, TEXT("Couldn't load frame hashes %s."), *FilePath);
+		return;
+	}
+
+	const int32 NumFrames = FMath::Min(Lines.Num(), FrameHashes.Num());
+
+	for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+	{
+		const uint32 SavedHash = FParse::HexNumber(*Lines[Frame]);
+
+		if (SavedHash != FrameHashes[Frame])
+		{
+			UE_LOG(LogThirdPersonMP, Warning, TEXT("Simulation diverged from %s on frame %d: %08x, expected %08x."), *FilePath, Frame, FrameHashes[Frame], SavedHash);
+			return;
+		}
+	}
+
+	UE_LOG(LogThirdPersonMP, Log, TEXT("Simulation matches %s over %d frames."), *FilePath, NumFrames);
+}
+
+void UTPSDeterminismSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (bRecordingInput)
+	{
+		RecordInput();
+	}
+
+	if (bPlayingInput)
+	{
+		PlayInput();
+	}
+
+	// hash the state of this frame
+	if (TPSDeterminism::bEnabled)
+	{
+		const uint32 Hash = HashWorldState();
+		FrameHashes.Add(Hash);
+
+		if (TPSDeterminism::bLogHashes)
+		{
+			UE_LOG(LogThirdPersonMP, Log, TEXT("Frame %u state hash: %08x"), SimFrame, Hash);
+		}
+	}
+
+	++SimFrame;
+}
+
+TStatId UTPSDeterminismSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UTPSDeterminismSubsystem, STATGROUP_Tickables);
+}
+
+bool UTPSDeterminismSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UTPSDeterminismSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	if (TPSDeterminism::bEnabled)
+	{
+		// seed the gameplay random stream
+		RandomStream.Initialize(TPSDeterminism::Seed);
+
+		// tick at a fixed delta instead of the wall clock. PIE can run several worlds, so only the first one captures the engine's settings
+		if (TPSDeterminism::FixedTimeStepRefCount++ == 0)
+		{
+			TPSDeterminism::bPreviousUseFixedTimeStep = FApp::UseFixedTimeStep();
+			TPSDeterminism::PreviousFixedDeltaTime = FApp::GetFixedDeltaTime();
+		}
+
+		bAppliedFixedTimeStep = true;
+
+		FApp::SetUseFixedTimeStep(true);
+		FApp::SetFixedDeltaTime(TPSDeterminism::FixedDeltaTime);
+
+		UE_LOG(LogThirdPersonMP, Log, TEXT("Deterministic simulation enabled. Seed: %d, fixed delta: %f"), TPSDeterminism::Seed, TPSDeterminism::FixedDeltaTime);
+	}
+	else
+	{
+		// keep the usual unseeded behavior
+		RandomStream.GenerateNewSeed();
+	}
+}
+
+void UTPSDeterminismSubsystem::Deinitialize()
+{
+	if (bRecordingInput)
+	{
+		StopInputRecording();
+	}
+
+	// restore the engine's time step once the last deterministic world goes away
+	if (bAppliedFixedTimeStep)
+	{
+		if (--TPSDeterminism::FixedTimeStepRefCount == 0)
+		{
+			FApp::SetUseFixedTimeStep(TPSDeterminism::bPreviousUseFixedTimeStep);
+			FApp::SetFixedDeltaTime(TPSDeterminism::PreviousFixedDeltaTime);
+		}
+
+		bAppliedFixedTimeStep = false;
+	}
+
+	FrameHashes.Reset();
+	RecordedInputs.Reset();
+	PlaybackInputs.Reset();
+	bPlayingInput = false;
+
+	Super::Deinitialize();
+}
+
+uint32 UTPSDeterminismSubsystem::HashWorldState() const
+{
+	// include the random stream so a differing number of random draws shows up right away
+	uint32 Hash = FCrc::MemCrc32(&SimFrame, sizeof(SimFrame));
+	const int32 RandomSeed = RandomStream.GetCurrentSeed();
+	Hash = FCrc::MemCrc32(&RandomSeed, sizeof(RandomSeed), Hash);
+
+	// hash the transform and velocity of every movable actor, in level order
+	for (TActorIterator<AActor> It(GetWorld()); It; ++It)
+	{
+		const USceneComponent* Root = It->GetRootComponent();
+
+		if (!Root || Root->Mobility != EComponentMobility::Movable)
+		{
+			continue;
+		}
+
+		const FVector Location = Root->GetComponentLocation();
+		const FRotator Rotation = Root->GetComponentRotation();
+		const FVector Velocity = It->GetVelocity();
+
+		const int64 State[9] = {
+			TPSDeterminism::Quantize(Location.X), TPSDeterminism::Quantize(Location.Y), TPSDeterminism::Quantize(Location.Z),
+			TPSDeterminism::Quantize(Rotation.Pitch), TPSDeterminism::Quantize(Rotation.Yaw), TPSDeterminism::Quantize(Rotation.Roll),
+			TPSDeterminism::Quantize(Velocity.X), TPSDeterminism::Quantize(Velocity.Y), TPSDeterminism::Quantize(Velocity.Z)
+		};
+
+		Hash = FCrc::MemCrc32(State, sizeof(State), Hash);
+	}
+
+	return Hash;
+}
+
+void UTPSDeterminismSubsystem::RecordInput()
+{
+	UEnhancedInputLocalPlayerSubsystem* InputSubsystem = TPSDeterminism::GetLocalInputSubsystem(GetWorld());
+	UEnhancedPlayerInput* PlayerInput = InputSubsystem ? InputSubsystem->GetPlayerInput() : nullptr;
+
+	if (!PlayerInput)
+	{
+		return;
+	}
+
+	// record the value of every mapped action that's currently active
+	TSet<const UInputAction*> RecordedActions;
+
+	for (const FEnhancedActionKeyMapping& Mapping : PlayerInput->GetEnhancedActionMappings())
+	{
+		const UInputAction* Action = Mapping.Action;
+
+		if (!Action || RecordedActions.Contains(Action))
+		{
+			continue;
+		}
+
+		RecordedActions.Add(Action);
+
+		const FInputActionValue Value = PlayerInput->GetActionValue(Action);
+
+		if (Value.IsNonZero())
+		{
+			FTPSRecordedInput& Input = RecordedInputs.AddDefaulted_GetRef();
+			Input.Frame = SimFrame;
+			Input.Action = Action;
+			Input.Value = Value.Get<FVector>();
+		}
+	}
+}
+
+void UTPSDeterminismSubsystem::PlayInput()
+{
+	UEnhancedInputLocalPlayerSubsystem* InputSubsystem = TPSDeterminism::GetLocalInputSubsystem(GetWorld());
+
+	if (!InputSubsystem)
+	{
+		return;
+	}
+
+	// injected input is processed on the next frame, so queue up the inputs recorded for it
+	const uint32 NextFrame = SimFrame + 1;
+
+	while (PlaybackInputs.IsValidIndex(PlaybackIndex) && PlaybackInputs[PlaybackIndex].Frame <= NextFrame)
+	{
+		const FTPSRecordedInput& Input = PlaybackInputs[PlaybackIndex++];
+
+		if (Input.Frame == NextFrame)
+		{
+			InputSubsystem->InjectInputForAction(Input.Action, FInputActionValue(Input.Action->ValueType, Input.Value), {}, {});
+		}
+	}
+
+	if (!PlaybackInputs.IsValidIndex(PlaybackIndex))
+	{
+		bPlayingInput = false;
+
+		UE_LOG(LogThirdPersonMP, Log, TEXT("Input playback finished on frame %u."), SimFrame);
+	}
+}
+
+FString UTPSDeterminismSubsystem::GetFilePath(const FString& Name, const TCHAR* Extension)
+{
+	return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Determinism"), FString::Printf(TEXT("%s.%s"), *Name, Extension));
+}
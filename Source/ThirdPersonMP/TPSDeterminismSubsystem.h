@@ -0,0 +1,145 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Math/RandomStream.h"
+#include "TPSDeterminismSubsystem.generated.h"
+
+class UInputAction;
+
+/**
+ *  A single recorded input action value
+ */
+USTRUCT()
+struct FTPSRecordedInput
+{
+	GENERATED_BODY()
+
+	/** Simulation frame the input was processed on */
+	uint32 Frame = 0;
+
+	/** Recorded action */
+	UPROPERTY()
+	TObjectPtr<const UInputAction> Action;
+
+	/** Action value */
+	FVector Value = FVector::ZeroVector;
+};
+
+/**
+ *  Owns the per-world gameplay random stream and the deterministic simulation mode used for reproducible benchmarks.
+ *  With TPS.Determinism.Enabled set, the engine runs at a fixed tick delta, the random stream is seeded from
+ *  TPS.Determinism.Seed, and a hash of every movable actor's state is recorded each frame, so two runs with
+ *  the same seed and the same scripted input can be compared frame by frame.
+ *  Local player input can be recorded to a file and played back through Enhanced Input injection.
+ */
+UCLASS()
+class THIRDPERSONMP_API UTPSDeterminismSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+	/** Gameplay random stream */
+	FRandomStream RandomStream;
+
+	/** Number of frames simulated since play began */
+	uint32 SimFrame = 0;
+
+	/** State hash recorded for each frame */
+	TArray<uint32> FrameHashes;
+
+	/** Inputs being recorded */
+	UPROPERTY(Transient)
+	TArray<FTPSRecordedInput> RecordedInputs;
+
+	/** Inputs being played back, sorted by frame */
+	UPROPERTY(Transient)
+	TArray<FTPSRecordedInput> PlaybackInputs;
+
+	/** Frame the input recording in progress started on */
+	uint32 RecordingStartFrame = 0;
+
+	/** Index of the next input to play back */
+	int32 PlaybackIndex = 0;
+
+	/** Name of the input recording in progress */
+	FString RecordingName;
+
+	/** If true, local player input is being recorded */
+	bool bRecordingInput = false;
+
+	/** If true, recorded input is being played back */
+	bool bPlayingInput = false;
+
+	/** If true, this subsystem holds a reference on the engine's fixed time step and must release it */
+	bool bAppliedFixedTimeStep = false;
+
+public:
+
+	/** Returns the subsystem for the provided world, if any */
+	static UTPSDeterminismSubsystem* Get(const UWorld* World);
+
+	/** Returns true if the deterministic simulation mode is enabled */
+	static bool IsDeterministic();
+
+	/** Returns a random integer in [Min, Max] from the world's gameplay random stream */
+	static int32 RandRange(const UObject* WorldContextObject, int32 Min, int32 Max);
+
+	/** Returns a random float in [Min, Max] from the world's gameplay random stream */
+	static float FRandRange(const UObject* WorldContextObject, float Min, float Max);
+
+	/** Returns the world's gameplay random stream */
+	FRandomStream& GetRandomStream() { return RandomStream; }
+
+	/** Returns the number of frames simulated since play began */
+	uint32 GetSimFrame() const { return SimFrame; }
+
+	/** Returns the state hash recorded for each frame so far */
+	const TArray<uint32>& GetFrameHashes() const { return FrameHashes; }
+
+	/** Starts recording the local player's input */
+	void StartInputRecording(const FString& Name);
+
+	/** Stops recording input and saves the recording */
+	void StopInputRecording();
+
+	/** Loads an input recording and starts playing it back on the local player. Returns false if it couldn't be loaded */
+	bool StartInputPlayback(const FString& Name);
+
+	/** Saves the frame hashes recorded so far */
+	void SaveFrameHashes(const FString& Name) const;
+
+	/** Compares the frame hashes recorded so far against a saved run and logs the first divergent frame */
+	void CompareFrameHashes(const FString& Name) const;
+
+public:
+
+	// ~begin FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	// ~end FTickableGameObject interface
+
+protected:
+
+	/** Only create this subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Initialization */
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	/** Cleanup */
+	virtual void Deinitialize() override;
+
+	/** Hashes the state of every movable actor in the world */
+	uint32 HashWorldState() const;
+
+	/** Records the local player's current action values */
+	void RecordInput();
+
+	/** Injects the recorded inputs for the next frame */
+	void PlayInput();
+
+	/** Returns the full path of a determinism file */
+	static FString GetFilePath(const FString& Name, const TCHAR* Extension);
+};
@@ -0,0 +1,233 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "TPSMovementCorrectionSubsystem.h"
+#include "GameFramework/Character.h"
+#include "Engine/NetConnection.h"
+#include "Engine/World.h"
+#include "Algo/Rotate.h"
+#include "HAL/IConsoleManager.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "ThirdPersonMP.h"
+
+CSV_DEFINE_CATEGORY(MovementCorrections, true);
+
+namespace TPSMovementCorrection
+{
+	static bool bEnabled = true;
+	static FAutoConsoleVariableRef CVarEnabled(
+		TEXT("TPS.Net.CorrectionTelemetry"),
+		bEnabled,
+		TEXT("If true, server-side movement corrections are recorded per connection and per character variant."));
+
+	static int32 HistorySize = 256;
+	static FAutoConsoleVariableRef CVarHistorySize(
+		TEXT("TPS.Net.CorrectionHistorySize"),
+		HistorySize,
+		TEXT("Number of corrections kept in each connection's ring buffer."));
+
+	static bool bDrawHeatmap = false;
+	static FAutoConsoleVariableRef CVarDrawHeatmap(
+		TEXT("TPS.Net.CorrectionHeatmap"),
+		bDrawHeatmap,
+		TEXT("If true, the HUD draws the recorded movement corrections as an in-world heatmap."));
+
+	static float HeatmapMaxError = 50.0f;
+	static FAutoConsoleVariableRef CVarHeatmapMaxError(
+		TEXT("TPS.Net.CorrectionHeatmapMaxError"),
+		HeatmapMaxError,
+		TEXT("Positional error, in cm, at which heatmap entries are drawn at full intensity."));
+
+	/** Returns the name of the first native class in the character's hierarchy, so Blueprint subclasses are grouped with their variant */
+	static FName GetVariantName(const ACharacter* Character)
+	{
+		const UClass* Class = Character->GetClass();
+
+		while (Class && !Class->HasAnyClassFlags(CLASS_Native))
+		{
+			Class = Class->GetSuperClass();
+		}
+
+		return Class ? Class->GetFName() : NAME_None;
+	}
+
+	static FAutoConsoleCommandWithWorld DumpCommand(
+		TEXT("TPS.Net.DumpCorrections"),
+		TEXT("Logs the movement corrections recorded so far, per character variant and per connection."),
+		FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+		{
+			if (UTPSMovementCorrectionSubsystem* Telemetry = UTPSMovementCorrectionSubsystem::Get(World))
+			{
+				Telemetry->DumpToLog();
+			}
+		}));
+
+	static FAutoConsoleCommandWithWorld ResetCommand(
+		TEXT("TPS.Net.ResetCorrections"),
+		TEXT("Clears all recorded movement corrections."),
+		FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+		{
+			if (UTPSMovementCorrectionSubsystem* Telemetry = UTPSMovementCorrectionSubsystem::Get(World))
+			{
+				Telemetry->Reset();
+			}
+		}));
+}
+
+void FTPSConnectionCorrections::Add(const FTPSMovementCorrectionRecord& Record, int32 Capacity)
+{
+	// if the capacity changed, put the oldest record first and drop the
+	// ones that no longer fit, so the buffer wraps around at the new capacity
+	if (Records.Num() != Capacity && Records.Num() > 0)
+	{
+		if (Head > 0 && Head < Records.Num())
+		{
+			Algo::Rotate(Records, Head);
+		}
+
+		if (Records.Num() > Capacity)
+		{
+			Records.RemoveAt(0, Records.Num() - Capacity);
+		}
+
+		Head = Records.Num() % Capacity;
+	}
+
+	// grow the buffer until we hit capacity, then overwrite the oldest entry
+	if (Records.Num() < Capacity)
+	{
+		Records.Add(Record);
+		Head = Records.Num() % Capacity;
+	}
+	else if (Records.Num() > 0)
+	{
+		Head = Head % Records.Num();
+		Records[Head] = Record;
+		Head = (Head + 1) % Records.Num();
+	}
+
+	++TotalCount;
+	TotalError += Record.Error;
+}
+
+UTPSMovementCorrectionSubsystem* UTPSMovementCorrectionSubsystem::Get(const UWorld* World)
+{
+	return World ? World->GetSubsystem<UTPSMovementCorrectionSubsystem>() : nullptr;
+}
+
+void UTPSMovementCorrectionSubsystem::RecordCorrection(const ACharacter* Character, const FVector& ServerLocation, float Error, EMovementMode Mode, uint8 CustomMode)
+{
+	if (!TPSMovementCorrection::bEnabled || !Character)
+	{
+		return;
+	}
+
+	// build the packed record
+	FTPSMovementCorrectionRecord Record;
+	Record.ServerTime = GetWorld()->GetTimeSeconds();
+	Record.Location = FVector3f(ServerLocation);
+	Record.Error = Error;
+	Record.MovementMode = static_cast<uint8>(Mode);
+	Record.CustomMovementMode = CustomMode;
+
+	const FName VariantName = TPSMovementCorrection::GetVariantName(Character);
+
+	// add it to the owning connection's ring buffer
+	FTPSConnectionCorrections& Connection = ConnectionCorrections.FindOrAdd(Character->GetNetConnection());
+	Connection.CharacterVariant = VariantName;
+	Connection.Add(Record, FMath::Max(1, TPSMovementCorrection::HistorySize));
+
+	// accumulate the per-variant totals
+	FTPSVariantCorrections& Variant = VariantCorrections.FindOrAdd(VariantName);
+	++Variant.Count;
+	Variant.TotalError += Error;
+	Variant.MaxError = FMath::Max(Variant.MaxError, Error);
+
+	if (Record.MovementMode < MOVE_MAX)
+	{
+		++Variant.CountPerMode[Record.MovementMode];
+	}
+
+	// report to the CSV profiler
+	CSV_CUSTOM_STAT(MovementCorrections, Count, 1, ECsvCustomStatOp::Accumulate);
+	CSV_CUSTOM_STAT(MovementCorrections, ErrorCm, Error, ECsvCustomStatOp::Max);
+
+#if CSV_PROFILER
+	FCsvProfiler::RecordCustomStat(VariantName, CSV_CATEGORY_INDEX(MovementCorrections), 1, ECsvCustomStatOp::Accumulate);
+#endif
+}
+
+void UTPSMovementCorrectionSubsystem::ForEachCorrection(TFunctionRef<void(const FTPSMovementCorrectionRecord&)> Func) const
+{
+	for (const TPair<TWeakObjectPtr<UNetConnection>, FTPSConnectionCorrections>& Pair : ConnectionCorrections)
+	{
+		for (const FTPSMovementCorrectionRecord& Record : Pair.Value.Records)
+		{
+			Func(Record);
+		}
+	}
+}
+
+void UTPSMovementCorrectionSubsystem::DumpToLog() const
+{
+	const UEnum* MovementModeEnum = StaticEnum<EMovementMode>();
+
+	UE_LOG(LogThirdPersonMP, Log, TEXT("=== Movement corrections per character variant ==="));
+
+	for (const TPair<FName, FTPSVariantCorrections>& Pair : VariantCorrections)
+	{
+		const FTPSVariantCorrections& Variant = Pair.Value;
+
+		UE_LOG(LogThirdPersonMP, Log, TEXT("%s: %d corrections, avg error %.2f cm, max error %.2f cm"),
+			*Pair.Key.ToString(), Variant.Count, Variant.Count > 0 ? Variant.TotalError / Variant.Count : 0.0, Variant.MaxError);
+
+		// break the count down by the movement mode that triggered it
+		for (int32 Mode = 0; Mode < MOVE_MAX; ++Mode)
+		{
+			if (Variant.CountPerMode[Mode] > 0)
+			{
+				UE_LOG(LogThirdPersonMP, Log, TEXT("    %s: %d"), *MovementModeEnum->GetNameStringByValue(Mode), Variant.CountPerMode[Mode]);
+			}
+		}
+	}
+
+	UE_LOG(LogThirdPersonMP, Log, TEXT("=== Movement corrections per connection ==="));
+
+	for (const TPair<TWeakObjectPtr<UNetConnection>, FTPSConnectionCorrections>& Pair : ConnectionCorrections)
+	{
+		const FTPSConnectionCorrections& Connection = Pair.Value;
+		const UNetConnection* NetConnection = Pair.Key.Get();
+
+		UE_LOG(LogThirdPersonMP, Log, TEXT("%s (%s): %d corrections, avg error %.2f cm"),
+			NetConnection ? *NetConnection->LowLevelGetRemoteAddress(true) : TEXT("Local/Closed"),
+			*Connection.CharacterVariant.ToString(),
+			Connection.TotalCount,
+			Connection.TotalCount > 0 ? Connection.TotalError / Connection.TotalCount : 0.0);
+	}
+}
+
+void UTPSMovementCorrectionSubsystem::Reset()
+{
+	ConnectionCorrections.Reset();
+	VariantCorrections.Reset();
+}
+
+bool UTPSMovementCorrectionSubsystem::IsEnabled()
+{
+	return TPSMovementCorrection::bEnabled;
+}
+
+bool UTPSMovementCorrectionSubsystem::IsHeatmapEnabled()
+{
+	return TPSMovementCorrection::bDrawHeatmap;
+}
+
+float UTPSMovementCorrectionSubsystem::GetHeatmapMaxError()
+{
+	return FMath::Max(1.0f, TPSMovementCorrection::HeatmapMaxError);
+}
+
+bool UTPSMovementCorrectionSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
@@ -0,0 +1,127 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Engine/EngineTypes.h"
+#include "TPSMovementCorrectionSubsystem.generated.h"
+
+class ACharacter;
+class UNetConnection;
+
+/**
+ *  A single server-side movement correction, packed for the per-connection ring buffer
+ */
+struct FTPSMovementCorrectionRecord
+{
+	/** World time the correction was issued at */
+	float ServerTime = 0.0f;
+
+	/** Server-authoritative location of the corrected character */
+	FVector3f Location = FVector3f::ZeroVector;
+
+	/** Distance between the client's reported location and the server location */
+	float Error = 0.0f;
+
+	/** Server movement mode when the correction was issued */
+	uint8 MovementMode = MOVE_None;
+
+	/** Server custom movement mode when the correction was issued */
+	uint8 CustomMovementMode = 0;
+};
+
+/**
+ *  Fixed capacity ring buffer of corrections sent to a single client connection
+ */
+struct FTPSConnectionCorrections
+{
+	/** Correction history. Grows up to the configured capacity and then wraps around */
+	TArray<FTPSMovementCorrectionRecord> Records;
+
+	/** Index the next record will be written to */
+	int32 Head = 0;
+
+	/** Total number of corrections sent to this connection */
+	int32 TotalCount = 0;
+
+	/** Sum of the positional error of all corrections sent to this connection */
+	double TotalError = 0.0;
+
+	/** Name of the last character variant that was corrected on this connection */
+	FName CharacterVariant;
+
+	/** Adds a record, overwriting the oldest one if the buffer is full. Resizes the buffer if the capacity changed */
+	void Add(const FTPSMovementCorrectionRecord& Record, int32 Capacity);
+};
+
+/**
+ *  Accumulated corrections for a single character variant
+ */
+struct FTPSVariantCorrections
+{
+	/** Number of corrections issued */
+	int32 Count = 0;
+
+	/** Sum of the positional error of all corrections */
+	double TotalError = 0.0;
+
+	/** Largest positional error seen */
+	float MaxError = 0.0f;
+
+	/** Number of corrections issued per movement mode */
+	int32 CountPerMode[MOVE_MAX] = {};
+};
+
+/**
+ *  Collects server-side movement corrections for the player character variants.
+ *  Corrections are stored per connection in a small ring buffer, accumulated per character variant
+ *  and reported to the CSV profiler. The HUD can draw the stored corrections as an in-world heatmap.
+ */
+UCLASS()
+class THIRDPERSONMP_API UTPSMovementCorrectionSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Correction history per client connection */
+	TMap<TWeakObjectPtr<UNetConnection>, FTPSConnectionCorrections> ConnectionCorrections;
+
+	/** Accumulated corrections per native character class */
+	TMap<FName, FTPSVariantCorrections> VariantCorrections;
+
+public:
+
+	/** Returns the subsystem for the provided world, if any */
+	static UTPSMovementCorrectionSubsystem* Get(const UWorld* World);
+
+	/** Records a correction sent to the character's owning connection */
+	void RecordCorrection(const ACharacter* Character, const FVector& ServerLocation, float Error, EMovementMode Mode, uint8 CustomMode);
+
+	/** Calls the provided function for every stored correction on every connection */
+	void ForEachCorrection(TFunctionRef<void(const FTPSMovementCorrectionRecord&)> Func) const;
+
+	/** Returns the accumulated corrections for each character variant */
+	const TMap<FName, FTPSVariantCorrections>& GetVariantCorrections() const { return VariantCorrections; }
+
+	/** Writes a summary of all collected corrections to the log */
+	void DumpToLog() const;
+
+	/** Clears all collected data */
+	void Reset();
+
+	/** Returns true if correction telemetry is enabled */
+	static bool IsEnabled();
+
+	/** Returns true if the HUD should draw the correction heatmap */
+	static bool IsHeatmapEnabled();
+
+	/** Returns the error at which heatmap entries are drawn at full intensity */
+	static float GetHeatmapMaxError();
+
+protected:
+
+	/** Only create this subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+};
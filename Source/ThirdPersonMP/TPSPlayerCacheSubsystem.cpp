@@ -0,0 +1,89 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "TPSPlayerCacheSubsystem.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+
+UTPSPlayerCacheSubsystem* UTPSPlayerCacheSubsystem::Get(const UWorld* World)
+{
+	return World ? World->GetSubsystem<UTPSPlayerCacheSubsystem>() : nullptr;
+}
+
+const TArray<FTPSCachedPlayer>& UTPSPlayerCacheSubsystem::GetPlayers() const
+{
+	UpdateCache();
+
+	return Players;
+}
+
+const FTPSCachedPlayer* UTPSPlayerCacheSubsystem::FindNearestPlayer(const FVector& Location, float MaxDistance) const
+{
+	UpdateCache();
+
+	const FTPSCachedPlayer* Nearest = nullptr;
+	double NearestDistSquared = FMath::Square(static_cast<double>(MaxDistance));
+
+	for (const FTPSCachedPlayer& Player : Players)
+	{
+		const double DistSquared = FVector::DistSquared(Location, Player.Location);
+
+		// ties go to the first player so the result is stable
+		if (DistSquared < NearestDistSquared)
+		{
+			Nearest = &Player;
+			NearestDistSquared = DistSquared;
+		}
+	}
+
+	return Nearest;
+}
+
+APawn* UTPSPlayerCacheSubsystem::FindNearestPlayerPawn(const FVector& Location, float MaxDistance) const
+{
+	const FTPSCachedPlayer* Nearest = FindNearestPlayer(Location, MaxDistance);
+
+	return Nearest ? Nearest->Pawn.Get() : nullptr;
+}
+
+bool UTPSPlayerCacheSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UTPSPlayerCacheSubsystem::UpdateCache() const
+{
+	// is the cache still valid for this frame?
+	if (CachedFrame == GFrameCounter)
+	{
+		return;
+	}
+
+	CachedFrame = GFrameCounter;
+	Players.Reset();
+
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* PC = It->Get();
+
+		// skip players without a pawn, e.g. while respawning
+		APawn* Pawn = PC ? PC->GetPawn() : nullptr;
+
+		if (!IsValid(Pawn))
+		{
+			continue;
+		}
+
+		FVector ViewLocation;
+		FRotator ViewRotation;
+		PC->GetPlayerViewPoint(ViewLocation, ViewRotation);
+
+		FTPSCachedPlayer& Player = Players.AddDefaulted_GetRef();
+		Player.Pawn = Pawn;
+		Player.Location = Pawn->GetActorLocation();
+		Player.Velocity = Pawn->GetVelocity();
+		Player.ViewLocation = ViewLocation;
+		Player.ViewDirection = ViewRotation.Vector();
+	}
+}
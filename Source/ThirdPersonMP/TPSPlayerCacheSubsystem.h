@@ -0,0 +1,71 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "TPSPlayerCacheSubsystem.generated.h"
+
+class APawn;
+
+/**
+ *  Per-frame snapshot of a single player pawn
+ */
+struct FTPSCachedPlayer
+{
+	/** Player pawn */
+	TWeakObjectPtr<APawn> Pawn;
+
+	/** Pawn location */
+	FVector Location = FVector::ZeroVector;
+
+	/** Pawn velocity */
+	FVector Velocity = FVector::ZeroVector;
+
+	/** Location of the player's view point */
+	FVector ViewLocation = FVector::ZeroVector;
+
+	/** Direction the player is looking towards */
+	FVector ViewDirection = FVector::ForwardVector;
+};
+
+/**
+ *  Caches all player-controlled pawns once per frame so AI consumers don't each walk the player list.
+ *  The cache is rebuilt lazily on the first query of a frame, and answers nearest-player queries
+ *  so enemies target the closest of all connected players instead of always the first one.
+ */
+UCLASS()
+class THIRDPERSONMP_API UTPSPlayerCacheSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Cached players, in player controller order */
+	mutable TArray<FTPSCachedPlayer> Players;
+
+	/** Frame the cache was last built on */
+	mutable uint64 CachedFrame = MAX_uint64;
+
+public:
+
+	/** Returns the subsystem for the provided world, if any */
+	static UTPSPlayerCacheSubsystem* Get(const UWorld* World);
+
+	/** Returns all player pawns for this frame */
+	const TArray<FTPSCachedPlayer>& GetPlayers() const;
+
+	/** Returns the player closest to the provided location, or nullptr if there are no players within range */
+	const FTPSCachedPlayer* FindNearestPlayer(const FVector& Location, float MaxDistance = UE_BIG_NUMBER) const;
+
+	/** Returns the pawn closest to the provided location, or nullptr if there are no players within range */
+	APawn* FindNearestPlayerPawn(const FVector& Location, float MaxDistance = UE_BIG_NUMBER) const;
+
+protected:
+
+	/** Only create this subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Rebuilds the cache if it's stale */
+	void UpdateCache() const;
+};
@@ -3,19 +3,20 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Stats/Stats.h"
 
 /** Main log category used across the project */
 DECLARE_LOG_CATEGORY_EXTERN(LogThirdPersonMP, Log, All);
 
+/** Stat group for project-specific counters and timers */
+DECLARE_STATS_GROUP(TEXT("ThirdPersonMP"), STATGROUP_ThirdPersonMP, STATCAT_Advanced);
+
 // ============================================================================
 // 调试信息宏配置
 // ============================================================================
 // 设置为 1 启用屏幕调试信息（GEngine方式，多窗口共享），设置为 0 禁用
 #define ENABLE_SCREEN_DEBUG_MESSAGES 0
 
-// 设置为 1 启用3D世界调试信息（DrawDebugString方式，每个窗口独立显示），设置为 0 禁用
-#define ENABLE_WORLD_DEBUG_MESSAGES 1
-
 // 屏幕调试信息宏（已禁用，多窗口PIE时所有窗口显示相同信息）
 #if ENABLE_SCREEN_DEBUG_MESSAGES
 	#define SCREEN_DEBUG_MESSAGE(Key, Time, Color, Message) \
@@ -24,14 +25,6 @@ DECLARE_LOG_CATEGORY_EXTERN(LogThirdPersonMP, Log, All);
 	#define SCREEN_DEBUG_MESSAGE(Key, Time, Color, Message)
 #endif
 
-// 3D世界调试信息宏（推荐用于多窗口PIE调试，每个窗口显示各自角色的信息）
-// 在角色头顶显示调试文本，每个窗口独立渲染
-#if ENABLE_WORLD_DEBUG_MESSAGES
-	#include "DrawDebugHelpers.h"
-	#define WORLD_DEBUG_MESSAGE(WorldContext, Location, Time, Color, Message) \
-		if (WorldContext) { \
-			DrawDebugString(WorldContext, Location, Message, nullptr, Color, Time, true, 1.2f); \
-		}
-#else
-	#define WORLD_DEBUG_MESSAGE(WorldContext, Location, Time, Color, Message)
-#endif
\ No newline at end of file
+// 3D世界调试信息请使用 TPSDebugOverlaySubsystem.h 中的 TPS_DEBUG_MESSAGE / TPS_DEBUG_ACTOR_MESSAGE
+// 按类别通过 TPS.Debug.Overlay.<Category> 控制台变量在运行时开关，类别关闭时不会格式化字符串
+// Shipping 和专用服务器版本中会被完全剔除
\ No newline at end of file
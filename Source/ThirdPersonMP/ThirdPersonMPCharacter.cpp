@@ -14,8 +14,13 @@
 #include "Net/UnrealNetwork.h"     
 #include "Engine/Engine.h"
 #include "ThirdPersonMPProjectile.h"
+#include "TPSCharacterMovementComponent.h"
+#include "ThirdPersonMPStats.h"
+#include "TPSDebugOverlaySubsystem.h"
+#include "Engine/StreamableManager.h"
 
-AThirdPersonMPCharacter::AThirdPersonMPCharacter()
+AThirdPersonMPCharacter::AThirdPersonMPCharacter(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<UTPSCharacterMovementComponent>(ACharacter::CharacterMovementComponentName))
 {
 	bReplicates = false;
 	
@@ -63,12 +68,32 @@ AThirdPersonMPCharacter::AThirdPersonMPCharacter()
 	PrimaryActorTick.bCanEverTick = true;
 }
 
+void AThirdPersonMPCharacter::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// 角色生成即装备武器，提前异步加载子弹的网格体和特效，避免首次射击时才加载
+	BulletAssetsHandle = AThirdPersonMPProjectile::PreloadAssets(this, Bullet);
+}
+
+void AThirdPersonMPCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// 释放预加载句柄，没有其他引用时资产可以被回收
+	if (BulletAssetsHandle.IsValid())
+	{
+		BulletAssetsHandle->ReleaseHandle();
+		BulletAssetsHandle.Reset();
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
 void AThirdPersonMPCharacter::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 
-	// 显示常驻生命值信息（角色头顶上方）
-	FVector HealthLocation = GetActorLocation() + FVector(0, 0, 120.f);
+	// 显示常驻生命值信息（角色头顶上方，跟随角色）
+	const FVector HealthOffset(0, 0, 120.f);
 
 	// 根据生命值百分比选择颜色
 	float HealthPercent = CurrentHealth / MaxHealth;
@@ -90,9 +115,9 @@ void AThirdPersonMPCharacter::Tick(float DeltaTime)
 		HealthColor = FColor::White;  // 已死亡
 	}
 
-	// 常驻显示生命值（每帧刷新）
-	WORLD_DEBUG_MESSAGE(GetWorld(), HealthLocation, 0.f, HealthColor,
-		FString::Printf(TEXT("HP: %.0f/%.0f"), CurrentHealth, MaxHealth));
+	// 常驻显示生命值（每帧刷新，替换上一帧的信息）
+	TPS_DEBUG_ACTOR_MESSAGE(this, Gameplay, HealthOffset, 0.f, HealthColor,
+		TEXT("HP: %.0f/%.0f"), CurrentHealth, MaxHealth);
 }
 
 void AThirdPersonMPCharacter::StartFire()
@@ -117,6 +142,8 @@ void AThirdPersonMPCharacter::StopFire()
  
 void AThirdPersonMPCharacter::HandleFire_Implementation()
 {
+	TPS_SCOPED_TIMER(HandleFire, TPSProjectile);
+
 	FVector spawnLocation = GetActorLocation() + ( GetActorRotation().Vector()  * 100.0f ) + (GetActorUpVector() * 50.0f);
 	FRotator spawnRotation = GetActorRotation();
  
@@ -224,8 +251,8 @@ void AThirdPersonMPCharacter::OnHealthUpdate()
 	{
 		// 显示受击提示（临时显示3秒）
 		FVector DamageLocation = GetActorLocation() + FVector(0, 0, 140.f);
-		WORLD_DEBUG_MESSAGE(GetWorld(), DamageLocation, 3.f, FColor::Red,
-			FString::Printf(TEXT("-%.1f"), Damage));
+		TPS_DEBUG_MESSAGE(this, Gameplay, DamageLocation, 3.f, FColor::Red,
+			TEXT("-%.1f"), Damage);
 	}
 
 	// 更新上一次的生命值
@@ -13,6 +13,7 @@ class UCameraComponent;
 class UInputAction;
 class AThirdPersonMPProjectile; //前向声明
 struct FInputActionValue;
+struct FStreamableHandle;
 
 DECLARE_LOG_CATEGORY_EXTERN(LogTemplateCharacter, Log, All);
 
@@ -73,10 +74,13 @@ protected:
 	UPROPERTY(EditAnywhere, Category="Combat")
 	TSubclassOf<AThirdPersonMPProjectile> Bullet;
 
+	/** 子弹网格体和特效的预加载句柄，角色存在期间保持资产常驻 */
+	TSharedPtr<FStreamableHandle> BulletAssetsHandle;
+
 public:
 
 	/** Constructor */
-	AThirdPersonMPCharacter();
+	AThirdPersonMPCharacter(const FObjectInitializer& ObjectInitializer);
 
 	/** 属性复制 */
 	void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
@@ -86,6 +90,12 @@ protected:
 	/** Initialize input action bindings */
 	virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
 
+	/** 装备武器，异步预加载子弹资产 */
+	virtual void BeginPlay() override;
+
+	/** 释放预加载的子弹资产 */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	/** 每帧调用，用于显示常驻调试信息 */
 	virtual void Tick(float DeltaTime) override;
 
@@ -7,6 +7,8 @@
 #include "GameFramework/PlayerController.h"
 #include "GameFramework/PlayerState.h"
 #include "EngineUtils.h"
+#include "TPSMovementCorrectionSubsystem.h"
+#include "ThirdPersonMPStats.h"
 
 AThirdPersonMPHUD::AThirdPersonMPHUD()
 {
@@ -15,6 +17,8 @@ AThirdPersonMPHUD::AThirdPersonMPHUD()
 
 void AThirdPersonMPHUD::DrawHUD()
 {
+	TPS_SCOPED_TIMER(DrawHUD, TPSUI);
+
 	Super::DrawHUD();
 
 	if (!Canvas)
@@ -108,6 +112,41 @@ void AThirdPersonMPHUD::DrawHUD()
 			}
 		}
 	}
+
+	// ========== 移动校正热力图（TPS.Net.CorrectionHeatmap） ==========
+	if (UTPSMovementCorrectionSubsystem::IsHeatmapEnabled())
+	{
+		DrawMovementCorrectionHeatmap();
+	}
+}
+
+void AThirdPersonMPHUD::DrawMovementCorrectionHeatmap()
+{
+	// 校正记录只存在于服务器端（监听服务器或单机PIE）
+	UTPSMovementCorrectionSubsystem* Telemetry = UTPSMovementCorrectionSubsystem::Get(GetWorld());
+	if (!Telemetry || !Canvas)
+	{
+		return;
+	}
+
+	const float MaxError = UTPSMovementCorrectionSubsystem::GetHeatmapMaxError();
+
+	Telemetry->ForEachCorrection([this, MaxError](const FTPSMovementCorrectionRecord& Record)
+	{
+		// 投影到屏幕空间，跳过摄像机背后的点
+		const FVector ScreenLocation = Project(FVector(Record.Location));
+		if (ScreenLocation.Z <= 0.0f)
+		{
+			return;
+		}
+
+		// 误差越大，颜色越红，方块越大
+		const float Alpha = FMath::Clamp(Record.Error / MaxError, 0.0f, 1.0f);
+		const FLinearColor HeatColor = FLinearColor::LerpUsingHSV(FLinearColor::Green, FLinearColor::Red, Alpha);
+		const float Size = FMath::Lerp(4.0f, 12.0f, Alpha);
+
+		DrawRect(HeatColor, ScreenLocation.X - Size * 0.5f, ScreenLocation.Y - Size * 0.5f, Size, Size);
+	});
 }
 
 void AThirdPersonMPHUD::DrawCharacterNetworkInfo(AThirdPersonMPCharacter* Character, float& YPos)
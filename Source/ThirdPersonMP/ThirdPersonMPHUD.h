@@ -25,5 +25,8 @@ protected:
 private:
 	/** Helper function to draw network debug info for a character */
 	void DrawCharacterNetworkInfo(class AThirdPersonMPCharacter* Character, float& YPos);
+
+	/** Helper function to draw the recorded server movement corrections as an in-world heatmap */
+	void DrawMovementCorrectionHeatmap();
 };
 
@@ -9,7 +9,13 @@
 #include "Particles/ParticleSystem.h"
 #include "Kismet/GameplayStatics.h"
 #include "UObject/ConstructorHelpers.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
 #include "TPSProjectileMovementComponent.h"
+#include "CombatDamageable.h"
+#include "CombatDamageSubsystem.h"
+#include "ThirdPersonMPStats.h"
+#include "TPSAdaptiveNetSubsystem.h"
 
 #if ENABLE_VISUAL_LOG
 #include "VisualLogger/VisualLogger.h"
@@ -34,6 +40,9 @@ AThirdPersonMPProjectile::AThirdPersonMPProjectile()
 	//定义将作为视觉呈现的网格体。
 	StaticMesh = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("Mesh"));
 	StaticMesh->SetupAttachment(RootComponent);
+	// 相对变换直接写入类默认对象，生成时无需再逐个设置
+	StaticMesh->SetRelativeLocation(FVector(0.0f, 0.0f, -37.5f));
+	StaticMesh->SetRelativeScale3D(FVector(0.5f, 0.5f, 0.5f));
 
 	//定义投射物移动组件。
 	ProjectileMovementComponent = CreateDefaultSubobject<UTPSProjectileMovementComponent>(TEXT("ProjectileMovement"));
@@ -60,11 +69,31 @@ void AThirdPersonMPProjectile::Destroyed()
 	UE_VLOG(this, LogTemp, Log, TEXT("[%s] Projectile Destroyed - Location: %s"),
 		bIsServer ? TEXT("SERVER") : TEXT("CLIENT"), *spawnLocation.ToString());
 
-	UGameplayStatics::SpawnEmitterAtLocation(this, ExplosionEffect, spawnLocation, FRotator::ZeroRotator, true, EPSCPoolMethod::AutoRelease);
+	// 只使用已预加载的特效，不在游戏过程中同步加载
+	if (UParticleSystem* Effect = ExplosionEffect.Get())
+	{
+		UGameplayStatics::SpawnEmitterAtLocation(this, Effect, spawnLocation, FRotator::ZeroRotator, true, EPSCPoolMethod::AutoRelease);
+	}
+}
+
+void AThirdPersonMPProjectile::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// 与BeginPlay中的计数配对，关卡卸载时同样会走到这里
+	DEC_DWORD_STAT(STAT_TPSProjectilesAlive);
+
+	if (UTPSAdaptiveNetSubsystem* AdaptiveNet = UTPSAdaptiveNetSubsystem::Get(GetWorld()))
+	{
+		AdaptiveNet->UnregisterActor(this, ETPSAdaptiveNetClass::Projectile);
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 void AThirdPersonMPProjectile::OnProjectileImpact(UPrimitiveComponent* HitComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit)
 {
+	TPS_SCOPED_TIMER(ProjectileImpact, TPSProjectile);
+	INC_DWORD_STAT(STAT_TPSProjectileImpacts);
+
 	const bool bIsServer = GetLocalRole() == ROLE_Authority;
 	const FColor ImpactColor = bIsServer ? FColor::Orange : FColor::Yellow;
 
@@ -76,7 +105,12 @@ void AThirdPersonMPProjectile::OnProjectileImpact(UPrimitiveComponent* HitCompon
 	UE_VLOG_LOCATION(this, LogTemp, Log, Hit.Location, 30.0f, ImpactColor,
 		TEXT("%s Impact"), bIsServer ? TEXT("Server") : TEXT("Client"));
 
-	if ( OtherActor )
+	// 战斗变体的可受伤对象走统一的批量伤害队列，其余对象仍使用引擎伤害
+	if ( OtherActor && OtherActor->Implements<UCombatDamageable>() )
+	{
+		UCombatDamageSubsystem::ApplyOrQueueDamage(OtherActor, Damage, this, Hit.ImpactPoint, FVector::ZeroVector);
+	}
+	else if ( OtherActor )
 	{
 		UGameplayStatics::ApplyPointDamage(OtherActor, Damage, NormalImpulse, Hit, GetInstigator()->Controller, this, DamageType);
 	}
@@ -89,16 +123,33 @@ void AThirdPersonMPProjectile::BeginPlay()
 {
 	Super::BeginPlay();
 
-	// [delta 251215 to do: visualize the fvector settings in the editor instead of hard coding]
-	if (MeshAsset)
+	INC_DWORD_STAT(STAT_TPSProjectilesAlive);
+
+	// 服务器负载过高时降低投射物的网络更新频率
+	if (UTPSAdaptiveNetSubsystem* AdaptiveNet = UTPSAdaptiveNetSubsystem::Get(GetWorld()))
 	{
-		StaticMesh->SetStaticMesh(MeshAsset);
-		StaticMesh->SetRelativeLocation(FVector(0.0f, 0.0f, -37.5f));
-		StaticMesh->SetRelativeScale3D(FVector(0.5f, 0.5f, 0.5f));
+		AdaptiveNet->RegisterActor(this, ETPSAdaptiveNetClass::Projectile);
 	}
-	else
+
+	// 专用服务器不需要视觉表现，网格体的相对变换已在类默认对象中设置
+	if (GetNetMode() != NM_DedicatedServer)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("MeshAsset not set on %s."), *GetName());
+		if (MeshAsset.IsNull())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("MeshAsset not set on %s."), *GetName());
+		}
+		else if (UStaticMesh* Mesh = MeshAsset.Get())
+		{
+			StaticMesh->SetStaticMesh(Mesh);
+		}
+		else
+		{
+			// 尚未预加载完成时异步加载，加载完成后再设置网格体
+			UAssetManager::GetStreamableManager().RequestAsyncLoad(MeshAsset.ToSoftObjectPath(), FStreamableDelegate::CreateWeakLambda(this, [this]()
+			{
+				StaticMesh->SetStaticMesh(MeshAsset.Get());
+			}));
+		}
 	}
 
 	const bool bIsServer = GetLocalRole() == ROLE_Authority;
@@ -109,6 +160,8 @@ void AThirdPersonMPProjectile::BeginPlay()
 // Called every frame
 void AThirdPersonMPProjectile::Tick(float DeltaTime)
 {
+	TPS_SCOPED_TIMER(ProjectileTick, TPSProjectile);
+
 	Super::Tick(DeltaTime);
 
 	if (!ProjectileMovementComponent)
@@ -137,3 +190,34 @@ void AThirdPersonMPProjectile::Tick(float DeltaTime)
 		MyVelocity.Size());
 }
 
+TSharedPtr<FStreamableHandle> AThirdPersonMPProjectile::PreloadAssets(const UObject* WorldContextObject, TSubclassOf<AThirdPersonMPProjectile> ProjectileClass)
+{
+	// 专用服务器不显示网格体和特效
+	const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	if (!ProjectileClass || !World || World->GetNetMode() == NM_DedicatedServer)
+	{
+		return nullptr;
+	}
+
+	// 收集类默认对象上的软引用
+	const AThirdPersonMPProjectile* ProjectileCDO = ProjectileClass->GetDefaultObject<AThirdPersonMPProjectile>();
+
+	TArray<FSoftObjectPath> AssetPaths;
+
+	if (!ProjectileCDO->MeshAsset.IsNull())
+	{
+		AssetPaths.Add(ProjectileCDO->MeshAsset.ToSoftObjectPath());
+	}
+
+	if (!ProjectileCDO->ExplosionEffect.IsNull())
+	{
+		AssetPaths.Add(ProjectileCDO->ExplosionEffect.ToSoftObjectPath());
+	}
+
+	if (AssetPaths.IsEmpty())
+	{
+		return nullptr;
+	}
+
+	return UAssetManager::GetStreamableManager().RequestAsyncLoad(MoveTemp(AssetPaths));
+}
@@ -6,6 +6,9 @@
 #include "GameFramework/Actor.h"
 #include "ThirdPersonMPProjectile.generated.h"
 
+class UParticleSystem;
+struct FStreamableHandle;
+
 UCLASS()
 class THIRDPERSONMP_API AThirdPersonMPProjectile : public AActor
 {
@@ -24,9 +27,10 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
 	class UStaticMeshComponent* StaticMesh;
 
-	// 用于提供对象视觉呈现效果的静态网格体资产。
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Components")
-	UStaticMesh* MeshAsset;
+	// 用于提供对象视觉呈现效果的静态网格体资产。软引用，由发射者的角色异步预加载。
+	// 改为软引用后不再向蓝图公开，原先读写此属性的蓝图节点需改为读取 StaticMesh 组件。
+	UPROPERTY(EditAnywhere, Category="Components")
+	TSoftObjectPtr<UStaticMesh> MeshAsset;
 
 	// 用于处理投射物移动的移动组件。
 	/**
@@ -36,9 +40,10 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Components")
 	class UTPSProjectileMovementComponent* ProjectileMovementComponent;
 
-	// 在投射物撞击其他对象并爆炸时使用的粒子。
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Components")
-	class UParticleSystem* ExplosionEffect;
+	// 在投射物撞击其他对象并爆炸时使用的粒子。软引用，由发射者的角色异步预加载。
+	// 改为软引用后不再向蓝图公开，蓝图子类仍可在类默认值中设置。
+	UPROPERTY(EditAnywhere, Category="Components")
+	TSoftObjectPtr<UParticleSystem> ExplosionEffect;
 
 	//此投射物将造成的伤害类型和伤害。
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Damage")
@@ -52,12 +57,17 @@ public:
 	// Sets default values for this actor's properties
 	AThirdPersonMPProjectile();
 
+	/** 异步预加载投射物类的网格体和爆炸特效。需要持有返回的句柄以保持资产常驻，专用服务器上不加载 */
+	static TSharedPtr<FStreamableHandle> PreloadAssets(const UObject* WorldContextObject, TSubclassOf<AThirdPersonMPProjectile> ProjectileClass);
+
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
 	virtual void Destroyed() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	UFUNCTION(Category="Projectile")
 	void OnProjectileImpact(UPrimitiveComponent* HitComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit);
  
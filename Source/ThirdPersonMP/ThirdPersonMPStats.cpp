@@ -0,0 +1,29 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "ThirdPersonMPStats.h"
+
+UE_TRACE_CHANNEL_DEFINE(TPSCombatChannel);
+UE_TRACE_CHANNEL_DEFINE(TPSProjectileChannel);
+UE_TRACE_CHANNEL_DEFINE(TPSAIChannel);
+UE_TRACE_CHANNEL_DEFINE(TPSUIChannel);
+UE_TRACE_CHANNEL_DEFINE(TPSCameraChannel);
+
+CSV_DEFINE_CATEGORY_MODULE(THIRDPERSONMP_API, TPSCombat, true);
+CSV_DEFINE_CATEGORY_MODULE(THIRDPERSONMP_API, TPSProjectile, true);
+CSV_DEFINE_CATEGORY_MODULE(THIRDPERSONMP_API, TPSAI, true);
+CSV_DEFINE_CATEGORY_MODULE(THIRDPERSONMP_API, TPSUI, true);
+CSV_DEFINE_CATEGORY_MODULE(THIRDPERSONMP_API, TPSCamera, true);
+
+DEFINE_STAT(STAT_TPSHandleFire);
+DEFINE_STAT(STAT_TPSProjectileTick);
+DEFINE_STAT(STAT_TPSProjectileImpact);
+DEFINE_STAT(STAT_TPSAttackTrace);
+DEFINE_STAT(STAT_TPSNotifyIncomingAttack);
+DEFINE_STAT(STAT_TPSStateTreeTaskTick);
+DEFINE_STAT(STAT_TPSDrawHUD);
+DEFINE_STAT(STAT_TPSCameraUpdate);
+
+DEFINE_STAT(STAT_TPSProjectilesAlive);
+DEFINE_STAT(STAT_TPSAttackTraces);
+DEFINE_STAT(STAT_TPSProjectileImpacts);
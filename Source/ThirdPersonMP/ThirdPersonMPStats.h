@@ -0,0 +1,54 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ThirdPersonMP.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "Trace/Trace.h"
+
+// ============================================================================
+// Gameplay hot path profiling
+// ============================================================================
+// Cycle stats show up under "stat ThirdPersonMP", including on dedicated servers.
+// Insights scopes are emitted on per-system trace channels, toggled at runtime with "Trace.Enable TPSCombat" etc.
+// CSV timings are recorded under per-system categories with "CsvProfile Start".
+
+/** Insights trace channels, one per gameplay system */
+UE_TRACE_CHANNEL_EXTERN(TPSCombatChannel, THIRDPERSONMP_API);
+UE_TRACE_CHANNEL_EXTERN(TPSProjectileChannel, THIRDPERSONMP_API);
+UE_TRACE_CHANNEL_EXTERN(TPSAIChannel, THIRDPERSONMP_API);
+UE_TRACE_CHANNEL_EXTERN(TPSUIChannel, THIRDPERSONMP_API);
+UE_TRACE_CHANNEL_EXTERN(TPSCameraChannel, THIRDPERSONMP_API);
+
+/** CSV profiler categories, one per gameplay system */
+CSV_DECLARE_CATEGORY_MODULE_EXTERN(THIRDPERSONMP_API, TPSCombat);
+CSV_DECLARE_CATEGORY_MODULE_EXTERN(THIRDPERSONMP_API, TPSProjectile);
+CSV_DECLARE_CATEGORY_MODULE_EXTERN(THIRDPERSONMP_API, TPSAI);
+CSV_DECLARE_CATEGORY_MODULE_EXTERN(THIRDPERSONMP_API, TPSUI);
+CSV_DECLARE_CATEGORY_MODULE_EXTERN(THIRDPERSONMP_API, TPSCamera);
+
+/** Hot path cycle stats */
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Handle Fire"), STAT_TPSHandleFire, STATGROUP_ThirdPersonMP, THIRDPERSONMP_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Projectile Tick"), STAT_TPSProjectileTick, STATGROUP_ThirdPersonMP, THIRDPERSONMP_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Projectile Impact"), STAT_TPSProjectileImpact, STATGROUP_ThirdPersonMP, THIRDPERSONMP_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Attack Trace"), STAT_TPSAttackTrace, STATGROUP_ThirdPersonMP, THIRDPERSONMP_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Notify Incoming Attack"), STAT_TPSNotifyIncomingAttack, STATGROUP_ThirdPersonMP, THIRDPERSONMP_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("StateTree Task Tick"), STAT_TPSStateTreeTaskTick, STATGROUP_ThirdPersonMP, THIRDPERSONMP_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Draw HUD"), STAT_TPSDrawHUD, STATGROUP_ThirdPersonMP, THIRDPERSONMP_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Camera Update"), STAT_TPSCameraUpdate, STATGROUP_ThirdPersonMP, THIRDPERSONMP_API);
+
+/** Hot path counters */
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Projectiles Alive"), STAT_TPSProjectilesAlive, STATGROUP_ThirdPersonMP, THIRDPERSONMP_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Attack Traces"), STAT_TPSAttackTraces, STATGROUP_ThirdPersonMP, THIRDPERSONMP_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Projectile Impacts"), STAT_TPSProjectileImpacts, STATGROUP_ThirdPersonMP, THIRDPERSONMP_API);
+
+/**
+ *  Times a gameplay hot path scope as a cycle stat, an Insights CPU event on the system's channel, and a CSV timing.
+ *  Usage: TPS_SCOPED_TIMER(AttackTrace, TPSCombat) for STAT_TPSAttackTrace, TPSCombatChannel and the TPSCombat CSV category
+ */
+#define TPS_SCOPED_TIMER(Name, System) \
+	SCOPE_CYCLE_COUNTER(STAT_TPS##Name); \
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(TPS##Name, System##Channel); \
+	CSV_SCOPED_TIMING_STAT(System, Name)
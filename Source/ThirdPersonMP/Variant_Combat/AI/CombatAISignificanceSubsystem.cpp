@@ -0,0 +1,327 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "CombatAISignificanceSubsystem.h"
+#include "CombatEnemy.h"
+#include "AIController.h"
+#include "BrainComponent.h"
+#include "Navigation/PathFollowingComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "TPSPlayerCacheSubsystem.h"
+#include "TPSDebugOverlaySubsystem.h"
+#include "TPSAdaptiveNetSubsystem.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "ThirdPersonMP.h"
+
+namespace CombatAISignificance
+{
+	static bool bEnabled = true;
+	static FAutoConsoleVariableRef CVarEnabled(
+		TEXT("TPS.AI.LOD.Enabled"),
+		bEnabled,
+		TEXT("If false, all combat enemies are kept at full tick rate."));
+
+	static float MediumDistance = 1500.0f;
+	static FAutoConsoleVariableRef CVarMediumDistance(
+		TEXT("TPS.AI.LOD.MediumDistance"),
+		MediumDistance,
+		TEXT("Distance to the nearest player beyond which enemies drop to the medium AI LOD bucket, in cm."));
+
+	static float LowDistance = 3000.0f;
+	static FAutoConsoleVariableRef CVarLowDistance(
+		TEXT("TPS.AI.LOD.LowDistance"),
+		LowDistance,
+		TEXT("Distance to the nearest player beyond which enemies drop to the low AI LOD bucket, in cm."));
+
+	static float FreezeDistance = 5000.0f;
+	static FAutoConsoleVariableRef CVarFreezeDistance(
+		TEXT("TPS.AI.LOD.FreezeDistance"),
+		FreezeDistance,
+		TEXT("Distance to the nearest player beyond which enemies no player can see are frozen, in cm."));
+
+	static float VisibilityHalfAngle = 60.0f;
+	static FAutoConsoleVariableRef CVarVisibilityHalfAngle(
+		TEXT("TPS.AI.LOD.VisibilityHalfAngle"),
+		VisibilityHalfAngle,
+		TEXT("Half angle of the view cone used to decide whether a player can see an enemy, in degrees."));
+
+	static float MediumTickInterval = 0.1f;
+	static FAutoConsoleVariableRef CVarMediumTickInterval(
+		TEXT("TPS.AI.LOD.MediumTickInterval"),
+		MediumTickInterval,
+		TEXT("Tick interval applied to enemies in the medium AI LOD bucket, in seconds."));
+
+	static float LowTickInterval = 0.25f;
+	static FAutoConsoleVariableRef CVarLowTickInterval(
+		TEXT("TPS.AI.LOD.LowTickInterval"),
+		LowTickInterval,
+		TEXT("Tick interval applied to enemies in the low AI LOD bucket, in seconds."));
+
+	static int32 EvaluationsPerFrame = 32;
+	static FAutoConsoleVariableRef CVarEvaluationsPerFrame(
+		TEXT("TPS.AI.LOD.EvaluationsPerFrame"),
+		EvaluationsPerFrame,
+		TEXT("Maximum number of enemies whose AI LOD bucket is re-evaluated each frame."));
+
+	static FAutoConsoleCommandWithWorld DumpCommand(
+		TEXT("TPS.AI.LOD.Dump"),
+		TEXT("Logs the number of combat enemies in each AI LOD bucket."),
+		FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+		{
+			if (UCombatAISignificanceSubsystem* Significance = UCombatAISignificanceSubsystem::Get(World))
+			{
+				Significance->DumpToLog();
+			}
+		}));
+
+	/** Returns the tick interval for a bucket */
+	static float GetTickInterval(ECombatAILODBucket Bucket)
+	{
+		switch (Bucket)
+		{
+		case ECombatAILODBucket::Medium:
+			return MediumTickInterval;
+
+		case ECombatAILODBucket::Low:
+		case ECombatAILODBucket::Frozen:
+			return LowTickInterval;
+
+		default:
+			return 0.0f;
+		}
+	}
+}
+
+UCombatAISignificanceSubsystem* UCombatAISignificanceSubsystem::Get(const UWorld* World)
+{
+	return World ? World->GetSubsystem<UCombatAISignificanceSubsystem>() : nullptr;
+}
+
+void UCombatAISignificanceSubsystem::RegisterEnemy(ACombatEnemy* Enemy)
+{
+	if (!Enemy || Enemies.ContainsByPredicate([Enemy](const FEnemySignificance& Entry) { return Entry.Enemy == Enemy; }))
+	{
+		return;
+	}
+
+	FEnemySignificance& NewEntry = Enemies.AddDefaulted_GetRef();
+	NewEntry.Enemy = Enemy;
+}
+
+void UCombatAISignificanceSubsystem::UnregisterEnemy(ACombatEnemy* Enemy)
+{
+	const int32 Index = Enemies.IndexOfByPredicate([Enemy](const FEnemySignificance& Entry) { return Entry.Enemy == Enemy; });
+
+	if (Index != INDEX_NONE)
+	{
+		// restore full rate in case the enemy is reused
+		if (Enemies[Index].Bucket != ECombatAILODBucket::High)
+		{
+			ApplyBucket(Enemy, ECombatAILODBucket::High);
+		}
+
+		Enemies.RemoveAt(Index);
+	}
+}
+
+void UCombatAISignificanceSubsystem::RequestFullRate(ACombatEnemy* Enemy)
+{
+	for (FEnemySignificance& Entry : Enemies)
+	{
+		if (Entry.Enemy == Enemy)
+		{
+			if (Entry.Bucket != ECombatAILODBucket::High)
+			{
+				Entry.Bucket = ECombatAILODBucket::High;
+				ApplyBucket(Enemy, ECombatAILODBucket::High);
+			}
+
+			return;
+		}
+	}
+}
+
+ECombatAILODBucket UCombatAISignificanceSubsystem::GetBucket(const ACombatEnemy* Enemy) const
+{
+	const FEnemySignificance* Entry = Enemies.FindByPredicate([Enemy](const FEnemySignificance& Entry) { return Entry.Enemy == Enemy; });
+
+	return Entry ? Entry->Bucket : ECombatAILODBucket::High;
+}
+
+void UCombatAISignificanceSubsystem::DumpToLog() const
+{
+	int32 BucketCounts[4] = { 0, 0, 0, 0 };
+
+	for (const FEnemySignificance& Entry : Enemies)
+	{
+		++BucketCounts[static_cast<uint8>(Entry.Bucket)];
+	}
+
+	UE_LOG(LogThirdPersonMP, Log, TEXT("Combat AI LOD: %d enemies. High: %d, Medium: %d, Low: %d, Frozen: %d"),
+		Enemies.Num(),
+		BucketCounts[0],
+		BucketCounts[1],
+		BucketCounts[2],
+		BucketCounts[3]);
+}
+
+void UCombatAISignificanceSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	// drop any enemies that went away without unregistering
+	Enemies.RemoveAllSwap([](const FEnemySignificance& Entry) { return !Entry.Enemy.IsValid(); }, EAllowShrinking::No);
+
+	if (Enemies.IsEmpty())
+	{
+		return;
+	}
+
+	// evaluate a slice of the enemies, round-robin
+	const int32 NumEvaluations = FMath::Min(Enemies.Num(), FMath::Max(1, CombatAISignificance::EvaluationsPerFrame));
+
+	for (int32 i = 0; i < NumEvaluations; ++i)
+	{
+		NextEvaluationIndex = NextEvaluationIndex % Enemies.Num();
+
+		FEnemySignificance& Entry = Enemies[NextEvaluationIndex++];
+		ACombatEnemy* Enemy = Entry.Enemy.Get();
+
+		const ECombatAILODBucket NewBucket = EvaluateBucket(Enemy);
+
+		// only touch the components if the bucket changed
+		if (NewBucket != Entry.Bucket)
+		{
+			Entry.Bucket = NewBucket;
+			ApplyBucket(Enemy, NewBucket);
+		}
+
+		TPS_DEBUG_ACTOR_MESSAGE(Enemy, AI, FVector(0.0f, 0.0f, 120.0f), 1.0f, FColor::Cyan, TEXT("LOD: %s"), *StaticEnum<ECombatAILODBucket>()->GetNameStringByValue(static_cast<int64>(NewBucket)));
+	}
+}
+
+TStatId UCombatAISignificanceSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCombatAISignificanceSubsystem, STATGROUP_Tickables);
+}
+
+bool UCombatAISignificanceSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UCombatAISignificanceSubsystem::Deinitialize()
+{
+	Enemies.Reset();
+
+	Super::Deinitialize();
+}
+
+ECombatAILODBucket UCombatAISignificanceSubsystem::EvaluateBucket(const ACombatEnemy* Enemy) const
+{
+	if (!CombatAISignificance::bEnabled)
+	{
+		return ECombatAILODBucket::High;
+	}
+
+	const FVector EnemyLocation = Enemy->GetActorLocation();
+
+	// pull the distances in while the server is under load
+	const UTPSAdaptiveNetSubsystem* AdaptiveNet = UTPSAdaptiveNetSubsystem::Get(GetWorld());
+	const float DistanceScale = AdaptiveNet ? AdaptiveNet->GetAILODDistanceScale() : 1.0f;
+
+	const double CosVisibilityAngle = FMath::Cos(FMath::DegreesToRadians(CombatAISignificance::VisibilityHalfAngle));
+
+	double NearestDistSquared = TNumericLimits<double>::Max();
+	bool bVisible = false;
+
+	// find the nearest player and check if any player can see the enemy
+	if (UTPSPlayerCacheSubsystem* PlayerCache = UTPSPlayerCacheSubsystem::Get(GetWorld()))
+	{
+		for (const FTPSCachedPlayer& Player : PlayerCache->GetPlayers())
+		{
+			NearestDistSquared = FMath::Min(NearestDistSquared, FVector::DistSquared(Player.Location, EnemyLocation));
+
+			// is the enemy inside this player's view cone?
+			if (!bVisible)
+			{
+				const FVector ToEnemy = (EnemyLocation - Player.ViewLocation).GetSafeNormal();
+				bVisible = (ToEnemy | Player.ViewDirection) >= CosVisibilityAngle;
+			}
+		}
+	}
+
+	// freeze distant enemies no one can see, unless they're airborne
+	if (!bVisible && NearestDistSquared >= FMath::Square(CombatAISignificance::FreezeDistance * DistanceScale) && Enemy->GetCharacterMovement()->IsMovingOnGround())
+	{
+		return ECombatAILODBucket::Frozen;
+	}
+
+	// bucket by distance
+	uint8 Bucket = static_cast<uint8>(ECombatAILODBucket::High);
+
+	if (NearestDistSquared >= FMath::Square(CombatAISignificance::LowDistance * DistanceScale))
+	{
+		Bucket = static_cast<uint8>(ECombatAILODBucket::Low);
+	}
+	else if (NearestDistSquared >= FMath::Square(CombatAISignificance::MediumDistance * DistanceScale))
+	{
+		Bucket = static_cast<uint8>(ECombatAILODBucket::Medium);
+	}
+
+	// drop off-screen enemies one bucket
+	if (!bVisible)
+	{
+		Bucket = FMath::Min<uint8>(Bucket + 1, static_cast<uint8>(ECombatAILODBucket::Low));
+	}
+
+	return static_cast<ECombatAILODBucket>(Bucket);
+}
+
+void UCombatAISignificanceSubsystem::ApplyBucket(ACombatEnemy* Enemy, ECombatAILODBucket Bucket)
+{
+	const bool bTickEnabled = Bucket != ECombatAILODBucket::Frozen;
+	const float TickInterval = CombatAISignificance::GetTickInterval(Bucket);
+
+	// throttle the actor itself
+	Enemy->SetActorTickInterval(TickInterval);
+	Enemy->SetActorTickEnabled(bTickEnabled);
+
+	// throttle animation. Montage notifies still fire as the skipped time is accumulated
+	if (USkeletalMeshComponent* Mesh = Enemy->GetMesh())
+	{
+		Mesh->SetComponentTickInterval(TickInterval);
+		Mesh->SetComponentTickEnabled(bTickEnabled);
+	}
+
+	// AI and movement only run with authority
+	if (!Enemy->HasAuthority())
+	{
+		return;
+	}
+
+	if (UCharacterMovementComponent* Movement = Enemy->GetCharacterMovement())
+	{
+		Movement->SetComponentTickInterval(TickInterval);
+		Movement->SetComponentTickEnabled(bTickEnabled);
+	}
+
+	if (AAIController* AIController = Cast<AAIController>(Enemy->GetController()))
+	{
+		// throttle the StateTree. This also throttles the EQS queries and player info updates it drives
+		if (UBrainComponent* Brain = AIController->FindComponentByClass<UBrainComponent>())
+		{
+			Brain->SetComponentTickInterval(TickInterval);
+			Brain->SetComponentTickEnabled(bTickEnabled);
+		}
+
+		// throttle path following
+		if (UPathFollowingComponent* PathFollowing = AIController->GetPathFollowingComponent())
+		{
+			PathFollowing->SetComponentTickInterval(TickInterval);
+			PathFollowing->SetComponentTickEnabled(bTickEnabled);
+		}
+	}
+}
@@ -0,0 +1,90 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CombatAISignificanceSubsystem.generated.h"
+
+class ACombatEnemy;
+
+/**
+ *  AI level of detail buckets, from most to least significant
+ */
+UENUM(BlueprintType)
+enum class ECombatAILODBucket : uint8
+{
+	High,
+	Medium,
+	Low,
+	Frozen
+};
+
+/**
+ *  Buckets combat enemies by distance and visibility to the nearest player,
+ *  and throttles their StateTree, character movement and animation ticks per bucket.
+ *  Distant enemies that no player can see are frozen entirely until they become significant again.
+ *  Enemies are evaluated round-robin so the cost of the manager itself stays bounded.
+ */
+UCLASS()
+class UCombatAISignificanceSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+	/** Significance state of a single enemy */
+	struct FEnemySignificance
+	{
+		/** Tracked enemy */
+		TWeakObjectPtr<ACombatEnemy> Enemy;
+
+		/** Bucket currently applied to the enemy */
+		ECombatAILODBucket Bucket = ECombatAILODBucket::High;
+	};
+
+	/** Tracked enemies */
+	TArray<FEnemySignificance> Enemies;
+
+	/** Index of the next enemy to evaluate */
+	int32 NextEvaluationIndex = 0;
+
+public:
+
+	/** Returns the subsystem for the provided world, if any */
+	static UCombatAISignificanceSubsystem* Get(const UWorld* World);
+
+	/** Starts managing an enemy's significance */
+	void RegisterEnemy(ACombatEnemy* Enemy);
+
+	/** Stops managing an enemy's significance and restores its full tick rate */
+	void UnregisterEnemy(ACombatEnemy* Enemy);
+
+	/** Immediately restores an enemy to full rate, e.g. after it takes damage. It will be re-evaluated on its next turn */
+	void RequestFullRate(ACombatEnemy* Enemy);
+
+	/** Returns the bucket currently applied to an enemy */
+	ECombatAILODBucket GetBucket(const ACombatEnemy* Enemy) const;
+
+	/** Logs the number of enemies in each bucket */
+	void DumpToLog() const;
+
+public:
+
+	// ~begin FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	// ~end FTickableGameObject interface
+
+protected:
+
+	/** Only create this subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Cleanup */
+	virtual void Deinitialize() override;
+
+	/** Calculates the bucket an enemy should be in */
+	ECombatAILODBucket EvaluateBucket(const ACombatEnemy* Enemy) const;
+
+	/** Applies the tick settings for a bucket to an enemy */
+	static void ApplyBucket(ACombatEnemy* Enemy, ECombatAILODBucket Bucket);
+};
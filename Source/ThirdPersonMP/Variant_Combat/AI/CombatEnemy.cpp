@@ -5,12 +5,25 @@
 #include "Components/CapsuleComponent.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "CombatAIController.h"
-#include "Components/WidgetComponent.h"
 #include "Engine/DamageEvents.h"
-#include "CombatLifeBar.h"
+#include "CombatLifeBarSubsystem.h"
 #include "TimerManager.h"
 #include "Components/SkeletalMeshComponent.h"
 #include "Animation/AnimInstance.h"
+#include "CombatMeleeQuerySubsystem.h"
+#include "CombatAISignificanceSubsystem.h"
+#include "CombatEnemyPoolSubsystem.h"
+#include "CombatSpatialHashSubsystem.h"
+#include "CombatRagdollSubsystem.h"
+#include "CombatDamageSubsystem.h"
+#include "CombatHitTimelineComponent.h"
+#include "CombatAttackTimeline.h"
+#include "TPSDeterminismSubsystem.h"
+#include "TPSAdaptiveNetSubsystem.h"
+#include "CombatArenaSubsystem.h"
+#include "ThirdPersonMPStats.h"
+#include "AIController.h"
+#include "BrainComponent.h"
 
 ACombatEnemy::ACombatEnemy()
 {
@@ -28,9 +41,9 @@ ACombatEnemy::ACombatEnemy()
 	// ignore the controller's yaw rotation
 	bUseControllerRotationYaw = false;
 
-	// create the life bar
-	LifeBar = CreateDefaultSubobject<UWidgetComponent>(TEXT("LifeBar"));
-	LifeBar->SetupAttachment(RootComponent);
+	// create the server hit timeline
+	HitTimeline = CreateDefaultSubobject<UCombatHitTimelineComponent>(TEXT("HitTimeline"));
+	HitTimeline->OnTimelineEnded.BindUObject(this, &ACombatEnemy::AttackTimelineEnded);
 
 	// set the collision capsule size
 	GetCapsuleComponent()->SetCapsuleSize(35.0f, 90.0f);
@@ -54,18 +67,21 @@ void ACombatEnemy::DoAIComboAttack()
 	bIsAttacking = true;
 
 	// choose how many times we're going to attack
-	TargetComboCount = FMath::RandRange(1, ComboSectionNames.Num() - 1);
+	TargetComboCount = UTPSDeterminismSubsystem::RandRange(this, 1, ComboSectionNames.Num() - 1);
 
 	// reset the attack counter
 	CurrentComboAttack = 0;
 
+	// on the server, let the hit timeline drive the attack events and completion
+	const bool bTimelineDriven = HitTimeline->Play(ComboAttackTimeline);
+
 	// play the attack montage
 	if (UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance())
 	{
 		const float MontageLength = AnimInstance->Montage_Play(ComboAttackMontage, 1.0f, EMontagePlayReturnType::MontageLength, 0.0f, true);
 
 		// subscribe to montage completed and interrupted events
-		if (MontageLength > 0.0f)
+		if (MontageLength > 0.0f && !bTimelineDriven)
 		{
 			// set the end delegate for the montage
 			AnimInstance->Montage_SetEndDelegate(OnAttackMontageEnded, ComboAttackMontage);
@@ -85,18 +101,21 @@ void ACombatEnemy::DoAIChargedAttack()
 	bIsAttacking = true;
 
 	// choose how many loops are we going to charge for
-	TargetChargeLoops = FMath::RandRange(MinChargeLoops, MaxChargeLoops);
+	TargetChargeLoops = UTPSDeterminismSubsystem::RandRange(this, MinChargeLoops, MaxChargeLoops);
 
 	// reset the charge loop counter
 	CurrentChargeLoop = 0;
 
+	// on the server, let the hit timeline drive the attack events and completion
+	const bool bTimelineDriven = HitTimeline->Play(ChargedAttackTimeline);
+
 	// play the attack montage
 	if (UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance())
 	{
 		const float MontageLength = AnimInstance->Montage_Play(ChargedAttackMontage, 1.0f, EMontagePlayReturnType::MontageLength, 0.0f, true);
 
 		// subscribe to montage completed and interrupted events
-		if (MontageLength > 0.0f)
+		if (MontageLength > 0.0f && !bTimelineDriven)
 		{
 			// set the end delegate for the montage
 			AnimInstance->Montage_SetEndDelegate(OnAttackMontageEnded, ChargedAttackMontage);
@@ -113,6 +132,12 @@ void ACombatEnemy::AttackMontageEnded(UAnimMontage* Montage, bool bInterrupted)
 	OnAttackCompleted.ExecuteIfBound();
 }
 
+void ACombatEnemy::AttackTimelineEnded(bool bInterrupted)
+{
+	// the timeline stands in for the montage, so complete the attack the same way
+	AttackMontageEnded(nullptr, bInterrupted);
+}
+
 const FVector& ACombatEnemy::GetLastDangerLocation() const
 {
 	return LastDangerLocation;
@@ -125,45 +150,59 @@ float ACombatEnemy::GetLastDangerTime() const
 
 void ACombatEnemy::DoAttackTrace(FName DamageSourceBone)
 {
+	TPS_SCOPED_TIMER(AttackTrace, TPSCombat);
+	INC_DWORD_STAT(STAT_TPSAttackTraces);
+
 	// sweep for objects in front of the character to be hit by the attack
-	TArray<FHitResult> OutHits;
+	FCombatMeleeQuery Query;
+	Query.Attacker = this;
 
-	// start at the provided socket location, sweep forward
-	const FVector TraceStart = GetMesh()->GetSocketLocation(DamageSourceBone);
-	const FVector TraceEnd = TraceStart + (GetActorForwardVector() * MeleeTraceDistance);
+	// start at the provided socket location, sweep forward. Timeline events carry the socket offset baked from the montage,
+	// since the server may not be ticking the pose
+	const FCombatTimelineEvent* TimelineEvent = HitTimeline->GetFiringEvent();
 
-	// enemies only affect Pawn collision objects; they don't knock back boxes
-	FCollisionObjectQueryParams ObjectParams;
-	ObjectParams.AddObjectTypesToQuery(ECC_Pawn);
+	if (TimelineEvent && TimelineEvent->bHasSourceOffset)
+	{
+		Query.Start = GetMesh()->GetComponentTransform().TransformPosition(TimelineEvent->SourceOffset);
+	}
+	else
+	{
+		Query.Start = GetMesh()->GetSocketLocation(DamageSourceBone);
+	}
+
+	Query.End = Query.Start + (GetActorForwardVector() * MeleeTraceDistance);
 
 	// use a sphere shape for the sweep
-	FCollisionShape CollisionShape;
-	CollisionShape.SetSphere(MeleeTraceRadius);
+	Query.Radius = MeleeTraceRadius;
 
-	// ignore self
-	FCollisionQueryParams QueryParams;
-	QueryParams.AddIgnoredActor(this);
+	// enemies only affect Pawn collision objects; they don't knock back boxes
+	Query.ObjectParams.AddObjectTypesToQuery(ECC_Pawn);
 
-	if (GetWorld()->SweepMultiByObjectType(OutHits, TraceStart, TraceEnd, FQuat::Identity, ObjectParams, CollisionShape, QueryParams))
+	// hand the sweep over to the melee query batch. Results come back through ResolveAttackTrace
+	if (UCombatMeleeQuerySubsystem* MeleeQueries = UCombatMeleeQuerySubsystem::Get(GetWorld()))
 	{
-		// iterate over each object hit
-		for (const FHitResult& CurrentHit : OutHits)
-		{
-			/** does the actor have the player tag? */
-			if (CurrentHit.GetActor()->ActorHasTag(FName("Player")))
-			{
-				// check if the actor is damageable
-				ICombatDamageable* Damageable = Cast<ICombatDamageable>(CurrentHit.GetActor());
+		MeleeQueries->SubmitQuery(Query);
+	}
+}
 
-				if (Damageable)
-				{
-					// knock upwards and away from the impact normal
-					const FVector Impulse = (CurrentHit.ImpactNormal * -MeleeKnockbackImpulse) + (FVector::UpVector * MeleeLaunchImpulse);
+void ACombatEnemy::ResolveAttackTrace(const TArray<FHitResult>& Hits)
+{
+	// iterate over each object hit
+	for (const FHitResult& CurrentHit : Hits)
+	{
+		/** does the actor have the player tag? */
+		if (CurrentHit.GetActor() && CurrentHit.GetActor()->ActorHasTag(FName("Player")))
+		{
+			// check if the actor is damageable
+			ICombatDamageable* Damageable = Cast<ICombatDamageable>(CurrentHit.GetActor());
 
-					// pass the damage event to the actor
-					Damageable->ApplyDamage(MeleeDamage, this, CurrentHit.ImpactPoint, Impulse);
+			if (Damageable)
+			{
+				// knock upwards and away from the impact normal
+				const FVector Impulse = (CurrentHit.ImpactNormal * -MeleeKnockbackImpulse) + (FVector::UpVector * MeleeLaunchImpulse);
 
-				}
+				// queue the damage event for the actor
+				UCombatDamageSubsystem::ApplyOrQueueDamage(CurrentHit.GetActor(), MeleeDamage, this, CurrentHit.ImpactPoint, Impulse);
 			}
 		}
 	}
@@ -182,6 +221,9 @@ void ACombatEnemy::CheckCombo()
 		{
 			AnimInstance->Montage_JumpToSection(ComboSectionNames[CurrentComboAttack], ComboAttackMontage);
 		}
+
+		// keep the server hit timeline in step
+		HitTimeline->JumpToSection(ComboSectionNames[CurrentComboAttack]);
 	}
 }
 
@@ -191,15 +233,25 @@ void ACombatEnemy::CheckChargedAttack()
 	++CurrentChargeLoop;
 
 	// jump to either the loop or attack section of the montage depending on whether we hit the loop target
+	const FName NextSection = CurrentChargeLoop >= TargetChargeLoops ? ChargeAttackSection : ChargeLoopSection;
+
 	if (UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance())
 	{
-		AnimInstance->Montage_JumpToSection(CurrentChargeLoop >= TargetChargeLoops ? ChargeAttackSection : ChargeLoopSection, ChargedAttackMontage);
+		AnimInstance->Montage_JumpToSection(NextSection, ChargedAttackMontage);
 	}
+
+	// keep the server hit timeline in step
+	HitTimeline->JumpToSection(NextSection);
 }
 
 void ACombatEnemy::ApplyDamage(float Damage, AActor* DamageCauser, const FVector& DamageLocation, const FVector& DamageImpulse)
 {
-	
+	// make sure we're running at full rate so we can react
+	if (UCombatAISignificanceSubsystem* Significance = UCombatAISignificanceSubsystem::Get(GetWorld()))
+	{
+		Significance->RequestFullRate(this);
+	}
+
 	// pass the damage event to the actor
 	FDamageEvent DamageEvent;
 	const float ActualDamage = TakeDamage(Damage, DamageEvent, nullptr, DamageCauser);
@@ -224,6 +276,9 @@ void ACombatEnemy::ApplyDamage(float Damage, AActor* DamageCauser, const FVector
 			AnimInstance->Montage_Stop(0.1f, ChargedAttackMontage);
 		}
 
+		// interrupt the server hit timeline too
+		HitTimeline->Stop(true);
+
 		// pass control to BP to play effects, etc.
 		ReceivedDamage(ActualDamage, DamageLocation, DamageImpulse.GetSafeNormal());
 	}
@@ -232,16 +287,29 @@ void ACombatEnemy::ApplyDamage(float Damage, AActor* DamageCauser, const FVector
 void ACombatEnemy::HandleDeath()
 {
 	// hide the life bar
-	LifeBar->SetHiddenInGame(true);
+	if (UCombatLifeBarSubsystem* LifeBars = UCombatLifeBarSubsystem::Get(GetWorld()))
+	{
+		LifeBars->SetVisible(this, false);
+	}
 
-	// disable the collision capsule to avoid being hit again while dead
-	GetCapsuleComponent()->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	UCombatRagdollSubsystem* Ragdolls = UCombatRagdollSubsystem::Get(GetWorld());
 
-	// disable character movement
-	GetCharacterMovement()->DisableMovement();
+	// dedicated servers let the death blow knock the capsule back instead of ragdolling.
+	// The subsystem disables movement and collision once it's over
+	if (!Ragdolls || !Ragdolls->RequestCapsuleKnockback(this, true))
+	{
+		// disable the collision capsule to avoid being hit again while dead
+		GetCapsuleComponent()->SetCollisionEnabled(ECollisionEnabled::NoCollision);
 
-	// enable full ragdoll physics
-	GetMesh()->SetSimulatePhysics(true);
+		// disable character movement
+		GetCharacterMovement()->DisableMovement();
+	}
+
+	// enable full ragdoll physics, if the ragdoll budget allows it
+	if (Ragdolls)
+	{
+		Ragdolls->RequestRagdoll(GetMesh());
+	}
 
 	// call the died delegate to notify any subscribers
 	OnEnemyDied.Broadcast();
@@ -263,15 +331,145 @@ void ACombatEnemy::NotifyDanger(const FVector& DangerLocation, AActor* DangerSou
 		// save the danger location and game time
 		LastDangerLocation = DangerLocation;
 		LastDangerTime = GetWorld()->GetTimeSeconds();
+
+		// make sure we're running at full rate so we can react
+		if (UCombatAISignificanceSubsystem* Significance = UCombatAISignificanceSubsystem::Get(GetWorld()))
+		{
+			Significance->RequestFullRate(this);
+		}
 	}
 }
 
 void ACombatEnemy::RemoveFromLevel()
 {
-	// destroy this actor
+	// return this actor to the enemy pool, or destroy it if we can't be pooled
+	if (UCombatEnemyPoolSubsystem* Pool = UCombatEnemyPoolSubsystem::Get(GetWorld()))
+	{
+		Pool->ReleaseEnemy(this);
+		return;
+	}
+
 	Destroy();
 }
 
+void ACombatEnemy::ResetForReuse(const FTransform& SpawnTransform)
+{
+	// stop any knockback still running from our last death
+	if (UCombatRagdollSubsystem* Ragdolls = UCombatRagdollSubsystem::Get(GetWorld()))
+	{
+		Ragdolls->CancelCapsuleKnockback(this);
+	}
+
+	// stop ragdolling and reattach the mesh at its original relative transform
+	GetMesh()->SetSimulatePhysics(false);
+	GetMesh()->SetPhysicsBlendWeight(0.0f);
+	GetMesh()->AttachToComponent(GetCapsuleComponent(), FAttachmentTransformRules::KeepRelativeTransform);
+	GetMesh()->SetRelativeTransform(MeshStartingTransform, false, nullptr, ETeleportType::ResetPhysics);
+
+	// move to the spawn location
+	SetActorTransform(SpawnTransform, false, nullptr, ETeleportType::ResetPhysics);
+
+	// reactivate the actor
+	SetActorHiddenInGame(false);
+	SetActorEnableCollision(true);
+	SetActorTickEnabled(true);
+	GetCapsuleComponent()->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
+	GetMesh()->SetComponentTickEnabled(true);
+
+	// restore movement
+	GetCharacterMovement()->SetComponentTickEnabled(true);
+	GetCharacterMovement()->StopMovementImmediately();
+	GetCharacterMovement()->SetDefaultMovementMode();
+
+	// reset the combat state
+	CurrentHP = MaxHP;
+	bIsAttacking = false;
+	TargetComboCount = 0;
+	CurrentComboAttack = 0;
+	TargetChargeLoops = 0;
+	CurrentChargeLoop = 0;
+	LastDangerLocation = FVector::ZeroVector;
+	LastDangerTime = -1000.0f;
+
+	// refill the life bar
+	if (UCombatLifeBarSubsystem* LifeBars = UCombatLifeBarSubsystem::Get(GetWorld()))
+	{
+		LifeBars->SetVisible(this, true);
+		LifeBars->SetPercentage(this, 1.0f);
+	}
+
+	// re-possess with our previous controller. This restarts the StateTree from scratch
+	if (AController* PreviousController = PooledController.Get())
+	{
+		PreviousController->Possess(this);
+	}
+	else
+	{
+		SpawnDefaultController();
+	}
+
+	PooledController.Reset();
+
+	// resume AI LOD and spatial tracking
+	if (UCombatAISignificanceSubsystem* Significance = UCombatAISignificanceSubsystem::Get(GetWorld()))
+	{
+		Significance->RegisterEnemy(this);
+	}
+
+	if (UCombatSpatialHashSubsystem* SpatialHash = UCombatSpatialHashSubsystem::Get(GetWorld()))
+	{
+		SpatialHash->RegisterActor(this);
+	}
+}
+
+void ACombatEnemy::DeactivateForPool()
+{
+	// clear any pending timers and death subscribers
+	GetWorld()->GetTimerManager().ClearTimer(DeathTimer);
+	OnEnemyDied.Clear();
+	OnAttackCompleted.Unbind();
+	OnEnemyLanded.Unbind();
+
+	// stop the StateTree and unpossess, but keep the controller around for reuse
+	if (AAIController* AIController = Cast<AAIController>(GetController()))
+	{
+		if (UBrainComponent* Brain = AIController->FindComponentByClass<UBrainComponent>())
+		{
+			Brain->StopLogic(TEXT("Pooled"));
+		}
+
+		PooledController = AIController;
+		AIController->UnPossess();
+	}
+
+	// stop AI LOD and spatial tracking
+	if (UCombatAISignificanceSubsystem* Significance = UCombatAISignificanceSubsystem::Get(GetWorld()))
+	{
+		Significance->UnregisterEnemy(this);
+	}
+
+	if (UCombatSpatialHashSubsystem* SpatialHash = UCombatSpatialHashSubsystem::Get(GetWorld()))
+	{
+		SpatialHash->UnregisterActor(this);
+	}
+
+	// stop the ragdoll, any animations and the hit timeline
+	GetMesh()->SetSimulatePhysics(false);
+	HitTimeline->Stop(true);
+
+	if (UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance())
+	{
+		AnimInstance->StopAllMontages(0.0f);
+	}
+
+	// deactivate the actor
+	SetActorHiddenInGame(true);
+	SetActorEnableCollision(false);
+	SetActorTickEnabled(false);
+	GetMesh()->SetComponentTickEnabled(false);
+	GetCharacterMovement()->SetComponentTickEnabled(false);
+}
+
 float ACombatEnemy::TakeDamage(float Damage, struct FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser)
 {
 	// only process damage if the character is still alive
@@ -292,11 +490,19 @@ float ACombatEnemy::TakeDamage(float Damage, struct FDamageEvent const& DamageEv
 	else
 	{
 		// update the life bar
-		LifeBarWidget->SetLifePercentage(CurrentHP / MaxHP);
+		if (UCombatLifeBarSubsystem* LifeBars = UCombatLifeBarSubsystem::Get(GetWorld()))
+		{
+			LifeBars->SetPercentage(this, CurrentHP / MaxHP);
+		}
 
-		// enable partial ragdoll physics, but keep the pelvis vertical
-		GetMesh()->SetPhysicsBlendWeight(0.5f);
-		GetMesh()->SetBodySimulatePhysics(PelvisBoneName, false);
+		// enable partial ragdoll physics, but keep the pelvis vertical. Skip it if we're out of ragdoll budget
+		UCombatRagdollSubsystem* Ragdolls = UCombatRagdollSubsystem::Get(GetWorld());
+
+		if (Ragdolls && Ragdolls->CanPlayHitReaction())
+		{
+			GetMesh()->SetPhysicsBlendWeight(0.5f);
+			GetMesh()->SetBodySimulatePhysics(PelvisBoneName, false);
+		}
 	}
 
 	// return the received damage amount
@@ -326,12 +532,39 @@ void ACombatEnemy::BeginPlay()
 	// we top the HP before BeginPlay so StateTree picks it up at the right value
 	Super::BeginPlay();
 
-	// get the life bar widget from the widget comp
-	LifeBarWidget = Cast<UCombatLifeBar>(LifeBar->GetUserWidgetObject());
-	check(LifeBarWidget);
+	// save the mesh's relative transform so it can be restored when this enemy is reused
+	MeshStartingTransform = GetMesh()->GetRelativeTransform();
 
-	// fill the life bar
-	LifeBarWidget->SetLifePercentage(1.0f);
+	// add a full life bar to the batched life bar renderer
+	if (UCombatLifeBarSubsystem* LifeBars = UCombatLifeBarSubsystem::Get(GetWorld()))
+	{
+		LifeBars->RegisterBar(this, LifeBarOffset, LifeBarColor);
+		LifeBars->SetPercentage(this, 1.0f);
+	}
+
+	// a dedicated server doesn't need poses to time or aim attacks if both attacks are timeline driven
+	if (GetNetMode() == NM_DedicatedServer && ComboAttackTimeline && ChargedAttackTimeline)
+	{
+		GetMesh()->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::OnlyTickPoseWhenRendered;
+	}
+
+	// let the AI LOD manager throttle us when we're not significant
+	if (UCombatAISignificanceSubsystem* Significance = UCombatAISignificanceSubsystem::Get(GetWorld()))
+	{
+		Significance->RegisterEnemy(this);
+	}
+
+	// let the server scale our net update frequency under load
+	if (UTPSAdaptiveNetSubsystem* AdaptiveNet = UTPSAdaptiveNetSubsystem::Get(GetWorld()))
+	{
+		AdaptiveNet->RegisterActor(this, ETPSAdaptiveNetClass::Enemy);
+	}
+
+	// only replicate to the players in our arena
+	if (UCombatArenaSubsystem* Arenas = UCombatArenaSubsystem::Get(GetWorld()))
+	{
+		Arenas->RegisterActor(this);
+	}
 }
 
 void ACombatEnemy::EndPlay(EEndPlayReason::Type EndPlayReason)
@@ -340,4 +573,42 @@ void ACombatEnemy::EndPlay(EEndPlayReason::Type EndPlayReason)
 
 	// clear the death timer
 	GetWorld()->GetTimerManager().ClearTimer(DeathTimer);
+
+	// stop AI LOD management
+	if (UCombatAISignificanceSubsystem* Significance = UCombatAISignificanceSubsystem::Get(GetWorld()))
+	{
+		Significance->UnregisterEnemy(this);
+	}
+
+	// stop net update frequency scaling
+	if (UTPSAdaptiveNetSubsystem* AdaptiveNet = UTPSAdaptiveNetSubsystem::Get(GetWorld()))
+	{
+		AdaptiveNet->UnregisterActor(this, ETPSAdaptiveNetClass::Enemy);
+	}
+
+	// leave our arena
+	if (UCombatArenaSubsystem* Arenas = UCombatArenaSubsystem::Get(GetWorld()))
+	{
+		Arenas->UnregisterActor(this);
+	}
+
+	// remove our life bar
+	if (UCombatLifeBarSubsystem* LifeBars = UCombatLifeBarSubsystem::Get(GetWorld()))
+	{
+		LifeBars->UnregisterBar(this);
+	}
+}
+
+bool ACombatEnemy::IsNetRelevantFor(const AActor* RealViewer, const AActor* ViewTarget, const FVector& SrcLocation) const
+{
+	// skip connections whose player is in an unrelated arena
+	if (const UCombatArenaSubsystem* Arenas = UCombatArenaSubsystem::Get(GetWorld()))
+	{
+		if (!Arenas->IsRelevantForViewer(this, RealViewer, ViewTarget))
+		{
+			return false;
+		}
+	}
+
+	return Super::IsNetRelevantFor(RealViewer, ViewTarget, SrcLocation);
 }
@@ -10,9 +10,9 @@
 #include "Engine/TimerHandle.h"
 #include "CombatEnemy.generated.h"
 
-class UWidgetComponent;
-class UCombatLifeBar;
 class UAnimMontage;
+class UCombatAttackTimeline;
+class UCombatHitTimelineComponent;
 
 /** Completed attack animation delegate for StateTree */
 DECLARE_DELEGATE(FOnEnemyAttackCompleted);
@@ -32,9 +32,9 @@ class ACombatEnemy : public ACharacter, public ICombatAttacker, public ICombatDa
 {
 	GENERATED_BODY()
 
-	/** Life bar widget component */
+	/** Drives attack traces and combo checks on the server, independently of animation */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Components", meta = (AllowPrivateAccess = "true"))
-	UWidgetComponent* LifeBar;
+	UCombatHitTimelineComponent* HitTimeline;
 
 public:
 	
@@ -59,9 +59,13 @@ protected:
 	UPROPERTY(EditAnywhere, Category="Damage")
 	FName PelvisBoneName;
 
-	/** Pointer to the life bar widget */
+	/** Life bar fill color */
 	UPROPERTY(EditAnywhere, Category="Damage")
-	UCombatLifeBar* LifeBarWidget;
+	FLinearColor LifeBarColor = FLinearColor::Red;
+
+	/** Offset from the character's location to the overhead life bar */
+	UPROPERTY(EditAnywhere, Category="Damage")
+	FVector LifeBarOffset = FVector(0.0f, 0.0f, 120.0f);
 
 	/** If true, the character is currently playing an attack animation */
 	bool bIsAttacking = false;
@@ -94,6 +98,10 @@ protected:
 	UPROPERTY(EditAnywhere, Category="Melee Attack|Combo")
 	TArray<FName> ComboSectionNames;
 
+	/** Server hit timeline extracted from the combo attack montage */
+	UPROPERTY(EditAnywhere, Category="Melee Attack|Combo")
+	TObjectPtr<UCombatAttackTimeline> ComboAttackTimeline;
+
 	/** Target number of attacks in the combo attack string we're playing */
 	int32 TargetComboCount = 0;
 
@@ -112,6 +120,10 @@ protected:
 	UPROPERTY(EditAnywhere, Category="Melee Attack|Charged")
 	FName ChargeAttackSection;
 
+	/** Server hit timeline extracted from the charged attack montage */
+	UPROPERTY(EditAnywhere, Category="Melee Attack|Charged")
+	TObjectPtr<UCombatAttackTimeline> ChargedAttackTimeline;
+
 	/** Minimum number of charge animation loops that will be played by the AI */
 	UPROPERTY(EditAnywhere, Category="Melee Attack|Charged", meta = (ClampMin = 1, ClampMax = 20))
 	int32 MinChargeLoops = 2;
@@ -142,6 +154,12 @@ protected:
 	/** Last recorded game time we were attacked */
 	float LastDangerTime = -1000.0f;
 
+	/** Relative transform of the mesh at BeginPlay, so it can be restored after ragdolling */
+	FTransform MeshStartingTransform;
+
+	/** Controller kept while this enemy is pooled, so it can be re-possessed on reuse */
+	TWeakObjectPtr<AController> PooledController;
+
 public:
 	/** Attack completed internal delegate to notify StateTree tasks */
 	FOnEnemyAttackCompleted OnAttackCompleted;
@@ -164,6 +182,13 @@ public:
 	/** Called from a delegate when the attack montage ends */
 	void AttackMontageEnded(UAnimMontage* Montage, bool bInterrupted);
 
+protected:
+
+	/** Called from a delegate when the server hit timeline ends */
+	void AttackTimelineEnded(bool bInterrupted);
+
+public:
+
 	/** Returns the last recorded location we were attacked from */
 	const FVector& GetLastDangerLocation() const;
 
@@ -177,6 +202,9 @@ public:
 	/** Performs an attack's collision check */
 	virtual void DoAttackTrace(FName DamageSourceBone) override;
 
+	/** Applies damage to the actors hit by an attack */
+	virtual void ResolveAttackTrace(const TArray<FHitResult>& Hits) override;
+
 	/** Performs a combo attack's check to continue the string */
 	UFUNCTION(BlueprintCallable, Category="Attacker")
 	virtual void CheckCombo() override;
@@ -208,6 +236,14 @@ protected:
 	/** Removes this character from the level after it dies */
 	void RemoveFromLevel();
 
+public:
+
+	/** Brings a pooled enemy back to life at the provided transform */
+	void ResetForReuse(const FTransform& SpawnTransform);
+
+	/** Deactivates this enemy so it can be kept in the enemy pool */
+	void DeactivateForPool();
+
 public:
 
 	/** Overrides the default TakeDamage functionality */
@@ -229,4 +265,9 @@ protected:
 
 	/** EndPlay cleanup */
 	virtual void EndPlay(EEndPlayReason::Type EndPlayReason) override;
+
+public:
+
+	/** Only replicates to players in this enemy's arena or one of its neighbors */
+	virtual bool IsNetRelevantFor(const AActor* RealViewer, const AActor* ViewTarget, const FVector& SrcLocation) const override;
 };
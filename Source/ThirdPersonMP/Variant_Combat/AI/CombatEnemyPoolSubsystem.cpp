@@ -0,0 +1,137 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "CombatEnemyPoolSubsystem.h"
+#include "CombatEnemy.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "ThirdPersonMP.h"
+
+namespace CombatEnemyPool
+{
+	static bool bEnabled = true;
+	static FAutoConsoleVariableRef CVarEnabled(
+		TEXT("TPS.Combat.EnemyPool"),
+		bEnabled,
+		TEXT("If true, dead combat enemies are returned to a pool and reused by spawners instead of being destroyed."));
+
+	static int32 MaxPooledPerClass = 32;
+	static FAutoConsoleVariableRef CVarMaxPooledPerClass(
+		TEXT("TPS.Combat.EnemyPoolMaxSize"),
+		MaxPooledPerClass,
+		TEXT("Maximum number of inactive enemies kept per enemy class. Extra enemies are destroyed."));
+
+	static FAutoConsoleCommandWithWorld DumpCommand(
+		TEXT("TPS.Combat.DumpEnemyPool"),
+		TEXT("Logs the contents and usage of the combat enemy pool."),
+		FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+		{
+			if (UCombatEnemyPoolSubsystem* Pool = UCombatEnemyPoolSubsystem::Get(World))
+			{
+				Pool->DumpToLog();
+			}
+		}));
+}
+
+UCombatEnemyPoolSubsystem* UCombatEnemyPoolSubsystem::Get(const UWorld* World)
+{
+	return World ? World->GetSubsystem<UCombatEnemyPoolSubsystem>() : nullptr;
+}
+
+ACombatEnemy* UCombatEnemyPoolSubsystem::AcquireEnemy(TSubclassOf<ACombatEnemy> EnemyClass, const FTransform& SpawnTransform)
+{
+	if (!IsValid(EnemyClass))
+	{
+		return nullptr;
+	}
+
+	// try to reuse a pooled enemy first
+	if (ACombatEnemy* Enemy = TryReuseEnemy(EnemyClass, SpawnTransform))
+	{
+		return Enemy;
+	}
+
+	// the pool is empty, so spawn a new enemy
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+	ACombatEnemy* Enemy = GetWorld()->SpawnActor<ACombatEnemy>(EnemyClass, SpawnTransform, SpawnParams);
+
+	if (Enemy)
+	{
+		++NumSpawned;
+	}
+
+	return Enemy;
+}
+
+ACombatEnemy* UCombatEnemyPoolSubsystem::TryReuseEnemy(TSubclassOf<ACombatEnemy> EnemyClass, const FTransform& SpawnTransform)
+{
+	if (FCombatEnemyPoolList* Pool = Pools.Find(EnemyClass))
+	{
+		while (!Pool->Enemies.IsEmpty())
+		{
+			ACombatEnemy* Enemy = Pool->Enemies.Pop(EAllowShrinking::No);
+
+			// skip any enemies that were destroyed while pooled, e.g. by a level reset
+			if (IsValid(Enemy))
+			{
+				Enemy->ResetForReuse(SpawnTransform);
+
+				++NumReused;
+				return Enemy;
+			}
+		}
+	}
+
+	return nullptr;
+}
+
+void UCombatEnemyPoolSubsystem::ReleaseEnemy(ACombatEnemy* Enemy)
+{
+	if (!IsValid(Enemy))
+	{
+		return;
+	}
+
+	FCombatEnemyPoolList& Pool = Pools.FindOrAdd(Enemy->GetClass());
+
+	// destroy the enemy if we can't pool it
+	if (!CombatEnemyPool::bEnabled || Pool.Enemies.Num() >= CombatEnemyPool::MaxPooledPerClass)
+	{
+		Enemy->Destroy();
+		return;
+	}
+
+	Enemy->DeactivateForPool();
+	Pool.Enemies.Add(Enemy);
+}
+
+int32 UCombatEnemyPoolSubsystem::GetNumPooled(TSubclassOf<ACombatEnemy> EnemyClass) const
+{
+	const FCombatEnemyPoolList* Pool = Pools.Find(EnemyClass);
+
+	return Pool ? Pool->Enemies.Num() : 0;
+}
+
+void UCombatEnemyPoolSubsystem::DumpToLog() const
+{
+	UE_LOG(LogThirdPersonMP, Log, TEXT("Combat enemy pool: %d spawned, %d reused"), NumSpawned, NumReused);
+
+	for (const TPair<TSubclassOf<ACombatEnemy>, FCombatEnemyPoolList>& Pool : Pools)
+	{
+		UE_LOG(LogThirdPersonMP, Log, TEXT("  %s: %d pooled"), *GetNameSafe(Pool.Key), Pool.Value.Enemies.Num());
+	}
+}
+
+bool UCombatEnemyPoolSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UCombatEnemyPoolSubsystem::Deinitialize()
+{
+	Pools.Reset();
+
+	Super::Deinitialize();
+}
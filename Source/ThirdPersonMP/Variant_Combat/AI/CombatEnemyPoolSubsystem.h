@@ -0,0 +1,74 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CombatEnemyPoolSubsystem.generated.h"
+
+class ACombatEnemy;
+
+/**
+ *  Inactive enemies of a single class, waiting to be reused
+ */
+USTRUCT()
+struct FCombatEnemyPoolList
+{
+	GENERATED_BODY()
+
+	/** Pooled enemies */
+	UPROPERTY()
+	TArray<TObjectPtr<ACombatEnemy>> Enemies;
+};
+
+/**
+ *  Shared pool of combat enemies.
+ *  Dead enemies are deactivated and kept around instead of being destroyed, so spawners can reuse them
+ *  along with their AI Controller, StateTree component and life bar widget instead of spawning new ones.
+ */
+UCLASS()
+class UCombatEnemyPoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+	/** Inactive enemies, per class */
+	UPROPERTY()
+	TMap<TSubclassOf<ACombatEnemy>, FCombatEnemyPoolList> Pools;
+
+	/** Number of enemies spawned because the pool was empty */
+	int32 NumSpawned = 0;
+
+	/** Number of enemies reused from the pool */
+	int32 NumReused = 0;
+
+public:
+
+	/** Returns the subsystem for the provided world, if any */
+	static UCombatEnemyPoolSubsystem* Get(const UWorld* World);
+
+	/** Returns an active enemy of the given class at the provided transform, reusing a pooled one if possible */
+	ACombatEnemy* AcquireEnemy(TSubclassOf<ACombatEnemy> EnemyClass, const FTransform& SpawnTransform);
+
+	/** Reactivates a pooled enemy of the given class at the provided transform. Returns nullptr if none are pooled */
+	ACombatEnemy* TryReuseEnemy(TSubclassOf<ACombatEnemy> EnemyClass, const FTransform& SpawnTransform);
+
+	/** Records that an enemy was spawned outside of AcquireEnemy because the pool was empty */
+	void NotifyEnemySpawned() { ++NumSpawned; }
+
+	/** Deactivates an enemy and returns it to the pool. Destroys it instead if pooling is disabled or the pool is full */
+	void ReleaseEnemy(ACombatEnemy* Enemy);
+
+	/** Returns the number of inactive enemies of the given class */
+	int32 GetNumPooled(TSubclassOf<ACombatEnemy> EnemyClass) const;
+
+	/** Logs the pool contents and usage */
+	void DumpToLog() const;
+
+protected:
+
+	/** Only create this subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Cleanup */
+	virtual void Deinitialize() override;
+};
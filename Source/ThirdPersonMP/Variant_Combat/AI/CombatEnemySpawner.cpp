@@ -8,6 +8,8 @@
 #include "Components/ArrowComponent.h"
 #include "TimerManager.h"
 #include "CombatEnemy.h"
+#include "CombatEnemyPoolSubsystem.h"
+#include "CombatSpawnDirectorSubsystem.h"
 
 ACombatEnemySpawner::ACombatEnemySpawner()
 {
@@ -47,6 +49,12 @@ void ACombatEnemySpawner::EndPlay(EEndPlayReason::Type EndPlayReason)
 
 	// clear the spawn timer
 	GetWorld()->GetTimerManager().ClearTimer(SpawnTimer);
+
+	// drop any spawns we still have queued
+	if (UCombatSpawnDirectorSubsystem* SpawnDirector = UCombatSpawnDirectorSubsystem::Get(GetWorld()))
+	{
+		SpawnDirector->CancelRequests(this);
+	}
 }
 
 void ACombatEnemySpawner::SpawnEnemy()
@@ -54,21 +62,31 @@ void ACombatEnemySpawner::SpawnEnemy()
 	// ensure the enemy class is valid
 	if (IsValid(EnemyClass))
 	{
-		// spawn the enemy at the reference capsule's transform
-		FActorSpawnParameters SpawnParams;
-		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
-
-		ACombatEnemy* SpawnedEnemy = GetWorld()->SpawnActor<ACombatEnemy>(EnemyClass, SpawnCapsule->GetComponentTransform(), SpawnParams);
+		// queue the spawn at the reference capsule's transform so it's spread out with other spawners
+		if (UCombatSpawnDirectorSubsystem* SpawnDirector = UCombatSpawnDirectorSubsystem::Get(GetWorld()))
+		{
+			SpawnDirector->RequestSpawn(this, EnemyClass, SpawnCapsule->GetComponentTransform(), SpawnPriority, FOnCombatEnemySpawned::CreateUObject(this, &ACombatEnemySpawner::OnEnemySpawned));
+			return;
+		}
 
-		// was the enemy successfully created?
-		if (SpawnedEnemy)
+		// no spawn director, so get an enemy from the shared pool right away
+		if (UCombatEnemyPoolSubsystem* Pool = UCombatEnemyPoolSubsystem::Get(GetWorld()))
 		{
-			// subscribe to the death delegate
-			SpawnedEnemy->OnEnemyDied.AddDynamic(this, &ACombatEnemySpawner::OnEnemyDied);
+			OnEnemySpawned(Pool->AcquireEnemy(EnemyClass, SpawnCapsule->GetComponentTransform()));
 		}
 	}
 }
 
+void ACombatEnemySpawner::OnEnemySpawned(ACombatEnemy* SpawnedEnemy)
+{
+	// was the enemy successfully created?
+	if (SpawnedEnemy)
+	{
+		// subscribe to the death delegate
+		SpawnedEnemy->OnEnemyDied.AddDynamic(this, &ACombatEnemySpawner::OnEnemyDied);
+	}
+}
+
 void ACombatEnemySpawner::OnEnemyDied()
 {
 	// decrease the spawn counter
@@ -46,6 +46,10 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Enemy Spawner", meta = (ClampMin = 0, ClampMax = 100))
 	int32 SpawnCount = 1;
 
+	/** Priority of this spawner's requests in the spawn director queue. Higher priority spawns are processed first */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Enemy Spawner")
+	int32 SpawnPriority = 0;
+
 	/** Time to wait before spawning the next enemy after the current one dies */
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Enemy Spawner", meta = (ClampMin = 0, ClampMax = 10))
 	float RespawnDelay = 5.0f;
@@ -79,9 +83,12 @@ public:
 
 protected:
 
-	/** Spawn an enemy and subscribe to its death event */
+	/** Queue an enemy spawn with the spawn director */
 	void SpawnEnemy();
 
+	/** Called when a queued enemy has been spawned. Subscribes to its death event */
+	void OnEnemySpawned(ACombatEnemy* SpawnedEnemy);
+
 	/** Called when the spawned enemy has died */
 	UFUNCTION()
 	void OnEnemyDied();
@@ -0,0 +1,198 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "CombatSpawnDirectorSubsystem.h"
+#include "CombatEnemy.h"
+#include "CombatEnemyPoolSubsystem.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "ThirdPersonMP.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Spawn Queue Depth"), STAT_CombatSpawnQueueDepth, STATGROUP_ThirdPersonMP);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Spawns This Frame"), STAT_CombatSpawnsThisFrame, STATGROUP_ThirdPersonMP);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Spawn Budget Overruns"), STAT_CombatSpawnBudgetOverruns, STATGROUP_ThirdPersonMP);
+DECLARE_CYCLE_STAT(TEXT("Spawn Director Tick"), STAT_CombatSpawnDirectorTick, STATGROUP_ThirdPersonMP);
+
+namespace CombatSpawnDirector
+{
+	static float BudgetMs = 1.0f;
+	static FAutoConsoleVariableRef CVarBudgetMs(
+		TEXT("TPS.Combat.SpawnBudgetMs"),
+		BudgetMs,
+		TEXT("Time budget for processing queued enemy spawns each frame, in milliseconds. At least one spawn is always processed."));
+
+	static int32 MaxSpawnsPerFrame = 2;
+	static FAutoConsoleVariableRef CVarMaxSpawnsPerFrame(
+		TEXT("TPS.Combat.MaxSpawnsPerFrame"),
+		MaxSpawnsPerFrame,
+		TEXT("Maximum number of queued enemy spawns started each frame."));
+}
+
+UCombatSpawnDirectorSubsystem* UCombatSpawnDirectorSubsystem::Get(const UWorld* World)
+{
+	return World ? World->GetSubsystem<UCombatSpawnDirectorSubsystem>() : nullptr;
+}
+
+void UCombatSpawnDirectorSubsystem::RequestSpawn(const UObject* Requester, TSubclassOf<ACombatEnemy> EnemyClass, const FTransform& SpawnTransform, int32 Priority, FOnCombatEnemySpawned OnSpawned)
+{
+	if (!IsValid(EnemyClass))
+	{
+		return;
+	}
+
+	FCombatSpawnRequest Request;
+	Request.Requester = Requester;
+	Request.EnemyClass = EnemyClass;
+	Request.SpawnTransform = SpawnTransform;
+	Request.Priority = Priority;
+	Request.Sequence = NextSequence++;
+	Request.OnSpawned = MoveTemp(OnSpawned);
+
+	Queue.HeapPush(MoveTemp(Request), &UCombatSpawnDirectorSubsystem::RequestPredicate);
+}
+
+void UCombatSpawnDirectorSubsystem::CancelRequests(const UObject* Requester)
+{
+	const int32 NumRemoved = Queue.RemoveAll([Requester](const FCombatSpawnRequest& Request) { return Request.Requester == Requester; });
+
+	// restore the heap ordering
+	if (NumRemoved > 0)
+	{
+		Queue.Heapify(&UCombatSpawnDirectorSubsystem::RequestPredicate);
+	}
+
+	// drop the enemies already constructed for this requester so they never finish spawning
+	DeferredSpawns.RemoveAll([Requester](const FDeferredSpawn& Deferred)
+	{
+		if (Deferred.Request.Requester != Requester)
+		{
+			return false;
+		}
+
+		if (ACombatEnemy* Enemy = Deferred.Enemy.Get())
+		{
+			Enemy->Destroy();
+		}
+
+		return true;
+	});
+}
+
+void UCombatSpawnDirectorSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	SCOPE_CYCLE_COUNTER(STAT_CombatSpawnDirectorTick);
+
+	const double StartTime = FPlatformTime::Seconds();
+	const double BudgetSeconds = CombatSpawnDirector::BudgetMs * 0.001;
+
+	int32 NumSpawns = 0;
+
+	// finish the enemies constructed last frame first so they don't wait behind new requests
+	TArray<FDeferredSpawn> ToFinish = MoveTemp(DeferredSpawns);
+	DeferredSpawns.Reset();
+
+	for (int32 i = 0; i < ToFinish.Num(); ++i)
+	{
+		// push the rest to the next frame if we're out of time. Always finish at least one so the queue can't stall
+		if (i > 0 && FPlatformTime::Seconds() - StartTime > BudgetSeconds)
+		{
+			DeferredSpawns.Append(&ToFinish[i], ToFinish.Num() - i);
+			break;
+		}
+
+		FDeferredSpawn& Deferred = ToFinish[i];
+
+		if (ACombatEnemy* Enemy = Deferred.Enemy.Get())
+		{
+			Enemy->FinishSpawning(Deferred.Request.SpawnTransform);
+
+			if (UCombatEnemyPoolSubsystem* Pool = UCombatEnemyPoolSubsystem::Get(GetWorld()))
+			{
+				Pool->NotifyEnemySpawned();
+			}
+
+			Deferred.Request.OnSpawned.ExecuteIfBound(Enemy);
+			++NumSpawns;
+		}
+	}
+
+	// start new spawns while we have budget
+	while (!Queue.IsEmpty() && NumSpawns < CombatSpawnDirector::MaxSpawnsPerFrame)
+	{
+		if (NumSpawns > 0 && FPlatformTime::Seconds() - StartTime > BudgetSeconds)
+		{
+			break;
+		}
+
+		FCombatSpawnRequest Request;
+		Queue.HeapPop(Request, &UCombatSpawnDirectorSubsystem::RequestPredicate, EAllowShrinking::No);
+
+		// skip requests whose requester went away
+		if (!Request.Requester.IsValid())
+		{
+			continue;
+		}
+
+		ProcessRequest(Request);
+		++NumSpawns;
+	}
+
+	// record overruns. A single spawn that goes over the budget still counts
+	if (NumSpawns > 0 && FPlatformTime::Seconds() - StartTime > BudgetSeconds)
+	{
+		++NumBudgetOverruns;
+		INC_DWORD_STAT(STAT_CombatSpawnBudgetOverruns);
+	}
+
+	SET_DWORD_STAT(STAT_CombatSpawnQueueDepth, GetQueueDepth());
+	SET_DWORD_STAT(STAT_CombatSpawnsThisFrame, NumSpawns);
+}
+
+TStatId UCombatSpawnDirectorSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCombatSpawnDirectorSubsystem, STATGROUP_Tickables);
+}
+
+bool UCombatSpawnDirectorSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UCombatSpawnDirectorSubsystem::Deinitialize()
+{
+	Queue.Reset();
+	DeferredSpawns.Reset();
+
+	Super::Deinitialize();
+}
+
+void UCombatSpawnDirectorSubsystem::ProcessRequest(FCombatSpawnRequest& Request)
+{
+	// reusing a pooled enemy is cheap, so complete it right away
+	if (UCombatEnemyPoolSubsystem* Pool = UCombatEnemyPoolSubsystem::Get(GetWorld()))
+	{
+		if (ACombatEnemy* Enemy = Pool->TryReuseEnemy(Request.EnemyClass, Request.SpawnTransform))
+		{
+			Request.OnSpawned.ExecuteIfBound(Enemy);
+			return;
+		}
+	}
+
+	// construct the enemy now and finish spawning it next frame
+	ACombatEnemy* Enemy = GetWorld()->SpawnActorDeferred<ACombatEnemy>(Request.EnemyClass, Request.SpawnTransform, nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn);
+
+	if (Enemy)
+	{
+		FDeferredSpawn& Deferred = DeferredSpawns.AddDefaulted_GetRef();
+		Deferred.Request = MoveTemp(Request);
+		Deferred.Enemy = Enemy;
+	}
+}
+
+bool UCombatSpawnDirectorSubsystem::RequestPredicate(const FCombatSpawnRequest& A, const FCombatSpawnRequest& B)
+{
+	// higher priority first, then oldest first
+	return A.Priority != B.Priority ? A.Priority > B.Priority : A.Sequence < B.Sequence;
+}
@@ -0,0 +1,108 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CombatSpawnDirectorSubsystem.generated.h"
+
+class ACombatEnemy;
+
+/** Called once a queued enemy has been spawned or reused */
+DECLARE_DELEGATE_OneParam(FOnCombatEnemySpawned, ACombatEnemy*);
+
+/**
+ *  A queued enemy spawn
+ */
+struct FCombatSpawnRequest
+{
+	/** Object that requested the spawn, so its requests can be cancelled */
+	TWeakObjectPtr<const UObject> Requester;
+
+	/** Type of enemy to spawn */
+	TSubclassOf<ACombatEnemy> EnemyClass;
+
+	/** Spawn transform */
+	FTransform SpawnTransform;
+
+	/** Higher priority requests are processed first */
+	int32 Priority = 0;
+
+	/** Submission order, used to keep requests of the same priority first in, first out */
+	uint64 Sequence = 0;
+
+	/** Called with the spawned enemy */
+	FOnCombatEnemySpawned OnSpawned;
+};
+
+/**
+ *  Owns a prioritized queue of enemy spawns and processes it within a per-frame time budget and spawn cap,
+ *  so spawners firing on the same frame don't hitch the game.
+ *  Pooled enemies are reused when available. Otherwise, new enemies are spawned deferred on one frame
+ *  and finished on the next, spreading construction and AI startup across frames.
+ */
+UCLASS()
+class UCombatSpawnDirectorSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+	/** An enemy that has been constructed but not finished spawning yet */
+	struct FDeferredSpawn
+	{
+		/** Originating request */
+		FCombatSpawnRequest Request;
+
+		/** Enemy awaiting FinishSpawning */
+		TWeakObjectPtr<ACombatEnemy> Enemy;
+	};
+
+	/** Pending requests, kept as a heap */
+	TArray<FCombatSpawnRequest> Queue;
+
+	/** Enemies spawned deferred on a previous frame */
+	TArray<FDeferredSpawn> DeferredSpawns;
+
+	/** Sequence number for the next request */
+	uint64 NextSequence = 0;
+
+	/** Number of frames where spawning went over the time budget */
+	int32 NumBudgetOverruns = 0;
+
+public:
+
+	/** Returns the subsystem for the provided world, if any */
+	static UCombatSpawnDirectorSubsystem* Get(const UWorld* World);
+
+	/** Queues an enemy spawn */
+	void RequestSpawn(const UObject* Requester, TSubclassOf<ACombatEnemy> EnemyClass, const FTransform& SpawnTransform, int32 Priority, FOnCombatEnemySpawned OnSpawned);
+
+	/** Cancels all queued spawns from the provided requester, destroying any of its enemies that haven't finished spawning */
+	void CancelRequests(const UObject* Requester);
+
+	/** Returns the number of spawns waiting to be processed */
+	int32 GetQueueDepth() const { return Queue.Num() + DeferredSpawns.Num(); }
+
+	/** Returns the number of frames where spawning went over budget */
+	int32 GetNumBudgetOverruns() const { return NumBudgetOverruns; }
+
+public:
+
+	// ~begin FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	// ~end FTickableGameObject interface
+
+protected:
+
+	/** Only create this subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Cleanup */
+	virtual void Deinitialize() override;
+
+	/** Starts processing a single request, either reusing a pooled enemy or beginning a deferred spawn */
+	void ProcessRequest(FCombatSpawnRequest& Request);
+
+	/** Heap ordering for requests */
+	static bool RequestPredicate(const FCombatSpawnRequest& A, const FCombatSpawnRequest& B);
+};
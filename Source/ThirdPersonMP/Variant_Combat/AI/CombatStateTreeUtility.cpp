@@ -9,8 +9,9 @@
 #include "GameFramework/CharacterMovementComponent.h"
 #include "AIController.h"
 #include "CombatEnemy.h"
-#include "Kismet/GameplayStatics.h"
+#include "TPSPlayerCacheSubsystem.h"
 #include "StateTreeAsyncExecutionContext.h"
+#include "ThirdPersonMPStats.h"
 
 bool FStateTreeCharacterGroundedCondition::TestCondition(FStateTreeExecutionContext& Context) const
 {
@@ -298,11 +299,18 @@ FText FStateTreeSetCharacterSpeedTask::GetDescription(const FGuid& ID, FStateTre
 
 EStateTreeRunStatus FStateTreeGetPlayerInfoTask::Tick(FStateTreeExecutionContext& Context, const float DeltaTime) const
 {
+	TPS_SCOPED_TIMER(StateTreeTaskTick, TPSAI);
+
 	// get the instance data
 	FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
 
-	// get the character possessed by the first local player
-	InstanceData.TargetPlayerCharacter = Cast<ACharacter>(UGameplayStatics::GetPlayerPawn(InstanceData.Character, 0));
+	// get the character possessed by the nearest player
+	InstanceData.TargetPlayerCharacter = nullptr;
+
+	if (UTPSPlayerCacheSubsystem* PlayerCache = UTPSPlayerCacheSubsystem::Get(InstanceData.Character->GetWorld()))
+	{
+		InstanceData.TargetPlayerCharacter = Cast<ACharacter>(PlayerCache->FindNearestPlayerPawn(InstanceData.Character->GetActorLocation()));
+	}
 
 	// do we have a valid target?
 	if (InstanceData.TargetPlayerCharacter)
@@ -2,17 +2,28 @@
 
 
 #include "EnvQueryContext_Player.h"
-#include "Kismet/GameplayStatics.h"
+#include "TPSPlayerCacheSubsystem.h"
 #include "EnvironmentQuery/EnvQueryTypes.h"
 #include "EnvironmentQuery/Items/EnvQueryItemType_Actor.h"
 #include "GameFramework/Pawn.h"
 
 void UEnvQueryContext_Player::ProvideContext(FEnvQueryInstance& QueryInstance, FEnvQueryContextData& ContextData) const
 {
-	// get the player pawn for the first local player
-	AActor* PlayerPawn = UGameplayStatics::GetPlayerPawn(QueryInstance.Owner.Get(), 0);
-	check(PlayerPawn);
+	// get the querier
+	const AActor* QuerierActor = Cast<AActor>(QueryInstance.Owner.Get());
 
-	// add the actor data to the context
-	UEnvQueryItemType_Actor::SetContextHelper(ContextData, PlayerPawn);
+	if (!QuerierActor)
+	{
+		return;
+	}
+
+	// get the player pawn closest to the querier
+	if (UTPSPlayerCacheSubsystem* PlayerCache = UTPSPlayerCacheSubsystem::Get(QuerierActor->GetWorld()))
+	{
+		if (APawn* PlayerPawn = PlayerCache->FindNearestPlayerPawn(QuerierActor->GetActorLocation()))
+		{
+			// add the actor data to the context
+			UEnvQueryItemType_Actor::SetContextHelper(ContextData, PlayerPawn);
+		}
+	}
 }
@@ -3,10 +3,17 @@
 
 #include "AnimNotify_DoAttackTrace.h"
 #include "CombatAttacker.h"
+#include "CombatHitTimelineComponent.h"
 #include "Components/SkeletalMeshComponent.h"
 
 void UAnimNotify_DoAttackTrace::Notify(USkeletalMeshComponent* MeshComp, UAnimSequenceBase* Animation, const FAnimNotifyEventReference& EventReference)
 {
+	// the server hit timeline fires this event instead while it's driving the attack
+	if (UCombatHitTimelineComponent::IsDrivingOwner(MeshComp->GetOwner()))
+	{
+		return;
+	}
+
 	// cast the owner to the attacker interface
 	if (ICombatAttacker* AttackerInterface = Cast<ICombatAttacker>(MeshComp->GetOwner()))
 	{
@@ -0,0 +1,181 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "CombatAttackTimeline.h"
+#include "Animation/AnimMontage.h"
+#include "AnimNotify_DoAttackTrace.h"
+#include "AnimNotify_CheckCombo.h"
+#include "AnimNotify_CheckChargedAttack.h"
+#include "UObject/ObjectSaveContext.h"
+
+#if WITH_EDITOR
+#include "Animation/AnimSequence.h"
+#include "Animation/Skeleton.h"
+#include "Engine/SkeletalMesh.h"
+#include "Engine/SkeletalMeshSocket.h"
+#endif
+
+const FCombatTimelineSection* UCombatAttackTimeline::FindSection(FName SectionName) const
+{
+	if (SectionName.IsNone())
+	{
+		return Sections.IsEmpty() ? nullptr : &Sections[0];
+	}
+
+	return Sections.FindByPredicate([SectionName](const FCombatTimelineSection& Section) { return Section.SectionName == SectionName; });
+}
+
+#if WITH_EDITOR
+
+namespace CombatAttackTimeline
+{
+	/** Samples the mesh component space transform of a bone or socket at a montage position, from the animation in the first slot track */
+	static bool SampleComponentSpaceTransform(const UAnimMontage* Montage, FName BoneName, float Position, FTransform& OutTransform)
+	{
+		const USkeleton* Skeleton = Montage->GetSkeleton();
+
+		if (!Skeleton || Montage->SlotAnimTracks.IsEmpty())
+		{
+			return false;
+		}
+
+		// resolve sockets to their parent bone. Sockets may live on the skeleton or on the preview mesh
+		const USkeletalMeshSocket* Socket = Skeleton->FindSocket(BoneName);
+
+		if (!Socket && Montage->GetPreviewMesh())
+		{
+			Socket = Montage->GetPreviewMesh()->FindSocket(BoneName);
+		}
+
+		OutTransform = FTransform::Identity;
+
+		if (Socket)
+		{
+			OutTransform = Socket->GetSocketLocalTransform();
+			BoneName = Socket->BoneName;
+		}
+
+		const FReferenceSkeleton& RefSkeleton = Skeleton->GetReferenceSkeleton();
+		int32 BoneIndex = RefSkeleton.FindBoneIndex(BoneName);
+
+		if (BoneIndex == INDEX_NONE)
+		{
+			return false;
+		}
+
+		// find the animation playing at that position
+		const FAnimSegment* Segment = Montage->SlotAnimTracks[0].AnimTrack.GetSegmentAtTime(Position);
+		const UAnimSequence* Sequence = Segment ? Cast<UAnimSequence>(Segment->GetAnimReference()) : nullptr;
+
+		if (!Sequence || !Sequence->GetDataModelInterface())
+		{
+			return false;
+		}
+
+		const FAnimExtractContext ExtractContext(static_cast<double>(Segment->ConvertTrackPosToAnimPos(Position)));
+
+		// accumulate the local transforms up to the root. Bones without a track hold their reference pose
+		for (; BoneIndex != INDEX_NONE; BoneIndex = RefSkeleton.GetParentIndex(BoneIndex))
+		{
+			FTransform LocalTransform = RefSkeleton.GetRefBonePose()[BoneIndex];
+
+			if (Sequence->GetDataModelInterface()->IsValidBoneTrackName(RefSkeleton.GetBoneName(BoneIndex)))
+			{
+				Sequence->GetBoneTransform(LocalTransform, FSkeletonPoseBoneIndex(BoneIndex), ExtractContext, true);
+			}
+
+			OutTransform = OutTransform * LocalTransform;
+		}
+
+		return true;
+	}
+}
+
+void UCombatAttackTimeline::ExtractFromMontage()
+{
+	UAnimMontage* Montage = SourceMontage.LoadSynchronous();
+
+	if (!Montage)
+	{
+		return;
+	}
+
+	Modify();
+
+	RateScale = Montage->RateScale;
+	Sections.Reset();
+
+	// copy the sections and their links
+	for (int32 SectionIndex = 0; SectionIndex < Montage->CompositeSections.Num(); ++SectionIndex)
+	{
+		const FCompositeSection& CompositeSection = Montage->CompositeSections[SectionIndex];
+
+		FCombatTimelineSection& Section = Sections.AddDefaulted_GetRef();
+		Section.SectionName = CompositeSection.SectionName;
+		Section.Length = Montage->GetSectionLength(SectionIndex);
+		Section.NextSectionName = CompositeSection.NextSectionName;
+	}
+
+	// sort the attack notifies into their sections
+	for (const FAnimNotifyEvent& NotifyEvent : Montage->Notifies)
+	{
+		const float NotifyTime = NotifyEvent.GetTriggerTime();
+		const int32 SectionIndex = Montage->GetSectionIndexFromPosition(NotifyTime);
+
+		if (!Sections.IsValidIndex(SectionIndex))
+		{
+			continue;
+		}
+
+		FCombatTimelineEvent Event;
+		Event.Time = NotifyTime - Montage->CompositeSections[SectionIndex].GetTime();
+
+		if (const UAnimNotify_DoAttackTrace* AttackTrace = Cast<UAnimNotify_DoAttackTrace>(NotifyEvent.Notify))
+		{
+			Event.Type = ECombatTimelineEventType::AttackTrace;
+			Event.BoneName = AttackTrace->GetAttackBoneName();
+
+			// bake the source bone's pose so the server doesn't need to evaluate animation to sweep from it
+			FTransform SourceTransform;
+
+			if (CombatAttackTimeline::SampleComponentSpaceTransform(Montage, Event.BoneName, NotifyTime, SourceTransform))
+			{
+				Event.SourceOffset = SourceTransform.GetLocation();
+				Event.bHasSourceOffset = true;
+			}
+		}
+		else if (Cast<UAnimNotify_CheckCombo>(NotifyEvent.Notify))
+		{
+			Event.Type = ECombatTimelineEventType::CheckCombo;
+		}
+		else if (Cast<UAnimNotify_CheckChargedAttack>(NotifyEvent.Notify))
+		{
+			Event.Type = ECombatTimelineEventType::CheckChargedAttack;
+		}
+		else
+		{
+			// not an attack notify
+			continue;
+		}
+
+		Sections[SectionIndex].Events.Add(Event);
+	}
+
+	for (FCombatTimelineSection& Section : Sections)
+	{
+		Section.Events.StableSort([](const FCombatTimelineEvent& A, const FCombatTimelineEvent& B) { return A.Time < B.Time; });
+	}
+}
+
+void UCombatAttackTimeline::PreSave(FObjectPreSaveContext SaveContext)
+{
+	Super::PreSave(SaveContext);
+
+	// refresh the timeline so it never goes stale relative to the montage
+	if (!SourceMontage.IsNull())
+	{
+		ExtractFromMontage();
+	}
+}
+
+#endif // WITH_EDITOR
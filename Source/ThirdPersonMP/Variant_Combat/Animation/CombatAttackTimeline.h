@@ -0,0 +1,120 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "CombatAttackTimeline.generated.h"
+
+class UAnimMontage;
+
+/**
+ *  Types of attack events that can be scheduled on a timeline
+ */
+UENUM(BlueprintType)
+enum class ECombatTimelineEventType : uint8
+{
+	AttackTrace,
+	CheckCombo,
+	CheckChargedAttack
+};
+
+/**
+ *  A single attack event, timed relative to the start of its section
+ */
+USTRUCT(BlueprintType)
+struct FCombatTimelineEvent
+{
+	GENERATED_BODY()
+
+	/** Time from the start of the section, in seconds at a play rate of 1 */
+	UPROPERTY(VisibleAnywhere, Category="Timeline")
+	float Time = 0.0f;
+
+	/** Event to fire */
+	UPROPERTY(VisibleAnywhere, Category="Timeline")
+	ECombatTimelineEventType Type = ECombatTimelineEventType::AttackTrace;
+
+	/** Source bone for attack traces */
+	UPROPERTY(VisibleAnywhere, Category="Timeline")
+	FName BoneName;
+
+	/** Location of the source bone in mesh component space, sampled from the montage pose at the event time */
+	UPROPERTY(VisibleAnywhere, Category="Timeline")
+	FVector SourceOffset = FVector::ZeroVector;
+
+	/** True if the source offset could be sampled from the montage */
+	UPROPERTY(VisibleAnywhere, Category="Timeline")
+	bool bHasSourceOffset = false;
+};
+
+/**
+ *  Attack events for a single montage section
+ */
+USTRUCT(BlueprintType)
+struct FCombatTimelineSection
+{
+	GENERATED_BODY()
+
+	/** Name of the montage section */
+	UPROPERTY(VisibleAnywhere, Category="Timeline")
+	FName SectionName;
+
+	/** Length of the section, in seconds at a play rate of 1 */
+	UPROPERTY(VisibleAnywhere, Category="Timeline")
+	float Length = 0.0f;
+
+	/** Section that plays after this one. None if the montage ends here */
+	UPROPERTY(VisibleAnywhere, Category="Timeline")
+	FName NextSectionName;
+
+	/** Events in this section, sorted by time */
+	UPROPERTY(VisibleAnywhere, Category="Timeline")
+	TArray<FCombatTimelineEvent> Events;
+};
+
+/**
+ *  Compact copy of the attack notify timings of an attack montage.
+ *  Lets the server schedule attack traces and combo checks without evaluating animation.
+ *  Attack traces also carry the source bone's pose at the time they fire, so they can be swept without an up to date pose.
+ *  The timeline is extracted from the source montage in the editor, and refreshed every time the asset is saved.
+ */
+UCLASS(BlueprintType)
+class UCombatAttackTimeline : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+
+#if WITH_EDITORONLY_DATA
+
+	/** Montage the timeline is extracted from */
+	UPROPERTY(EditAnywhere, Category="Timeline")
+	TSoftObjectPtr<UAnimMontage> SourceMontage;
+
+#endif // WITH_EDITORONLY_DATA
+
+	/** Rate scale of the source montage */
+	UPROPERTY(VisibleAnywhere, Category="Timeline")
+	float RateScale = 1.0f;
+
+	/** Extracted sections, in montage order */
+	UPROPERTY(VisibleAnywhere, Category="Timeline")
+	TArray<FCombatTimelineSection> Sections;
+
+public:
+
+	/** Returns the section with the given name, or the first section if the name is None */
+	const FCombatTimelineSection* FindSection(FName SectionName) const;
+
+#if WITH_EDITOR
+
+	/** Rebuilds the timeline from the source montage's notifies and sections */
+	UFUNCTION(CallInEditor, Category="Timeline")
+	void ExtractFromMontage();
+
+	/** Keeps the timeline in sync with the montage every time the asset is saved or cooked */
+	virtual void PreSave(FObjectPreSaveContext SaveContext) override;
+
+#endif // WITH_EDITOR
+};
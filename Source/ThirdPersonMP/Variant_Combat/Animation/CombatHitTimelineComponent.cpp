@@ -0,0 +1,187 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "CombatHitTimelineComponent.h"
+#include "CombatAttackTimeline.h"
+#include "CombatAttacker.h"
+#include "GameFramework/Actor.h"
+#include "HAL/IConsoleManager.h"
+
+namespace CombatHitTimeline
+{
+	static bool bEnabled = true;
+	static FAutoConsoleVariableRef CVarEnabled(
+		TEXT("TPS.Combat.ServerHitTimeline"),
+		bEnabled,
+		TEXT("If true, the server drives enemy attack traces from extracted hit timelines instead of montage notifies."));
+}
+
+UCombatHitTimelineComponent::UCombatHitTimelineComponent()
+{
+	// only tick while a timeline is playing
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+
+	// fire the events after the owner has moved for this frame
+	PrimaryComponentTick.TickGroup = TG_PostPhysics;
+}
+
+bool UCombatHitTimelineComponent::Play(const UCombatAttackTimeline* InTimeline, FName StartSection)
+{
+	// stop any previous timeline without notifying, the owner is starting a new attack
+	Timeline = nullptr;
+	++PlaybackSerial;
+	SetComponentTickEnabled(false);
+
+	// only the server drives attacks from the timeline
+	if (!CombatHitTimeline::bEnabled || !InTimeline || !GetOwner() || !GetOwner()->HasAuthority())
+	{
+		return false;
+	}
+
+	const FCombatTimelineSection* Section = InTimeline->FindSection(StartSection);
+
+	if (!Section)
+	{
+		return false;
+	}
+
+	Timeline = InTimeline;
+	SectionIndex = UE_PTRDIFF_TO_INT32(Section - InTimeline->Sections.GetData());
+	SectionTime = 0.0f;
+
+	SetComponentTickEnabled(true);
+
+	return true;
+}
+
+void UCombatHitTimelineComponent::JumpToSection(FName SectionName)
+{
+	if (!Timeline)
+	{
+		return;
+	}
+
+	const FCombatTimelineSection* Section = Timeline->FindSection(SectionName);
+
+	if (!Section)
+	{
+		return;
+	}
+
+	SectionIndex = UE_PTRDIFF_TO_INT32(Section - Timeline->Sections.GetData());
+	SectionTime = 0.0f;
+	++PlaybackSerial;
+}
+
+void UCombatHitTimelineComponent::Stop(bool bInterrupted)
+{
+	if (!Timeline)
+	{
+		return;
+	}
+
+	Timeline = nullptr;
+	SectionIndex = INDEX_NONE;
+	++PlaybackSerial;
+	SetComponentTickEnabled(false);
+
+	OnTimelineEnded.ExecuteIfBound(bInterrupted);
+}
+
+bool UCombatHitTimelineComponent::IsDrivingOwner(const AActor* Owner)
+{
+	const UCombatHitTimelineComponent* HitTimeline = Owner ? Owner->FindComponentByClass<UCombatHitTimelineComponent>() : nullptr;
+
+	return HitTimeline && HitTimeline->IsDriving();
+}
+
+void UCombatHitTimelineComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	float RemainingTime = DeltaTime * (Timeline ? Timeline->RateScale : 0.0f);
+
+	// consume the frame time, crossing into following sections as needed
+	while (Timeline && RemainingTime > 0.0f)
+	{
+		const FCombatTimelineSection& Section = Timeline->Sections[SectionIndex];
+
+		const float StartTime = SectionTime;
+		const float EndTime = FMath::Min(SectionTime + RemainingTime, Section.Length);
+
+		RemainingTime -= EndTime - StartTime;
+		SectionTime = EndTime;
+
+		// fire the events in [StartTime, EndTime). An event may jump or stop playback, so check the serial after each one
+		const uint32 Serial = PlaybackSerial;
+
+		for (const FCombatTimelineEvent& Event : Section.Events)
+		{
+			if (Event.Time >= StartTime && Event.Time < EndTime)
+			{
+				FireEvent(Event);
+
+				if (Serial != PlaybackSerial)
+				{
+					break;
+				}
+			}
+		}
+
+		// if playback jumped, continue from the new section with the remaining time
+		if (Serial != PlaybackSerial)
+		{
+			continue;
+		}
+
+		// have we reached the end of the section?
+		if (SectionTime >= Section.Length)
+		{
+			const FCombatTimelineSection* NextSection = Section.NextSectionName.IsNone() ? nullptr : Timeline->FindSection(Section.NextSectionName);
+
+			if (!NextSection)
+			{
+				Stop(false);
+				return;
+			}
+
+			SectionIndex = UE_PTRDIFF_TO_INT32(NextSection - Timeline->Sections.GetData());
+			SectionTime = 0.0f;
+
+			// guard against zero length section loops
+			if (NextSection->Length <= 0.0f)
+			{
+				break;
+			}
+		}
+	}
+}
+
+void UCombatHitTimelineComponent::FireEvent(const FCombatTimelineEvent& Event)
+{
+	ICombatAttacker* Attacker = Cast<ICombatAttacker>(GetOwner());
+
+	if (!Attacker)
+	{
+		return;
+	}
+
+	// let the owner look up the event's baked data while it handles it
+	TGuardValue<const FCombatTimelineEvent*> FiringEventGuard(FiringEvent, &Event);
+
+	switch (Event.Type)
+	{
+	case ECombatTimelineEventType::AttackTrace:
+		Attacker->DoAttackTrace(Event.BoneName);
+		break;
+
+	case ECombatTimelineEventType::CheckCombo:
+		Attacker->CheckCombo();
+		break;
+
+	case ECombatTimelineEventType::CheckChargedAttack:
+		Attacker->CheckChargedAttack();
+		break;
+	}
+}
@@ -0,0 +1,78 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "CombatHitTimelineComponent.generated.h"
+
+class UCombatAttackTimeline;
+struct FCombatTimelineSection;
+struct FCombatTimelineEvent;
+
+/** Hit timeline ended delegate */
+DECLARE_DELEGATE_OneParam(FOnHitTimelineEnded, bool /* bInterrupted */);
+
+/**
+ *  Plays back a combat attack timeline on the server, independently of animation evaluation.
+ *  Fires the owner's attack traces and combo checks at the times extracted from the attack montage,
+ *  so server hit timing holds even when the mesh isn't ticking its pose.
+ *  While the timeline is driving, the montage's own attack notifies are ignored.
+ */
+UCLASS(ClassGroup=(Combat), meta=(BlueprintSpawnableComponent))
+class UCombatHitTimelineComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+	/** Timeline currently playing */
+	UPROPERTY(Transient)
+	TObjectPtr<const UCombatAttackTimeline> Timeline;
+
+	/** Index of the section currently playing */
+	int32 SectionIndex = INDEX_NONE;
+
+	/** Playback position within the current section, in seconds at a play rate of 1 */
+	float SectionTime = 0.0f;
+
+	/** Incremented every time playback starts, jumps or stops, so event dispatch can tell if it was interrupted */
+	uint32 PlaybackSerial = 0;
+
+	/** Event currently being fired, if any */
+	const FCombatTimelineEvent* FiringEvent = nullptr;
+
+public:
+
+	/** Constructor */
+	UCombatHitTimelineComponent();
+
+	/** Called when playback reaches the end of the timeline, or is stopped */
+	FOnHitTimelineEnded OnTimelineEnded;
+
+	/** Starts playing a timeline from the provided section, or the first one if None. Returns true if the timeline will drive the attack */
+	bool Play(const UCombatAttackTimeline* InTimeline, FName StartSection = NAME_None);
+
+	/** Jumps to the start of the provided section of the current timeline */
+	void JumpToSection(FName SectionName);
+
+	/** Stops playback and calls the ended delegate */
+	void Stop(bool bInterrupted);
+
+	/** Returns true if a timeline is currently driving the owner's attack events */
+	bool IsDriving() const { return Timeline != nullptr; }
+
+	/** Returns the event currently being fired on the owner, or nullptr if the owner's attack call didn't come from the timeline */
+	const FCombatTimelineEvent* GetFiringEvent() const { return FiringEvent; }
+
+	/** Returns true if the actor owning the mesh is currently driven by a hit timeline */
+	static bool IsDrivingOwner(const AActor* Owner);
+
+public:
+
+	/** Advances playback and fires any events that were passed */
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+protected:
+
+	/** Fires a single timeline event on the owner */
+	void FireEvent(const FCombatTimelineEvent& Event);
+};
@@ -3,18 +3,35 @@
 
 #include "CombatCharacter.h"
 #include "Components/CapsuleComponent.h"
-#include "Components/WidgetComponent.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "GameFramework/SpringArmComponent.h"
 #include "Components/SkeletalMeshComponent.h"
 #include "Camera/CameraComponent.h"
 #include "EnhancedInputSubsystems.h"
 #include "EnhancedInputComponent.h"
-#include "CombatLifeBar.h"
+#include "CombatLifeBarSubsystem.h"
 #include "Engine/DamageEvents.h"
 #include "TimerManager.h"
 #include "Engine/LocalPlayer.h"
 #include "CombatPlayerController.h"
+#include "CombatMeleeQuerySubsystem.h"
+#include "CombatSpatialHashSubsystem.h"
+#include "CombatRagdollSubsystem.h"
+#include "CombatDamageSubsystem.h"
+#include "Animation/AnimInstance.h"
+#include "HAL/IConsoleManager.h"
+#include "Net/UnrealNetwork.h"
+#include "ThirdPersonMPStats.h"
+
+namespace CombatCharacter
+{
+	static bool bRespawnInPlace = true;
+	static FAutoConsoleVariableRef CVarRespawnInPlace(
+		TEXT("TPS.Combat.RespawnInPlace"),
+		bRespawnInPlace,
+		TEXT("If true, dead player characters are reset and teleported to their respawn point.\n")
+		TEXT("If false, they are destroyed and a new character is spawned by the Player Controller."));
+}
 
 ACombatCharacter::ACombatCharacter()
 {
@@ -43,10 +60,6 @@ ACombatCharacter::ACombatCharacter()
 	FollowCamera->SetupAttachment(CameraBoom, USpringArmComponent::SocketName);
 	FollowCamera->bUsePawnControlRotation = false;
 
-	// create the life bar widget component
-	LifeBar = CreateDefaultSubobject<UWidgetComponent>(TEXT("LifeBar"));
-	LifeBar->SetupAttachment(RootComponent);
-
 	// set the player tag
 	Tags.Add(FName("Player"));
 }
@@ -176,7 +189,10 @@ void ACombatCharacter::ResetHP()
 	CurrentHP = MaxHP;
 
 	// update the life bar
-	LifeBarWidget->SetLifePercentage(1.0f);
+	if (UCombatLifeBarSubsystem* LifeBars = UCombatLifeBarSubsystem::Get(GetWorld()))
+	{
+		LifeBars->SetPercentage(this, 1.0f);
+	}
 }
 
 void ACombatCharacter::ComboAttack()
@@ -254,45 +270,49 @@ void ACombatCharacter::AttackMontageEnded(UAnimMontage* Montage, bool bInterrupt
 
 void ACombatCharacter::DoAttackTrace(FName DamageSourceBone)
 {
+	TPS_SCOPED_TIMER(AttackTrace, TPSCombat);
+	INC_DWORD_STAT(STAT_TPSAttackTraces);
+
 	// sweep for objects in front of the character to be hit by the attack
-	TArray<FHitResult> OutHits;
+	FCombatMeleeQuery Query;
+	Query.Attacker = this;
 
 	// start at the provided socket location, sweep forward
-	const FVector TraceStart = GetMesh()->GetSocketLocation(DamageSourceBone);
-	const FVector TraceEnd = TraceStart + (GetActorForwardVector() * MeleeTraceDistance);
-
-	// check for pawn and world dynamic collision object types
-	FCollisionObjectQueryParams ObjectParams;
-	ObjectParams.AddObjectTypesToQuery(ECC_Pawn);
-	ObjectParams.AddObjectTypesToQuery(ECC_WorldDynamic);
+	Query.Start = GetMesh()->GetSocketLocation(DamageSourceBone);
+	Query.End = Query.Start + (GetActorForwardVector() * MeleeTraceDistance);
 
 	// use a sphere shape for the sweep
-	FCollisionShape CollisionShape;
-	CollisionShape.SetSphere(MeleeTraceRadius);
+	Query.Radius = MeleeTraceRadius;
 
-	// ignore self
-	FCollisionQueryParams QueryParams;
-	QueryParams.AddIgnoredActor(this);
+	// check for pawn and world dynamic collision object types
+	Query.ObjectParams.AddObjectTypesToQuery(ECC_Pawn);
+	Query.ObjectParams.AddObjectTypesToQuery(ECC_WorldDynamic);
 
-	if (GetWorld()->SweepMultiByObjectType(OutHits, TraceStart, TraceEnd, FQuat::Identity, ObjectParams, CollisionShape, QueryParams))
+	// hand the sweep over to the melee query batch. Results come back through ResolveAttackTrace
+	if (UCombatMeleeQuerySubsystem* MeleeQueries = UCombatMeleeQuerySubsystem::Get(GetWorld()))
 	{
-		// iterate over each object hit
-		for (const FHitResult& CurrentHit : OutHits)
-		{
-			// check if we've hit a damageable actor
-			ICombatDamageable* Damageable = Cast<ICombatDamageable>(CurrentHit.GetActor());
+		MeleeQueries->SubmitQuery(Query);
+	}
+}
 
-			if (Damageable)
-			{
-				// knock upwards and away from the impact normal
-				const FVector Impulse = (CurrentHit.ImpactNormal * -MeleeKnockbackImpulse) + (FVector::UpVector * MeleeLaunchImpulse);
+void ACombatCharacter::ResolveAttackTrace(const TArray<FHitResult>& Hits)
+{
+	// iterate over each object hit
+	for (const FHitResult& CurrentHit : Hits)
+	{
+		// check if we've hit a damageable actor
+		ICombatDamageable* Damageable = Cast<ICombatDamageable>(CurrentHit.GetActor());
 
-				// pass the damage event to the actor
-				Damageable->ApplyDamage(MeleeDamage, this, CurrentHit.ImpactPoint, Impulse);
+		if (Damageable)
+		{
+			// knock upwards and away from the impact normal
+			const FVector Impulse = (CurrentHit.ImpactNormal * -MeleeKnockbackImpulse) + (FVector::UpVector * MeleeLaunchImpulse);
 
-				// call the BP handler to play effects, etc.
-				DealtDamage(MeleeDamage, CurrentHit.ImpactPoint);
-			}
+			// queue the damage event for the actor
+			UCombatDamageSubsystem::ApplyOrQueueDamage(CurrentHit.GetActor(), MeleeDamage, this, CurrentHit.ImpactPoint, Impulse);
+
+			// call the BP handler to play effects, etc.
+			DealtDamage(MeleeDamage, CurrentHit.ImpactPoint);
 		}
 	}
 }
@@ -341,38 +361,38 @@ void ACombatCharacter::CheckChargedAttack()
 
 void ACombatCharacter::NotifyEnemiesOfIncomingAttack()
 {
-	// sweep for objects in front of the character to be hit by the attack
-	TArray<FHitResult> OutHits;
+	TPS_SCOPED_TIMER(NotifyIncomingAttack, TPSCombat);
+
+	UCombatSpatialHashSubsystem* SpatialHash = UCombatSpatialHashSubsystem::Get(GetWorld());
+
+	if (!SpatialHash)
+	{
+		return;
+	}
 
 	// start at the actor location, sweep forward
 	const FVector TraceStart = GetActorLocation();
 	const FVector TraceEnd = TraceStart + (GetActorForwardVector() * DangerTraceDistance);
 
-	// check for pawn object types only
-	FCollisionObjectQueryParams ObjectParams;
-	ObjectParams.AddObjectTypesToQuery(ECC_Pawn);
+	// check for pawns only and ignore self
+	FCombatSpatialQueryFilter Filter;
+	Filter.IgnoredActor = this;
+	Filter.bPawnsOnly = true;
 
-	// use a sphere shape for the sweep
-	FCollisionShape CollisionShape;
-	CollisionShape.SetSphere(DangerTraceRadius);
-
-	// ignore self
-	FCollisionQueryParams QueryParams;
-	QueryParams.AddIgnoredActor(this);
+	// look up the damageable actors in front of the character
+	TArray<AActor*> OutActors;
+	SpatialHash->QueryCapsuleSweep(TraceStart, TraceEnd, DangerTraceRadius, Filter, OutActors);
 
-	if (GetWorld()->SweepMultiByObjectType(OutHits, TraceStart, TraceEnd, FQuat::Identity, ObjectParams, CollisionShape, QueryParams))
+	// iterate over each actor found
+	for (AActor* CurrentActor : OutActors)
 	{
-		// iterate over each object hit
-		for (const FHitResult& CurrentHit : OutHits)
-		{
-			// check if we've hit a damageable actor
-			ICombatDamageable* Damageable = Cast<ICombatDamageable>(CurrentHit.GetActor());
+		// check if we've found a damageable actor
+		ICombatDamageable* Damageable = Cast<ICombatDamageable>(CurrentActor);
 
-			if (Damageable)
-			{
-				// notify the enemy
-				Damageable->NotifyDanger(GetActorLocation(), this);
-			}
+		if (Damageable)
+		{
+			// notify the enemy
+			Damageable->NotifyDanger(GetActorLocation(), this);
 		}
 	}
 }
@@ -404,14 +424,25 @@ void ACombatCharacter::ApplyDamage(float Damage, AActor* DamageCauser, const FVe
 
 void ACombatCharacter::HandleDeath()
 {
-	// disable movement while we're dead
-	GetCharacterMovement()->DisableMovement();
+	UCombatRagdollSubsystem* Ragdolls = UCombatRagdollSubsystem::Get(GetWorld());
 
-	// enable full ragdoll physics
-	GetMesh()->SetSimulatePhysics(true);
+	// disable movement while we're dead. Dedicated servers let the death blow knock the capsule back first, in place of the ragdoll
+	if (!Ragdolls || !Ragdolls->RequestCapsuleKnockback(this, false))
+	{
+		GetCharacterMovement()->DisableMovement();
+	}
+
+	// enable full ragdoll physics, if the ragdoll budget allows it
+	if (Ragdolls)
+	{
+		Ragdolls->RequestRagdoll(GetMesh());
+	}
 
 	// hide the life bar
-	LifeBar->SetHiddenInGame(true);
+	if (UCombatLifeBarSubsystem* LifeBars = UCombatLifeBarSubsystem::Get(GetWorld()))
+	{
+		LifeBars->SetVisible(this, false);
+	}
 
 	// pull back the camera
 	GetCameraBoom()->TargetArmLength = DeathCameraDistance;
@@ -432,10 +463,98 @@ void ACombatCharacter::NotifyDanger(const FVector& DangerLocation, AActor* Dange
 
 void ACombatCharacter::RespawnCharacter()
 {
+	// clients wait for the server to replicate the respawn or destroy the character
+	if (!HasAuthority())
+	{
+		return;
+	}
+
+	// reuse this character if we can, keeping its actor channel, camera and input bindings
+	if (CombatCharacter::bRespawnInPlace)
+	{
+		if (ACombatPlayerController* PC = Cast<ACombatPlayerController>(GetController()))
+		{
+			const FTransform RespawnTransform = PC->GetRespawnTransform();
+
+			// replicate the respawn so every client resets its own death state
+			LastRespawn.Location = RespawnTransform.GetLocation();
+			LastRespawn.Rotation = RespawnTransform.Rotator();
+			++LastRespawn.Count;
+
+			RespawnInPlace(RespawnTransform);
+			return;
+		}
+	}
+
 	// destroy the character and let it be respawned by the Player Controller
 	Destroy();
 }
 
+void ACombatCharacter::RespawnInPlace(const FTransform& RespawnTransform)
+{
+	// stop any knockback still running from our death
+	if (UCombatRagdollSubsystem* Ragdolls = UCombatRagdollSubsystem::Get(GetWorld()))
+	{
+		Ragdolls->CancelCapsuleKnockback(this);
+	}
+
+	// stop ragdolling and reattach the mesh at its original relative transform
+	GetMesh()->SetSimulatePhysics(false);
+	GetMesh()->SetPhysicsBlendWeight(0.0f);
+	GetMesh()->AttachToComponent(GetCapsuleComponent(), FAttachmentTransformRules::KeepRelativeTransform);
+	GetMesh()->SetRelativeTransform(MeshStartingTransform, false, nullptr, ETeleportType::ResetPhysics);
+
+	// stop any leftover attack animations
+	if (UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance())
+	{
+		AnimInstance->StopAllMontages(0.0f);
+	}
+
+	// teleport to the respawn point and face its direction
+	SetActorTransform(RespawnTransform, false, nullptr, ETeleportType::ResetPhysics);
+
+	if (AController* CurrentController = GetController())
+	{
+		CurrentController->SetControlRotation(RespawnTransform.Rotator());
+	}
+
+	// restore movement
+	GetCharacterMovement()->StopMovementImmediately();
+	GetCharacterMovement()->SetDefaultMovementMode();
+
+	// reset the combat state
+	bIsAttacking = false;
+	bIsChargingAttack = false;
+	bHasLoopedChargedAttack = false;
+	CachedAttackInputTime = 0.0f;
+	ComboCount = 0;
+
+	// bring the camera back in
+	GetCameraBoom()->TargetArmLength = DefaultCameraDistance;
+
+	// show the life bar again and refill it
+	if (UCombatLifeBarSubsystem* LifeBars = UCombatLifeBarSubsystem::Get(GetWorld()))
+	{
+		LifeBars->SetVisible(this, true);
+	}
+
+	ResetHP();
+}
+
+void ACombatCharacter::OnRep_LastRespawn()
+{
+	// the initial state of a newly relevant character is already alive, so there's nothing to replay
+	if (!HasActorBegunPlay())
+	{
+		return;
+	}
+
+	// cancel the local respawn timer in case it hasn't fired yet
+	GetWorld()->GetTimerManager().ClearTimer(RespawnTimer);
+
+	RespawnInPlace(FTransform(LastRespawn.Rotation, LastRespawn.Location));
+}
+
 float ACombatCharacter::TakeDamage(float Damage, struct FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser)
 {
 	// only process damage if the character is still alive
@@ -456,11 +575,19 @@ float ACombatCharacter::TakeDamage(float Damage, struct FDamageEvent const& Dama
 	else
 	{
 		// update the life bar
-		LifeBarWidget->SetLifePercentage(CurrentHP / MaxHP);
+		if (UCombatLifeBarSubsystem* LifeBars = UCombatLifeBarSubsystem::Get(GetWorld()))
+		{
+			LifeBars->SetPercentage(this, CurrentHP / MaxHP);
+		}
+
+		// enable partial ragdoll physics, but keep the pelvis vertical. Skip it if we're out of ragdoll budget
+		UCombatRagdollSubsystem* Ragdolls = UCombatRagdollSubsystem::Get(GetWorld());
 
-		// enable partial ragdoll physics, but keep the pelvis vertical
-		GetMesh()->SetPhysicsBlendWeight(0.5f);
-		GetMesh()->SetBodySimulatePhysics(PelvisBoneName, false);
+		if (Ragdolls && Ragdolls->CanPlayHitReaction())
+		{
+			GetMesh()->SetPhysicsBlendWeight(0.5f);
+			GetMesh()->SetBodySimulatePhysics(PelvisBoneName, false);
+		}
 	}
 
 	// return the received damage amount
@@ -483,18 +610,17 @@ void ACombatCharacter::BeginPlay()
 {
 	Super::BeginPlay();
 
-	// get the life bar from the widget component
-	LifeBarWidget = Cast<UCombatLifeBar>(LifeBar->GetUserWidgetObject());
-	check(LifeBarWidget);
-
 	// initialize the camera
 	GetCameraBoom()->TargetArmLength = DefaultCameraDistance;
 
 	// save the relative transform for the mesh so we can reset the ragdoll later
 	MeshStartingTransform = GetMesh()->GetRelativeTransform();
 
-	// set the life bar color
-	LifeBarWidget->SetBarColor(LifeBarColor);
+	// add our life bar to the batched life bar renderer
+	if (UCombatLifeBarSubsystem* LifeBars = UCombatLifeBarSubsystem::Get(GetWorld()))
+	{
+		LifeBars->RegisterBar(this, LifeBarOffset, LifeBarColor);
+	}
 
 	// reset HP to maximum
 	ResetHP();
@@ -506,6 +632,12 @@ void ACombatCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
 
 	// clear the respawn timer
 	GetWorld()->GetTimerManager().ClearTimer(RespawnTimer);
+
+	// remove our life bar
+	if (UCombatLifeBarSubsystem* LifeBars = UCombatLifeBarSubsystem::Get(GetWorld()))
+	{
+		LifeBars->UnregisterBar(this);
+	}
 }
 
 void ACombatCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
@@ -545,3 +677,10 @@ void ACombatCharacter::NotifyControllerChanged()
 	}
 }
 
+
+void ACombatCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(ACombatCharacter, LastRespawn);
+}
@@ -7,17 +7,37 @@
 #include "CombatAttacker.h"
 #include "CombatDamageable.h"
 #include "Animation/AnimInstance.h"
+#include "Engine/NetSerialization.h"
 #include "CombatCharacter.generated.h"
 
 class USpringArmComponent;
 class UCameraComponent;
 class UInputAction;
 struct FInputActionValue;
-class UCombatLifeBar;
-class UWidgetComponent;
 
 DECLARE_LOG_CATEGORY_EXTERN(LogCombatCharacter, Log, All);
 
+/**
+ *  Last in place respawn of a combat character, replicated so every machine resets its local death state
+ */
+USTRUCT()
+struct FCombatRespawn
+{
+	GENERATED_BODY()
+
+	/** Location the character respawned at */
+	UPROPERTY()
+	FVector_NetQuantize Location = FVector::ZeroVector;
+
+	/** Rotation the character respawned with */
+	UPROPERTY()
+	FRotator Rotation = FRotator::ZeroRotator;
+
+	/** Incremented on every respawn so respawning at the same point still replicates */
+	UPROPERTY()
+	uint8 Count = 0;
+};
+
 /**
  *  An enhanced Third Person Character with melee combat capabilities:
  *  - Combo attack string
@@ -38,10 +58,6 @@ class ACombatCharacter : public ACharacter, public ICombatAttacker, public IComb
 	/** Follow camera */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Components", meta = (AllowPrivateAccess = "true"))
 	UCameraComponent* FollowCamera;
-
-	/** Life bar widget component */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Components", meta = (AllowPrivateAccess = "true"))
-	UWidgetComponent* LifeBar;
 	
 protected:
 
@@ -81,17 +97,17 @@ protected:
 	UPROPERTY(VisibleAnywhere, Category="Damage")
 	float CurrentHP = 0.0f;
 
-	/** Life bar widget fill color */
+	/** Life bar fill color */
 	UPROPERTY(EditAnywhere, Category="Damage")
 	FLinearColor LifeBarColor;
 
-	/** Name of the pelvis bone, for damage ragdoll physics */
+	/** Offset from the character's location to the overhead life bar */
 	UPROPERTY(EditAnywhere, Category="Damage")
-	FName PelvisBoneName;
+	FVector LifeBarOffset = FVector(0.0f, 0.0f, 120.0f);
 
-	/** Pointer to the life bar widget */
+	/** Name of the pelvis bone, for damage ragdoll physics */
 	UPROPERTY(EditAnywhere, Category="Damage")
-	TObjectPtr<UCombatLifeBar> LifeBarWidget;
+	FName PelvisBoneName;
 
 	/** Max amount of time that may elapse for a non-combo attack input to not be considered stale */
 	UPROPERTY(EditAnywhere, Category="Melee Attack", meta = (ClampMin = 0, ClampMax = 5, Units = "s"))
@@ -182,6 +198,10 @@ protected:
 	/** Character respawn timer */
 	FTimerHandle RespawnTimer;
 
+	/** Last in place respawn, replayed on clients */
+	UPROPERTY(ReplicatedUsing = OnRep_LastRespawn)
+	FCombatRespawn LastRespawn;
+
 	/** Copy of the mesh's transform so we can reset it after ragdoll animations */
 	FTransform MeshStartingTransform;
 
@@ -262,6 +282,9 @@ public:
 	/** Performs the collision check for an attack */
 	virtual void DoAttackTrace(FName DamageSourceBone) override;
 
+	/** Applies damage to the actors hit by an attack */
+	virtual void ResolveAttackTrace(const TArray<FHitResult>& Hits) override;
+
 	/** Performs the combo string check */
 	virtual void CheckCombo() override;
 
@@ -289,9 +312,18 @@ public:
 
 	// ~end CombatDamageable interface
 
-	/** Called from the respawn timer to destroy and re-create the character */
+	/** Called from the respawn timer on the server to reset the character in place, or destroy it so it can be re-created */
 	void RespawnCharacter();
 
+protected:
+
+	/** Brings the character back to life at the provided transform without destroying it */
+	void RespawnInPlace(const FTransform& RespawnTransform);
+
+	/** Replays an in place respawn on clients */
+	UFUNCTION()
+	void OnRep_LastRespawn();
+
 public:
 
 	/** Overrides the default TakeDamage functionality */
@@ -324,6 +356,11 @@ protected:
 	/** Handles possessed initialization */
 	virtual void NotifyControllerChanged() override;
 
+public:
+
+	/** Sets up property replication */
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
 public:
 
 	/** Returns CameraBoom subobject **/
@@ -2,8 +2,10 @@
 
 
 #include "Variant_Combat/CombatGameMode.h"
+#include "CombatHUD.h"
 
 ACombatGameMode::ACombatGameMode()
 {
-
+	// draw the overhead life bars through the combat HUD
+	HUDClass = ACombatHUD::StaticClass();
 }
\ No newline at end of file
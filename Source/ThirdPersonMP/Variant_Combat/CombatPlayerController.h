@@ -12,7 +12,7 @@ class ACombatCharacter;
 /**
  *  Simple Player Controller for a third person combat game
  *  Manages input mappings
- *  Respawns the player character at the checkpoint when it's destroyed
+ *  Respawns the player character at the checkpoint when it's destroyed, unless it respawned in place
  */
 UCLASS(abstract, Config="Game")
 class ACombatPlayerController : public APlayerController
@@ -64,6 +64,9 @@ public:
 	/** Updates the character respawn transform */
 	void SetRespawnTransform(const FTransform& NewRespawn);
 
+	/** Returns the character respawn transform */
+	const FTransform& GetRespawnTransform() const { return RespawnTransform; }
+
 protected:
 
 	/** Called if the possessed pawn is destroyed */
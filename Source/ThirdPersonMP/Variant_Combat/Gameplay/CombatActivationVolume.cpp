@@ -5,6 +5,7 @@
 #include "Components/BoxComponent.h"
 #include "GameFramework/Character.h"
 #include "CombatActivatable.h"
+#include "CombatArenaSubsystem.h"
 
 ACombatActivationVolume::ACombatActivationVolume()
 {
@@ -24,6 +25,15 @@ ACombatActivationVolume::ACombatActivationVolume()
 	Box->OnComponentBeginOverlap.AddDynamic(this, &ACombatActivationVolume::OnOverlap);
 }
 
+bool ACombatActivationVolume::ContainsLocation(const FVector& Location) const
+{
+	// test in the box's local space so rotated and scaled volumes work
+	const FVector LocalLocation = Box->GetComponentTransform().InverseTransformPosition(Location);
+	const FVector Extent = Box->GetUnscaledBoxExtent();
+
+	return FMath::Abs(LocalLocation.X) <= Extent.X && FMath::Abs(LocalLocation.Y) <= Extent.Y && FMath::Abs(LocalLocation.Z) <= Extent.Z;
+}
+
 void ACombatActivationVolume::OnOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
 {
 	// has a Character entered the volume?
@@ -34,6 +44,15 @@ void ACombatActivationVolume::OnOverlap(UPrimitiveComponent* OverlappedComponent
 		// is the Character controlled by a player
 		if (PlayerCharacter->IsPlayerControlled())
 		{
+			// move the player's connection into this arena
+			if (HasAuthority())
+			{
+				if (UCombatArenaSubsystem* Arenas = UCombatArenaSubsystem::Get(GetWorld()))
+				{
+					Arenas->SetPlayerArena(PlayerCharacter->GetController(), this);
+				}
+			}
+
 			// process the actors to activate list
 			for (AActor* CurrentActor : ActorsToActivate)
 			{
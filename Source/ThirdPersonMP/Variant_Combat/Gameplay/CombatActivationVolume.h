@@ -10,6 +10,7 @@ class UBoxComponent;
 
 /**
  *  A simple volume that activates a list of actors when the player pawn enters.
+ *  Can also define a combat arena, which scopes the replication of the enemies and props inside it.
  */
 UCLASS()
 class ACombatActivationVolume : public AActor
@@ -26,11 +27,33 @@ protected:
 	UPROPERTY(EditAnywhere, Category="Activation Volume")
 	TArray<AActor*> ActorsToActivate;
 
+	/**
+	 *  If true, this volume defines an arena. Enemies and props inside it are only replicated to players in this arena or its neighbors.
+	 *  The volume must enclose the whole playable area of the arena. Players keep the arena of the last volume they entered,
+	 *  so a player standing in an uncovered part would still be culled against the previous arena's interest set.
+	 *  Off by default, so plain activation triggers don't cull replication.
+	 */
+	UPROPERTY(EditAnywhere, Category="Arena")
+	bool bDefinesArena = false;
+
+	/** Arenas whose actors stay replicated to players in this one, e.g. the ones visible from it. Neighbors are symmetric */
+	UPROPERTY(EditAnywhere, Category="Arena", meta = (EditCondition = "bDefinesArena"))
+	TArray<ACombatActivationVolume*> NeighborArenas;
+
 public:	
 	
 	/** Constructor */
 	ACombatActivationVolume();
 
+	/** Returns true if this volume defines an arena */
+	bool DefinesArena() const { return bDefinesArena; }
+
+	/** Returns the neighboring arenas */
+	const TArray<ACombatActivationVolume*>& GetNeighborArenas() const { return NeighborArenas; }
+
+	/** Returns true if the location is inside the volume's box */
+	bool ContainsLocation(const FVector& Location) const;
+
 protected:
 
 	/** Handles overlaps with the box volume */
@@ -0,0 +1,329 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "CombatArenaSubsystem.h"
+#include "CombatActivationVolume.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameFramework/Controller.h"
+#include "GameFramework/Pawn.h"
+#include "HAL/IConsoleManager.h"
+#include "ThirdPersonMP.h"
+
+namespace CombatArena
+{
+	static bool bEnabled = true;
+	static FAutoConsoleVariableRef CVarEnabled(
+		TEXT("TPS.Combat.Arena.Enabled"),
+		bEnabled,
+		TEXT("If true, arena actors are only replicated to players in the same arena or one of its neighbors."));
+
+	static int32 RebinPerFrame = 16;
+	static FAutoConsoleVariableRef CVarRebinPerFrame(
+		TEXT("TPS.Combat.Arena.RebinPerFrame"),
+		RebinPerFrame,
+		TEXT("Maximum number of tracked actors whose arena is re-evaluated each frame."));
+
+	static FAutoConsoleCommandWithWorld DumpCommand(
+		TEXT("TPS.Combat.Arena.Dump"),
+		TEXT("Logs the combat arenas, the number of actors in each and the players currently in them."),
+		FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+		{
+			if (UCombatArenaSubsystem* Arenas = UCombatArenaSubsystem::Get(World))
+			{
+				Arenas->DumpToLog();
+			}
+		}));
+
+	/** Returns true if the world replicates to remote connections */
+	static bool IsServer(const UWorld* World)
+	{
+		const ENetMode NetMode = World->GetNetMode();
+
+		return NetMode == NM_DedicatedServer || NetMode == NM_ListenServer;
+	}
+}
+
+UCombatArenaSubsystem* UCombatArenaSubsystem::Get(const UWorld* World)
+{
+	return World ? World->GetSubsystem<UCombatArenaSubsystem>() : nullptr;
+}
+
+void UCombatArenaSubsystem::RegisterActor(AActor* Actor)
+{
+	// interest management only matters on a server
+	if (!IsValid(Actor) || !Actor->HasAuthority() || !CombatArena::IsServer(GetWorld()) || EntryIndices.Contains(Actor))
+	{
+		return;
+	}
+
+	const int32 EntryIndex = Entries.Add(FEntry());
+	EntryIndices.Add(Actor, EntryIndex);
+
+	FEntry& NewEntry = Entries[EntryIndex];
+	NewEntry.Actor = Actor;
+
+	SetEntryArena(NewEntry, FindArena(Actor->GetActorLocation()));
+}
+
+void UCombatArenaSubsystem::UnregisterActor(AActor* Actor)
+{
+	int32 EntryIndex = INDEX_NONE;
+
+	if (EntryIndices.RemoveAndCopyValue(Actor, EntryIndex))
+	{
+		SetEntryArena(Entries[EntryIndex], INDEX_NONE);
+		Entries.RemoveAt(EntryIndex);
+	}
+}
+
+void UCombatArenaSubsystem::SetPlayerArena(const AController* PlayerController, const ACombatActivationVolume* Volume)
+{
+	if (!PlayerController)
+	{
+		return;
+	}
+
+	const int32 ArenaIndex = FindArena(Volume);
+
+	// overlapping a volume that isn't an arena keeps the current one
+	if (ArenaIndex != INDEX_NONE)
+	{
+		ViewerArenas.Add(PlayerController, ArenaIndex);
+	}
+}
+
+bool UCombatArenaSubsystem::IsRelevantForViewer(const AActor* Actor, const AActor* RealViewer, const AActor* ViewTarget) const
+{
+	if (!CombatArena::bEnabled)
+	{
+		return true;
+	}
+
+	// actors outside of all arenas use the default rules
+	const int32* EntryIndex = EntryIndices.Find(Actor);
+
+	if (!EntryIndex || Entries[*EntryIndex].Arena == INDEX_NONE)
+	{
+		return true;
+	}
+
+	// find the viewer's arena, falling back to the view target's controller
+	const int32* ViewerArena = ViewerArenas.Find(RealViewer);
+
+	if (!ViewerArena)
+	{
+		if (const APawn* ViewPawn = Cast<APawn>(ViewTarget))
+		{
+			ViewerArena = ViewerArenas.Find(ViewPawn->GetController());
+		}
+	}
+
+	// viewers that haven't entered an arena yet see everything
+	if (!ViewerArena)
+	{
+		return true;
+	}
+
+	return Arenas[*ViewerArena].InterestSet[Entries[*EntryIndex].Arena];
+}
+
+void UCombatArenaSubsystem::DumpToLog() const
+{
+	UE_LOG(LogThirdPersonMP, Log, TEXT("Combat arenas: %d arenas, %d tracked actors, %d viewers"), Arenas.Num(), Entries.Num(), ViewerArenas.Num());
+
+	for (int32 i = 0; i < Arenas.Num(); ++i)
+	{
+		const FArena& Arena = Arenas[i];
+
+		int32 NumViewers = 0;
+
+		for (const TPair<TObjectKey<AActor>, int32>& Viewer : ViewerArenas)
+		{
+			NumViewers += Viewer.Value == i ? 1 : 0;
+		}
+
+		UE_LOG(LogThirdPersonMP, Log, TEXT("  %s: %d actors, %d viewers, interest set of %d arenas"),
+			Arena.Volume.IsValid() ? *Arena.Volume->GetName() : TEXT("None"),
+			Arena.NumActors,
+			NumViewers,
+			Arena.InterestSet.CountSetBits());
+	}
+}
+
+void UCombatArenaSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	// forget the viewers whose controller logged out or was destroyed
+	for (auto It = ViewerArenas.CreateIterator(); It; ++It)
+	{
+		if (!It.Key().ResolveObjectPtr())
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	if (Entries.IsEmpty() || Arenas.IsEmpty())
+	{
+		return;
+	}
+
+	// re-bin a slice of the actors, round-robin, so the ones that wander off or get reused from a pool change arena
+	const int32 MaxIndex = Entries.GetMaxIndex();
+	const int32 NumRebins = FMath::Min(Entries.Num(), FMath::Max(1, CombatArena::RebinPerFrame));
+
+	int32 Rebinned = 0;
+
+	for (int32 Visited = 0; Visited < MaxIndex && Rebinned < NumRebins; ++Visited)
+	{
+		NextRebinIndex = NextRebinIndex % MaxIndex;
+
+		const int32 EntryIndex = NextRebinIndex++;
+
+		if (!Entries.IsValidIndex(EntryIndex))
+		{
+			continue;
+		}
+
+		FEntry& Entry = Entries[EntryIndex];
+		++Rebinned;
+
+		// drop actors that went away without unregistering
+		const AActor* Actor = Entry.Actor.Get();
+
+		if (!Actor)
+		{
+			SetEntryArena(Entry, INDEX_NONE);
+			Entries.RemoveAt(EntryIndex);
+			continue;
+		}
+
+		// keep the current arena while it still contains the actor
+		if (Entry.Arena != INDEX_NONE)
+		{
+			const ACombatActivationVolume* Volume = Arenas[Entry.Arena].Volume.Get();
+
+			if (Volume && Volume->ContainsLocation(Actor->GetActorLocation()))
+			{
+				continue;
+			}
+		}
+
+		SetEntryArena(Entry, FindArena(Actor->GetActorLocation()));
+	}
+
+	// the map has stale keys for any entries we removed above
+	if (EntryIndices.Num() != Entries.Num())
+	{
+		for (auto It = EntryIndices.CreateIterator(); It; ++It)
+		{
+			if (!Entries.IsValidIndex(It.Value()))
+			{
+				It.RemoveCurrent();
+			}
+		}
+	}
+}
+
+TStatId UCombatArenaSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCombatArenaSubsystem, STATGROUP_Tickables);
+}
+
+bool UCombatArenaSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UCombatArenaSubsystem::Deinitialize()
+{
+	Arenas.Reset();
+	Entries.Reset();
+	EntryIndices.Reset();
+	ViewerArenas.Reset();
+
+	Super::Deinitialize();
+}
+
+void UCombatArenaSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	if (!CombatArena::IsServer(&InWorld))
+	{
+		return;
+	}
+
+	// gather the arena volumes
+	for (TActorIterator<ACombatActivationVolume> It(&InWorld); It; ++It)
+	{
+		if (It->DefinesArena())
+		{
+			FArena& NewArena = Arenas.AddDefaulted_GetRef();
+			NewArena.Volume = *It;
+		}
+	}
+
+	// every arena is interested in itself and its neighbors. Neighbors are symmetric so either side can list them
+	for (FArena& Arena : Arenas)
+	{
+		Arena.InterestSet.Init(false, Arenas.Num());
+	}
+
+	for (int32 i = 0; i < Arenas.Num(); ++i)
+	{
+		Arenas[i].InterestSet[i] = true;
+
+		for (const ACombatActivationVolume* Neighbor : Arenas[i].Volume->GetNeighborArenas())
+		{
+			const int32 NeighborIndex = FindArena(Neighbor);
+
+			if (NeighborIndex != INDEX_NONE)
+			{
+				Arenas[i].InterestSet[NeighborIndex] = true;
+				Arenas[NeighborIndex].InterestSet[i] = true;
+			}
+		}
+	}
+}
+
+int32 UCombatArenaSubsystem::FindArena(const FVector& Location) const
+{
+	for (int32 i = 0; i < Arenas.Num(); ++i)
+	{
+		const ACombatActivationVolume* Volume = Arenas[i].Volume.Get();
+
+		if (Volume && Volume->ContainsLocation(Location))
+		{
+			return i;
+		}
+	}
+
+	return INDEX_NONE;
+}
+
+int32 UCombatArenaSubsystem::FindArena(const ACombatActivationVolume* Volume) const
+{
+	return Volume ? Arenas.IndexOfByPredicate([Volume](const FArena& Arena) { return Arena.Volume == Volume; }) : INDEX_NONE;
+}
+
+void UCombatArenaSubsystem::SetEntryArena(FEntry& Entry, int32 NewArena)
+{
+	if (Entry.Arena == NewArena)
+	{
+		return;
+	}
+
+	if (Entry.Arena != INDEX_NONE)
+	{
+		--Arenas[Entry.Arena].NumActors;
+	}
+
+	if (NewArena != INDEX_NONE)
+	{
+		++Arenas[NewArena].NumActors;
+	}
+
+	Entry.Arena = NewArena;
+}
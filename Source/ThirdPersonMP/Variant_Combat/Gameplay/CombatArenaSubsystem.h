@@ -0,0 +1,110 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Containers/SparseArray.h"
+#include "UObject/ObjectKey.h"
+#include "CombatArenaSubsystem.generated.h"
+
+class ACombatActivationVolume;
+
+/**
+ *  Server-side arena interest management for the combat variant.
+ *  Every ACombatActivationVolume that defines an arena is gathered on world begin play.
+ *  Enemies and props register with the arena that contains them, and are re-binned round-robin as they move.
+ *  Players are assigned an arena when they overlap its volume, and keep it until they enter another one.
+ *  Arena actors are only net relevant to connections whose player is in the same arena or one of its neighbors.
+ *  Actors outside of any arena, and viewers that haven't entered one yet, fall back to the default relevancy rules.
+ */
+UCLASS()
+class UCombatArenaSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+	/** A single arena */
+	struct FArena
+	{
+		/** Volume defining the arena's bounds */
+		TWeakObjectPtr<ACombatActivationVolume> Volume;
+
+		/** Arenas whose actors are relevant to viewers in this arena, including itself */
+		TBitArray<> InterestSet;
+
+		/** Number of actors currently binned in this arena */
+		int32 NumActors = 0;
+	};
+
+	/** A single actor tracked by the arenas */
+	struct FEntry
+	{
+		/** Tracked actor */
+		TWeakObjectPtr<AActor> Actor;
+
+		/** Index of the arena the actor is in, or INDEX_NONE */
+		int32 Arena = INDEX_NONE;
+	};
+
+	/** Arenas in the world */
+	TArray<FArena> Arenas;
+
+	/** Tracked actors. Sparse so entry indices stay stable as actors come and go */
+	TSparseArray<FEntry> Entries;
+
+	/** Maps each tracked actor to its entry index */
+	TMap<TObjectKey<AActor>, int32> EntryIndices;
+
+	/** Arena each viewing player controller is currently in */
+	TMap<TObjectKey<AActor>, int32> ViewerArenas;
+
+	/** Index of the next entry to re-bin */
+	int32 NextRebinIndex = 0;
+
+public:
+
+	/** Returns the subsystem for the provided world, if any */
+	static UCombatArenaSubsystem* Get(const UWorld* World);
+
+	/** Starts tracking a server actor and bins it into the arena that contains it */
+	void RegisterActor(AActor* Actor);
+
+	/** Stops tracking an actor */
+	void UnregisterActor(AActor* Actor);
+
+	/** Moves a player's viewer into an arena. Called when the player's pawn overlaps an arena volume */
+	void SetPlayerArena(const AController* PlayerController, const ACombatActivationVolume* Volume);
+
+	/** Returns false if the actor's arena is outside of the viewer's interest set */
+	bool IsRelevantForViewer(const AActor* Actor, const AActor* RealViewer, const AActor* ViewTarget) const;
+
+	/** Logs the arenas, their actor counts and the viewers in each one */
+	void DumpToLog() const;
+
+public:
+
+	// ~begin FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	// ~end FTickableGameObject interface
+
+protected:
+
+	/** Only create this subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Cleanup */
+	virtual void Deinitialize() override;
+
+	/** Gathers the arena volumes placed in the level, before any actor begins play */
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	/** Returns the index of the arena containing the location, or INDEX_NONE */
+	int32 FindArena(const FVector& Location) const;
+
+	/** Returns the index of the arena defined by the volume, or INDEX_NONE */
+	int32 FindArena(const ACombatActivationVolume* Volume) const;
+
+	/** Moves an entry to a new arena, keeping the actor counts up to date */
+	void SetEntryArena(FEntry& Entry, int32 NewArena);
+};
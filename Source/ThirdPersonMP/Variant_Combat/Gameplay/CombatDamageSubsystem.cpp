@@ -0,0 +1,161 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "CombatDamageSubsystem.h"
+#include "CombatDamageable.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "ThirdPersonMP.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Damage Events"), STAT_CombatDamageEvents, STATGROUP_ThirdPersonMP);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Damage Applications"), STAT_CombatDamageApplications, STATGROUP_ThirdPersonMP);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Damage Merge Ratio"), STAT_CombatDamageMergeRatio, STATGROUP_ThirdPersonMP);
+DECLARE_CYCLE_STAT(TEXT("Damage Queue Drain"), STAT_CombatDamageDrain, STATGROUP_ThirdPersonMP);
+
+namespace CombatDamage
+{
+	static bool bBatchDamage = true;
+	static FAutoConsoleVariableRef CVarBatchDamage(
+		TEXT("TPS.Combat.BatchDamage"),
+		bBatchDamage,
+		TEXT("If true, combat damage is queued and applied once per frame, merging hits on the same target.\n")
+		TEXT("If false, damage is applied as soon as it's dealt."));
+}
+
+UCombatDamageSubsystem* UCombatDamageSubsystem::Get(const UWorld* World)
+{
+	return World ? World->GetSubsystem<UCombatDamageSubsystem>() : nullptr;
+}
+
+void UCombatDamageSubsystem::QueueDamage(AActor* Target, float Damage, AActor* DamageCauser, const FVector& Location, const FVector& Impulse)
+{
+	FCombatDamageRecord Record;
+	Record.Target = Target;
+	Record.DamageCauser = DamageCauser;
+	Record.Damage = Damage;
+	Record.Location = Location;
+	Record.Impulse = Impulse;
+
+	// are we batching damage?
+	if (!CombatDamage::bBatchDamage)
+	{
+		ApplyRecord(Record);
+		return;
+	}
+
+	PendingDamage.Add(Record);
+}
+
+void UCombatDamageSubsystem::ApplyOrQueueDamage(AActor* Target, float Damage, AActor* DamageCauser, const FVector& Location, const FVector& Impulse)
+{
+	if (!Target)
+	{
+		return;
+	}
+
+	if (UCombatDamageSubsystem* DamageSubsystem = Get(Target->GetWorld()))
+	{
+		DamageSubsystem->QueueDamage(Target, Damage, DamageCauser, Location, Impulse);
+		return;
+	}
+
+	// no subsystem in this world, so apply the damage inline
+	if (ICombatDamageable* Damageable = Cast<ICombatDamageable>(Target))
+	{
+		Damageable->ApplyDamage(Damage, DamageCauser, Location, Impulse);
+	}
+}
+
+void UCombatDamageSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	DrainQueue();
+}
+
+TStatId UCombatDamageSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCombatDamageSubsystem, STATGROUP_Tickables);
+}
+
+bool UCombatDamageSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UCombatDamageSubsystem::Deinitialize()
+{
+	PendingDamage.Reset();
+	MergedDamage.Reset();
+
+	Super::Deinitialize();
+}
+
+void UCombatDamageSubsystem::DrainQueue()
+{
+	SCOPE_CYCLE_COUNTER(STAT_CombatDamageDrain);
+
+	const int32 NumEvents = PendingDamage.Num();
+
+	SET_DWORD_STAT(STAT_CombatDamageEvents, NumEvents);
+
+	if (NumEvents == 0)
+	{
+		SET_DWORD_STAT(STAT_CombatDamageApplications, 0);
+		SET_FLOAT_STAT(STAT_CombatDamageMergeRatio, 0.0f);
+		return;
+	}
+
+	// merge hits on the same target from the same causer, keeping the order they were first queued in.
+	// Queues are small, so a linear search beats hashing here
+	MergedDamage.Reset();
+
+	for (const FCombatDamageRecord& Record : PendingDamage)
+	{
+		FCombatDamageRecord* Merged = MergedDamage.FindByPredicate([&Record](const FCombatDamageRecord& Other)
+		{
+			return Other.Target == Record.Target && Other.DamageCauser == Record.DamageCauser;
+		});
+
+		if (!Merged)
+		{
+			MergedDamage.Add(Record);
+			continue;
+		}
+
+		// report the strongest hit's location
+		if (Record.Damage > Merged->Damage)
+		{
+			Merged->Location = Record.Location;
+		}
+
+		Merged->Damage += Record.Damage;
+		Merged->Impulse += Record.Impulse;
+	}
+
+	PendingDamage.Reset();
+
+	SET_DWORD_STAT(STAT_CombatDamageApplications, MergedDamage.Num());
+	SET_FLOAT_STAT(STAT_CombatDamageMergeRatio, static_cast<float>(NumEvents) / MergedDamage.Num());
+
+	// apply the merged damage. Anything queued as a result, e.g. from death effects, goes into next frame's batch
+	TArray<FCombatDamageRecord> Batch = MoveTemp(MergedDamage);
+
+	for (const FCombatDamageRecord& Record : Batch)
+	{
+		ApplyRecord(Record);
+	}
+
+	// hand the storage back for reuse
+	MergedDamage = MoveTemp(Batch);
+	MergedDamage.Reset();
+}
+
+void UCombatDamageSubsystem::ApplyRecord(const FCombatDamageRecord& Record)
+{
+	// skip targets that went away while the damage was queued
+	if (ICombatDamageable* Damageable = Cast<ICombatDamageable>(Record.Target.Get()))
+	{
+		Damageable->ApplyDamage(Record.Damage, Record.DamageCauser.Get(), Record.Location, Record.Impulse);
+	}
+}
@@ -0,0 +1,81 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CombatDamageSubsystem.generated.h"
+
+/**
+ *  A single queued damage event
+ */
+struct FCombatDamageRecord
+{
+	/** Actor receiving the damage. Must implement ICombatDamageable */
+	TWeakObjectPtr<AActor> Target;
+
+	/** Actor dealing the damage */
+	TWeakObjectPtr<AActor> DamageCauser;
+
+	/** Amount of damage to deal */
+	float Damage = 0.0f;
+
+	/** World location of the hit */
+	FVector Location = FVector::ZeroVector;
+
+	/** Knockback impulse to apply */
+	FVector Impulse = FVector::ZeroVector;
+};
+
+/**
+ *  Collects the damage dealt to ICombatDamageable actors during the frame and applies it in a single pass.
+ *  Producers such as melee traces, lava floors and projectiles push damage records instead of calling ApplyDamage
+ *  from inside physics callbacks. Records for the same target and causer are merged, adding their damage and impulses,
+ *  and the merged events are applied in the order they were first queued so the outcome is deterministic.
+ */
+UCLASS()
+class UCombatDamageSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+	/** Damage queued this frame */
+	TArray<FCombatDamageRecord> PendingDamage;
+
+	/** Scratch list of merged records, kept around to avoid reallocating every frame */
+	TArray<FCombatDamageRecord> MergedDamage;
+
+public:
+
+	/** Returns the subsystem for the provided world, if any */
+	static UCombatDamageSubsystem* Get(const UWorld* World);
+
+	/** Queues damage for a target. Depending on configuration it will be applied right away or at the end of the frame */
+	void QueueDamage(AActor* Target, float Damage, AActor* DamageCauser, const FVector& Location, const FVector& Impulse);
+
+	/** Queues damage through the target's world subsystem, or applies it immediately if there is none */
+	static void ApplyOrQueueDamage(AActor* Target, float Damage, AActor* DamageCauser, const FVector& Location, const FVector& Impulse);
+
+	/** Returns the number of damage records waiting to be applied */
+	int32 GetNumQueuedDamage() const { return PendingDamage.Num(); }
+
+public:
+
+	// ~begin FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	// ~end FTickableGameObject interface
+
+protected:
+
+	/** Only create this subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Cleanup */
+	virtual void Deinitialize() override;
+
+	/** Merges and applies all queued damage */
+	void DrainQueue();
+
+	/** Passes a damage record to its target */
+	static void ApplyRecord(const FCombatDamageRecord& Record);
+};
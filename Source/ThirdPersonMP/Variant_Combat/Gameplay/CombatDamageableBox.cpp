@@ -5,6 +5,276 @@
 #include "Components/StaticMeshComponent.h"
 #include "TimerManager.h"
 #include "Engine/World.h"
+#include "Engine/NetDriver.h"
+#include "EngineUtils.h"
+#include "GameFramework/GameStateBase.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+#include "Net/UnrealNetwork.h"
+#include "HAL/IConsoleManager.h"
+#include "TPSAdaptiveNetSubsystem.h"
+#include "CombatArenaSubsystem.h"
+#include "ThirdPersonMP.h"
+
+namespace CombatDamageableBox
+{
+	static float MaxImpulseAge = 0.5f;
+	static FAutoConsoleVariableRef CVarMaxImpulseAge(
+		TEXT("TPS.Combat.BoxImpulseMaxAge"),
+		MaxImpulseAge,
+		TEXT("Replicated box impulses older than this are not applied on clients, e.g. when a box becomes relevant late, in seconds."));
+
+	/** Boxes per side of each layer of the benchmark pile */
+	static constexpr int32 BenchmarkPileWidth = 5;
+
+	/** Time spent measuring the baseline and the resting pile, in seconds */
+	static constexpr float BenchmarkMeasureTime = 3.0f;
+
+	/** Maximum time to wait for the pile to fall asleep, in seconds */
+	static constexpr float BenchmarkSettleTimeout = 30.0f;
+
+	/** Knockback impulse applied to every box in the pile, ignoring mass */
+	static constexpr float BenchmarkImpulse = 800.0f;
+
+	/** State of a running box pile benchmark */
+	struct FBenchmark
+	{
+		enum class EPhase : uint8
+		{
+			Baseline,
+			Settle,
+			Rest,
+			Knockback,
+		};
+
+		TWeakObjectPtr<UWorld> World;
+		TSubclassOf<ACombatDamageableBox> BoxClass;
+		TArray<TWeakObjectPtr<ACombatDamageableBox>> Boxes;
+		FVector Origin = FVector::ZeroVector;
+		int32 Count = 0;
+		EPhase Phase = EPhase::Baseline;
+		double PhaseStartTime = 0.0;
+		uint64 PhaseStartBytes = 0;
+		int32 PeakAwake = 0;
+		double BaselineBytesPerSecond = 0.0;
+		FTimerHandle Timer;
+	};
+
+	/** Returns the total number of bytes the server has sent */
+	static uint64 GetBytesSent(const UWorld* World)
+	{
+		const UNetDriver* NetDriver = World->GetNetDriver();
+		return NetDriver ? static_cast<uint64>(NetDriver->OutTotalBytes) : 0;
+	}
+
+	/** Logs the bytes sent during the current phase and moves on to the next one */
+	static void EndPhase(FBenchmark& Bench, const TCHAR* PhaseName, double& OutBytesPerSecond)
+	{
+		UWorld* World = Bench.World.Get();
+
+		const double Elapsed = FMath::Max(World->GetRealTimeSeconds() - Bench.PhaseStartTime, UE_SMALL_NUMBER);
+		const uint64 Bytes = GetBytesSent(World) - Bench.PhaseStartBytes;
+		OutBytesPerSecond = Bytes / Elapsed;
+
+		int32 NumDormant = 0;
+
+		for (const TWeakObjectPtr<ACombatDamageableBox>& Box : Bench.Boxes)
+		{
+			NumDormant += Box.IsValid() && Box->NetDormancy >= DORM_DormantAll ? 1 : 0;
+		}
+
+		UE_LOG(LogThirdPersonMP, Log, TEXT("Box benchmark [%s]: %.2f s, %llu bytes sent, %.0f bytes/s (%.1f bytes/s per box above baseline), peak awake %d, dormant %d/%d"),
+			PhaseName,
+			Elapsed,
+			Bytes,
+			OutBytesPerSecond,
+			Bench.Count > 0 ? (OutBytesPerSecond - Bench.BaselineBytesPerSecond) / Bench.Count : 0.0,
+			Bench.PeakAwake,
+			NumDormant,
+			Bench.Boxes.Num());
+
+		Bench.PhaseStartTime = World->GetRealTimeSeconds();
+		Bench.PhaseStartBytes = GetBytesSent(World);
+		Bench.PeakAwake = 0;
+	}
+
+	/** Spawns the benchmark pile as a stack of square layers */
+	static void SpawnPile(FBenchmark& Bench)
+	{
+		UWorld* World = Bench.World.Get();
+
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+		FVector BoxSize = FVector(100.0f);
+
+		// returns the location of a box in the pile, with a small gap between boxes
+		auto GetPileLocation = [&Bench, &BoxSize](int32 Index)
+		{
+			const int32 Layer = Index / (BenchmarkPileWidth * BenchmarkPileWidth);
+			const int32 X = Index % BenchmarkPileWidth - BenchmarkPileWidth / 2;
+			const int32 Y = (Index / BenchmarkPileWidth) % BenchmarkPileWidth - BenchmarkPileWidth / 2;
+
+			return Bench.Origin + FVector(X, Y, Layer) * BoxSize * 1.05f;
+		};
+
+		for (int32 i = 0; i < Bench.Count; ++i)
+		{
+			ACombatDamageableBox* Box = World->SpawnActor<ACombatDamageableBox>(Bench.BoxClass, GetPileLocation(i), FRotator::ZeroRotator, SpawnParams);
+
+			if (!Box)
+			{
+				continue;
+			}
+
+			// space the pile out by the size of the first box
+			if (Bench.Boxes.IsEmpty())
+			{
+				BoxSize = Box->GetComponentsBoundingBox().GetSize().ComponentMax(FVector(1.0f));
+				Box->SetActorLocation(GetPileLocation(i));
+			}
+
+			Bench.Boxes.Add(Box);
+		}
+	}
+
+	/** Advances the benchmark. Polled on a timer */
+	static void StepBenchmark(const TSharedRef<FBenchmark>& Bench)
+	{
+		UWorld* World = Bench->World.Get();
+
+		if (!World)
+		{
+			return;
+		}
+
+		// count the awake boxes
+		int32 NumAwake = 0;
+
+		for (const TWeakObjectPtr<ACombatDamageableBox>& Box : Bench->Boxes)
+		{
+			NumAwake += Box.IsValid() && Box->IsAwake() ? 1 : 0;
+		}
+
+		Bench->PeakAwake = FMath::Max(Bench->PeakAwake, NumAwake);
+
+		const double PhaseTime = World->GetRealTimeSeconds() - Bench->PhaseStartTime;
+		double BytesPerSecond = 0.0;
+
+		switch (Bench->Phase)
+		{
+		case FBenchmark::EPhase::Baseline:
+
+			if (PhaseTime >= BenchmarkMeasureTime)
+			{
+				EndPhase(*Bench, TEXT("baseline"), Bench->BaselineBytesPerSecond);
+
+				SpawnPile(*Bench);
+				Bench->Phase = FBenchmark::EPhase::Settle;
+			}
+
+			return;
+
+		case FBenchmark::EPhase::Settle:
+
+			if (NumAwake == 0 || PhaseTime >= BenchmarkSettleTimeout)
+			{
+				EndPhase(*Bench, TEXT("settle"), BytesPerSecond);
+				Bench->Phase = FBenchmark::EPhase::Rest;
+			}
+
+			return;
+
+		case FBenchmark::EPhase::Rest:
+
+			if (PhaseTime >= BenchmarkMeasureTime)
+			{
+				EndPhase(*Bench, TEXT("rest"), BytesPerSecond);
+
+				// knock the pile over from its center
+				for (const TWeakObjectPtr<ACombatDamageableBox>& Box : Bench->Boxes)
+				{
+					if (Box.IsValid())
+					{
+						const FVector Direction = (Box->GetActorLocation() - Bench->Origin).GetSafeNormal2D() + FVector::UpVector;
+						Box->ApplyDamage(0.0f, nullptr, Box->GetActorLocation(), Direction.GetSafeNormal() * BenchmarkImpulse);
+					}
+				}
+
+				Bench->Phase = FBenchmark::EPhase::Knockback;
+			}
+
+			return;
+
+		case FBenchmark::EPhase::Knockback:
+
+			if ((NumAwake == 0 && PhaseTime > 0.5) || PhaseTime >= BenchmarkSettleTimeout)
+			{
+				EndPhase(*Bench, TEXT("knockback"), BytesPerSecond);
+
+				// clean up
+				for (const TWeakObjectPtr<ACombatDamageableBox>& Box : Bench->Boxes)
+				{
+					if (Box.IsValid())
+					{
+						Box->Destroy();
+					}
+				}
+
+				World->GetTimerManager().ClearTimer(Bench->Timer);
+			}
+
+			return;
+		}
+	}
+
+	static FAutoConsoleCommandWithWorldAndArgs BenchmarkCommand(
+		TEXT("TPS.Combat.BenchBoxes"),
+		TEXT("Spawns a pile of damageable boxes in front of the first player, lets it settle, knocks it over and logs the bytes sent in each phase.\n")
+		TEXT("Uses the class of the first damageable box in the level. Must be run on the server.\n")
+		TEXT("Usage: TPS.Combat.BenchBoxes [Count=200]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			if (!World || World->GetNetMode() == NM_Client)
+			{
+				UE_LOG(LogThirdPersonMP, Warning, TEXT("TPS.Combat.BenchBoxes must be run on the server."));
+				return;
+			}
+
+			TSharedRef<FBenchmark> Bench = MakeShared<FBenchmark>();
+			Bench->World = World;
+			Bench->Count = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 200;
+
+			// use the first box placed in the level as the template
+			for (TActorIterator<ACombatDamageableBox> It(World); It; ++It)
+			{
+				Bench->BoxClass = It->GetClass();
+				break;
+			}
+
+			if (!Bench->BoxClass)
+			{
+				UE_LOG(LogThirdPersonMP, Warning, TEXT("TPS.Combat.BenchBoxes needs a damageable box in the level to copy."));
+				return;
+			}
+
+			// center the pile in front of the first player, if we have one
+			if (APlayerController* PC = World->GetFirstPlayerController())
+			{
+				if (APawn* Pawn = PC->GetPawn())
+				{
+					Bench->Origin = Pawn->GetActorLocation() + Pawn->GetActorForwardVector() * 800.0f;
+				}
+			}
+
+			UE_LOG(LogThirdPersonMP, Log, TEXT("Box benchmark: %d boxes of %s"), Bench->Count, *Bench->BoxClass->GetName());
+
+			Bench->PhaseStartTime = World->GetRealTimeSeconds();
+			Bench->PhaseStartBytes = GetBytesSent(World);
+
+			World->GetTimerManager().SetTimer(Bench->Timer, FTimerDelegate::CreateLambda([Bench]() { StepBenchmark(Bench); }), 0.1f, true);
+		}));
+}
 
 ACombatDamageableBox::ACombatDamageableBox()
 {
@@ -21,6 +291,66 @@ ACombatDamageableBox::ACombatDamageableBox()
 
 	// disable navigation relevance so boxes don't affect NavMesh generation
 	Mesh->bNavigationRelevant = false;
+
+	// get notified when the rigid body wakes up or falls asleep
+	Mesh->BodyInstance.bGenerateWakeEvents = true;
+	Mesh->OnComponentWake.AddDynamic(this, &ACombatDamageableBox::OnMeshWake);
+	Mesh->OnComponentSleep.AddDynamic(this, &ACombatDamageableBox::OnMeshSleep);
+
+	// replicate the physics state with predictive interpolation. Boxes start dormant and only wake up for replication while simulating
+	bReplicates = true;
+	SetReplicatingMovement(true);
+	SetPhysicsReplicationMode(EPhysicsReplicationMode::PredictiveInterpolation);
+	SetNetUpdateFrequency(30.0f);
+	NetDormancy = DORM_Initial;
+}
+
+bool ACombatDamageableBox::IsAwake() const
+{
+	return Mesh->RigidBodyIsAwake();
+}
+
+void ACombatDamageableBox::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(ACombatDamageableBox, LastImpulse);
+}
+
+void ACombatDamageableBox::OnRep_LastImpulse()
+{
+	// skip stale impulses, e.g. if we just became relevant
+	if (const AGameStateBase* GameState = GetWorld()->GetGameState())
+	{
+		if (GameState->GetServerWorldTimeSeconds() - LastImpulse.ServerTime > CombatDamageableBox::MaxImpulseAge)
+		{
+			return;
+		}
+	}
+
+	// predict the knockback locally. Physics replication will blend in the server state as it arrives
+	Mesh->AddImpulseAtLocation(FVector(LastImpulse.Impulse) * Mesh->GetMass(), LastImpulse.Location);
+
+	// call the BP handler to play effects, etc.
+	OnBoxDamaged(LastImpulse.Location, LastImpulse.Impulse);
+}
+
+void ACombatDamageableBox::OnMeshWake(UPrimitiveComponent* WakingComponent, FName BoneName)
+{
+	// start replicating the simulation
+	if (HasAuthority())
+	{
+		SetNetDormancy(DORM_Awake);
+	}
+}
+
+void ACombatDamageableBox::OnMeshSleep(UPrimitiveComponent* SleepingComponent, FName BoneName)
+{
+	// send the resting transform and stop replicating
+	if (HasAuthority())
+	{
+		SetNetDormancy(DORM_DormantAll);
+	}
 }
 
 void ACombatDamageableBox::RemoveFromLevel()
@@ -29,12 +359,55 @@ void ACombatDamageableBox::RemoveFromLevel()
 	Destroy();
 }
 
+void ACombatDamageableBox::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// let the server scale our net update frequency under load
+	if (UTPSAdaptiveNetSubsystem* AdaptiveNet = UTPSAdaptiveNetSubsystem::Get(GetWorld()))
+	{
+		AdaptiveNet->RegisterActor(this, ETPSAdaptiveNetClass::Prop);
+	}
+
+	// only replicate to the players in our arena
+	if (UCombatArenaSubsystem* Arenas = UCombatArenaSubsystem::Get(GetWorld()))
+	{
+		Arenas->RegisterActor(this);
+	}
+}
+
 void ACombatDamageableBox::EndPlay(EEndPlayReason::Type EndPlayReason)
 {
 	Super::EndPlay(EndPlayReason);
 
 	// clear the death timer
 	GetWorld()->GetTimerManager().ClearTimer(DeathTimer);
+
+	// stop net update frequency scaling
+	if (UTPSAdaptiveNetSubsystem* AdaptiveNet = UTPSAdaptiveNetSubsystem::Get(GetWorld()))
+	{
+		AdaptiveNet->UnregisterActor(this, ETPSAdaptiveNetClass::Prop);
+	}
+
+	// leave our arena
+	if (UCombatArenaSubsystem* Arenas = UCombatArenaSubsystem::Get(GetWorld()))
+	{
+		Arenas->UnregisterActor(this);
+	}
+}
+
+bool ACombatDamageableBox::IsNetRelevantFor(const AActor* RealViewer, const AActor* ViewTarget, const FVector& SrcLocation) const
+{
+	// skip connections whose player is in an unrelated arena
+	if (const UCombatArenaSubsystem* Arenas = UCombatArenaSubsystem::Get(GetWorld()))
+	{
+		if (!Arenas->IsRelevantForViewer(this, RealViewer, ViewTarget))
+		{
+			return false;
+		}
+	}
+
+	return Super::IsNetRelevantFor(RealViewer, ViewTarget, SrcLocation);
 }
 
 void ACombatDamageableBox::ApplyDamage(float Damage, AActor* DamageCauser, const FVector& DamageLocation, const FVector& DamageImpulse)
@@ -51,9 +424,25 @@ void ACombatDamageableBox::ApplyDamage(float Damage, AActor* DamageCauser, const
 			HandleDeath();
 		}
 
+		// clients that ran the hit locally still wait for the replicated impulse, so the knockback and effects only play once
+		if (!HasAuthority())
+		{
+			return;
+		}
+
 		// apply a physics impulse to the box, ignoring its mass
 		Mesh->AddImpulseAtLocation(DamageImpulse * Mesh->GetMass(), DamageLocation);
 
+		// replicate the impulse so clients can predict the knockback. Wake up first so it goes out with the next update
+		SetNetDormancy(DORM_Awake);
+
+		const AGameStateBase* GameState = GetWorld()->GetGameState();
+
+		LastImpulse.Location = DamageLocation;
+		LastImpulse.Impulse = DamageImpulse;
+		LastImpulse.ServerTime = GameState ? GameState->GetServerWorldTimeSeconds() : GetWorld()->GetTimeSeconds();
+		++LastImpulse.Count;
+
 		// call the BP handler to play effects, etc.
 		OnBoxDamaged(DamageLocation, DamageImpulse);
 	}
@@ -5,10 +5,40 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
 #include "CombatDamageable.h"
+#include "Engine/NetSerialization.h"
 #include "CombatDamageableBox.generated.h"
 
 /**
- *  A simple physics box that reacts to damage through the ICombatDamageable interface
+ *  Last knockback impulse applied to a damageable box, replicated so clients can predict it locally
+ */
+USTRUCT()
+struct FCombatBoxImpulse
+{
+	GENERATED_BODY()
+
+	/** World location the impulse was applied at */
+	UPROPERTY()
+	FVector_NetQuantize Location = FVector::ZeroVector;
+
+	/** Impulse, ignoring the box's mass */
+	UPROPERTY()
+	FVector_NetQuantize10 Impulse = FVector::ZeroVector;
+
+	/** Server world time the impulse was applied at */
+	UPROPERTY()
+	float ServerTime = 0.0f;
+
+	/** Incremented on every impulse so repeated identical hits still replicate */
+	UPROPERTY()
+	uint8 Count = 0;
+};
+
+/**
+ *  A simple physics box that reacts to damage through the ICombatDamageable interface.
+ *  Replicates its physics state with predictive interpolation, but only while its rigid body is awake:
+ *  the box goes dormant as soon as it falls asleep, so resting boxes cost no bandwidth.
+ *  Knockback impulses are replicated so clients can apply them locally instead of waiting for the corrections.
+ *  Clients only apply knockback and play damage effects from the replicated impulse, even for hits they traced themselves.
  */
 UCLASS(abstract)
 class ACombatDamageableBox : public AActor, public ICombatDamageable
@@ -24,6 +54,12 @@ public:
 	/** Constructor */
 	ACombatDamageableBox();
 
+	/** Returns true if the box's rigid body is currently simulating */
+	bool IsAwake() const;
+
+	/** Sets up property replication */
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
 protected:
 
 	/** Amount of HP this box starts with. */
@@ -37,6 +73,22 @@ protected:
 	/** Timer to defer destruction of this box after its HP are depleted */
 	FTimerHandle DeathTimer;
 
+	/** Last knockback impulse, replayed on clients */
+	UPROPERTY(ReplicatedUsing = OnRep_LastImpulse)
+	FCombatBoxImpulse LastImpulse;
+
+	/** Applies the replicated knockback impulse locally */
+	UFUNCTION()
+	void OnRep_LastImpulse();
+
+	/** Wakes the box up for replication when its rigid body wakes up */
+	UFUNCTION()
+	void OnMeshWake(UPrimitiveComponent* WakingComponent, FName BoneName);
+
+	/** Puts the box to sleep for replication when its rigid body goes to sleep */
+	UFUNCTION()
+	void OnMeshSleep(UPrimitiveComponent* SleepingComponent, FName BoneName);
+
 	/** Blueprint damage handler for effect playback */
 	UFUNCTION(BlueprintImplementableEvent, Category="Damage")
 	void OnBoxDamaged(const FVector& DamageLocation, const FVector& DamageImpulse);
@@ -50,9 +102,15 @@ protected:
 
 public:
 
+	/** Gameplay initialization */
+	virtual void BeginPlay() override;
+
 	/** EndPlay cleanup */
 	void EndPlay(EEndPlayReason::Type EndPlayReason) override;
 
+	/** Only replicates to players in this box's arena or one of its neighbors */
+	virtual bool IsNetRelevantFor(const AActor* RealViewer, const AActor* ViewTarget, const FVector& SrcLocation) const override;
+
 	// ~Begin CombatDamageable interface
 
 	/** Handles damage and knockback events */
@@ -0,0 +1,143 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "CombatMeleeQuerySubsystem.h"
+#include "CombatAttacker.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+namespace CombatMeleeQuery
+{
+	static bool bAsyncTraces = true;
+	static FAutoConsoleVariableRef CVarAsyncTraces(
+		TEXT("TPS.Combat.AsyncMeleeTraces"),
+		bAsyncTraces,
+		TEXT("If true, melee attack traces are batched and run as async sweeps, resolving on the next frame.\n")
+		TEXT("If false, they are swept synchronously as soon as they're requested."));
+}
+
+UCombatMeleeQuerySubsystem* UCombatMeleeQuerySubsystem::Get(const UWorld* World)
+{
+	return World ? World->GetSubsystem<UCombatMeleeQuerySubsystem>() : nullptr;
+}
+
+void UCombatMeleeQuerySubsystem::SubmitQuery(const FCombatMeleeQuery& Query)
+{
+	// are we batching traces?
+	if (CombatMeleeQuery::bAsyncTraces)
+	{
+		// defer the sweep until the end of the frame
+		PendingQueries.Add(Query);
+		return;
+	}
+
+	// sweep and resolve right away
+	TArray<FHitResult> OutHits;
+	RunQueryImmediate(Query, OutHits);
+	ResolveQuery(Query, OutHits);
+}
+
+void UCombatMeleeQuerySubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	// resolve last frame's batch first so results are applied in submission order
+	ResolveInFlightQueries();
+
+	// kick off this frame's batch
+	DispatchPendingQueries();
+}
+
+TStatId UCombatMeleeQuerySubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCombatMeleeQuerySubsystem, STATGROUP_Tickables);
+}
+
+bool UCombatMeleeQuerySubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UCombatMeleeQuerySubsystem::Deinitialize()
+{
+	PendingQueries.Reset();
+	InFlightQueries.Reset();
+
+	Super::Deinitialize();
+}
+
+void UCombatMeleeQuerySubsystem::ResolveInFlightQueries()
+{
+	if (InFlightQueries.IsEmpty())
+	{
+		return;
+	}
+
+	UWorld* World = GetWorld();
+
+	// move the batch out so attackers can safely submit new queries while we resolve
+	TArray<FDispatchedQuery> Batch = MoveTemp(InFlightQueries);
+	InFlightQueries.Reset();
+
+	for (const FDispatchedQuery& Dispatched : Batch)
+	{
+		// skip queries whose attacker went away
+		if (!Dispatched.Query.Attacker.IsValid())
+		{
+			continue;
+		}
+
+		FTraceDatum TraceData;
+
+		if (World->QueryTraceData(Dispatched.Handle, TraceData))
+		{
+			ResolveQuery(Dispatched.Query, TraceData.OutHits);
+		}
+		else
+		{
+			// the async results are no longer available, so fall back to a synchronous sweep to avoid dropping the hit
+			TArray<FHitResult> OutHits;
+			RunQueryImmediate(Dispatched.Query, OutHits);
+			ResolveQuery(Dispatched.Query, OutHits);
+		}
+	}
+}
+
+void UCombatMeleeQuerySubsystem::DispatchPendingQueries()
+{
+	UWorld* World = GetWorld();
+
+	InFlightQueries.Reserve(InFlightQueries.Num() + PendingQueries.Num());
+
+	for (const FCombatMeleeQuery& Query : PendingQueries)
+	{
+		FDispatchedQuery& Dispatched = InFlightQueries.AddDefaulted_GetRef();
+		Dispatched.Query = Query;
+		Dispatched.Handle = World->AsyncSweepByObjectType(EAsyncTraceType::Multi, Query.Start, Query.End, FQuat::Identity, Query.ObjectParams, FCollisionShape::MakeSphere(Query.Radius), MakeQueryParams(Query));
+	}
+
+	PendingQueries.Reset();
+}
+
+void UCombatMeleeQuerySubsystem::RunQueryImmediate(const FCombatMeleeQuery& Query, TArray<FHitResult>& OutHits) const
+{
+	GetWorld()->SweepMultiByObjectType(OutHits, Query.Start, Query.End, FQuat::Identity, Query.ObjectParams, FCollisionShape::MakeSphere(Query.Radius), MakeQueryParams(Query));
+}
+
+void UCombatMeleeQuerySubsystem::ResolveQuery(const FCombatMeleeQuery& Query, const TArray<FHitResult>& Hits) const
+{
+	// pass the results back to the attacker
+	if (ICombatAttacker* Attacker = Cast<ICombatAttacker>(Query.Attacker.Get()))
+	{
+		Attacker->ResolveAttackTrace(Hits);
+	}
+}
+
+FCollisionQueryParams UCombatMeleeQuerySubsystem::MakeQueryParams(const FCombatMeleeQuery& Query)
+{
+	// ignore the attacker
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(CombatMeleeQuery), false);
+	QueryParams.AddIgnoredActor(Query.Attacker.Get());
+
+	return QueryParams;
+}
@@ -0,0 +1,95 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "WorldCollision.h"
+#include "CombatMeleeQuerySubsystem.generated.h"
+
+/**
+ *  Describes a single melee attack sphere sweep
+ */
+struct FCombatMeleeQuery
+{
+	/** Actor performing the attack. Must implement ICombatAttacker to receive the results */
+	TWeakObjectPtr<AActor> Attacker;
+
+	/** Sweep start location */
+	FVector Start = FVector::ZeroVector;
+
+	/** Sweep end location */
+	FVector End = FVector::ZeroVector;
+
+	/** Radius of the swept sphere */
+	float Radius = 0.0f;
+
+	/** Object types the sweep will look for */
+	FCollisionObjectQueryParams ObjectParams;
+};
+
+/**
+ *  Collects the melee attack traces requested during the frame, usually from AnimNotifies,
+ *  and runs them as a single batch of async sweeps instead of blocking animation evaluation.
+ *  Results are handed back to each attacker at a fixed point of the next frame, in request order,
+ *  so hit resolution stays deterministic.
+ */
+UCLASS()
+class UCombatMeleeQuerySubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+	/** A query and the async trace handle it was dispatched with */
+	struct FDispatchedQuery
+	{
+		FCombatMeleeQuery Query;
+		FTraceHandle Handle;
+	};
+
+	/** Queries requested this frame that have not been dispatched yet */
+	TArray<FCombatMeleeQuery> PendingQueries;
+
+	/** Queries dispatched last frame, waiting for their results */
+	TArray<FDispatchedQuery> InFlightQueries;
+
+public:
+
+	/** Returns the subsystem for the provided world, if any */
+	static UCombatMeleeQuerySubsystem* Get(const UWorld* World);
+
+	/** Submits a melee query. Depending on configuration it will be resolved right away or batched */
+	void SubmitQuery(const FCombatMeleeQuery& Query);
+
+	/** Returns the number of queries waiting to be dispatched or resolved */
+	int32 GetNumQueuedQueries() const { return PendingQueries.Num() + InFlightQueries.Num(); }
+
+public:
+
+	// ~begin FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	// ~end FTickableGameObject interface
+
+protected:
+
+	/** Only create this subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Cleanup */
+	virtual void Deinitialize() override;
+
+	/** Resolves the queries dispatched last frame, in order */
+	void ResolveInFlightQueries();
+
+	/** Dispatches this frame's queries as async sweeps */
+	void DispatchPendingQueries();
+
+	/** Runs a query synchronously */
+	void RunQueryImmediate(const FCombatMeleeQuery& Query, TArray<FHitResult>& OutHits) const;
+
+	/** Hands the sweep results back to the attacker */
+	void ResolveQuery(const FCombatMeleeQuery& Query, const TArray<FHitResult>& Hits) const;
+
+	/** Builds the collision query params shared by sync and async sweeps */
+	static FCollisionQueryParams MakeQueryParams(const FCombatMeleeQuery& Query);
+};
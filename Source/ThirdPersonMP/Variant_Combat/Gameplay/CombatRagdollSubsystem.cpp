@@ -0,0 +1,251 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "CombatRagdollSubsystem.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Components/CapsuleComponent.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "TPSPlayerCacheSubsystem.h"
+#include "ThirdPersonMP.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Active Ragdolls"), STAT_CombatActiveRagdolls, STATGROUP_ThirdPersonMP);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Ragdolls Put To Sleep"), STAT_CombatRagdollsSlept, STATGROUP_ThirdPersonMP);
+
+namespace CombatRagdoll
+{
+	static int32 MaxActiveRagdolls = 8;
+	static FAutoConsoleVariableRef CVarMaxActiveRagdolls(
+		TEXT("TPS.Combat.MaxActiveRagdolls"),
+		MaxActiveRagdolls,
+		TEXT("Maximum number of skeletal meshes simulating ragdoll physics at the same time."));
+
+	static float MaxRagdollTime = 5.0f;
+	static FAutoConsoleVariableRef CVarMaxRagdollTime(
+		TEXT("TPS.Combat.MaxRagdollTime"),
+		MaxRagdollTime,
+		TEXT("Time after which a ragdoll is put to sleep regardless of the budget, in seconds. 0 disables the limit."));
+
+	static float AgeWeight = 0.5f;
+	static FAutoConsoleVariableRef CVarAgeWeight(
+		TEXT("TPS.Combat.RagdollAgeWeight"),
+		AgeWeight,
+		TEXT("How quickly a ragdoll loses significance as it ages. Higher values favor evicting older ragdolls over distant ones."));
+
+	static float ServerKnockbackTime = 1.0f;
+	static FAutoConsoleVariableRef CVarServerKnockbackTime(
+		TEXT("TPS.Combat.ServerKnockbackTime"),
+		ServerKnockbackTime,
+		TEXT("Time a dead character's capsule keeps moving on dedicated servers, in place of the ragdoll, in seconds. Extended while it's still falling. 0 disables the knockback."));
+}
+
+UCombatRagdollSubsystem* UCombatRagdollSubsystem::Get(const UWorld* World)
+{
+	return World ? World->GetSubsystem<UCombatRagdollSubsystem>() : nullptr;
+}
+
+bool UCombatRagdollSubsystem::RequestRagdoll(USkeletalMeshComponent* Mesh)
+{
+	if (!Mesh || !AreRagdollsEnabled())
+	{
+		return false;
+	}
+
+	// make room by putting the least significant ragdoll to sleep
+	const double CurrentTime = GetWorld()->GetTimeSeconds();
+
+	while (!ActiveRagdolls.IsEmpty() && ActiveRagdolls.Num() >= FMath::Max(1, CombatRagdoll::MaxActiveRagdolls))
+	{
+		int32 EvictIndex = 0;
+		float LowestSignificance = TNumericLimits<float>::Max();
+
+		for (int32 i = 0; i < ActiveRagdolls.Num(); ++i)
+		{
+			const float Significance = GetSignificance(ActiveRagdolls[i], CurrentTime);
+
+			if (Significance < LowestSignificance)
+			{
+				LowestSignificance = Significance;
+				EvictIndex = i;
+			}
+		}
+
+		SleepRagdoll(EvictIndex);
+	}
+
+	// enable full ragdoll physics
+	Mesh->SetSimulatePhysics(true);
+
+	FActiveRagdoll& NewRagdoll = ActiveRagdolls.AddDefaulted_GetRef();
+	NewRagdoll.Mesh = Mesh;
+	NewRagdoll.StartTime = CurrentTime;
+
+	SET_DWORD_STAT(STAT_CombatActiveRagdolls, ActiveRagdolls.Num());
+
+	return true;
+}
+
+bool UCombatRagdollSubsystem::RequestCapsuleKnockback(ACharacter* Character, bool bDisableCollision)
+{
+	// only dedicated servers replace the ragdoll with a knockback
+	if (!Character || GetWorld()->GetNetMode() != NM_DedicatedServer || CombatRagdoll::ServerKnockbackTime <= 0.0f)
+	{
+		return false;
+	}
+
+	CancelCapsuleKnockback(Character);
+
+	FCapsuleKnockback& NewKnockback = CapsuleKnockbacks.AddDefaulted_GetRef();
+	NewKnockback.Character = Character;
+	NewKnockback.StartTime = GetWorld()->GetTimeSeconds();
+	NewKnockback.bDisableCollision = bDisableCollision;
+
+	return true;
+}
+
+void UCombatRagdollSubsystem::CancelCapsuleKnockback(ACharacter* Character)
+{
+	CapsuleKnockbacks.RemoveAllSwap([Character](const FCapsuleKnockback& Knockback) { return Knockback.Character == Character; }, EAllowShrinking::No);
+}
+
+bool UCombatRagdollSubsystem::CanPlayHitReaction() const
+{
+	// skip hit reactions when ragdolls are off or the budget is already full
+	return AreRagdollsEnabled() && ActiveRagdolls.Num() < CombatRagdoll::MaxActiveRagdolls;
+}
+
+void UCombatRagdollSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	// stop counting ragdolls that were destroyed, reset or have come to rest
+	ActiveRagdolls.RemoveAllSwap([](const FActiveRagdoll& Ragdoll)
+	{
+		const USkeletalMeshComponent* Mesh = Ragdoll.Mesh.Get();
+		return !Mesh || !Mesh->IsSimulatingPhysics() || !Mesh->RigidBodyIsAwake();
+
+	}, EAllowShrinking::No);
+
+	// put ragdolls that have been simulating for too long to sleep
+	if (CombatRagdoll::MaxRagdollTime > 0.0f)
+	{
+		const double CurrentTime = GetWorld()->GetTimeSeconds();
+
+		for (int32 i = ActiveRagdolls.Num() - 1; i >= 0; --i)
+		{
+			if (CurrentTime - ActiveRagdolls[i].StartTime > CombatRagdoll::MaxRagdollTime)
+			{
+				SleepRagdoll(i);
+			}
+		}
+	}
+
+	SET_DWORD_STAT(STAT_CombatActiveRagdolls, ActiveRagdolls.Num());
+
+	// stop the capsule knockbacks that have run their course, letting the ones still in the air land first
+	const double KnockbackTime = GetWorld()->GetTimeSeconds();
+
+	for (int32 i = CapsuleKnockbacks.Num() - 1; i >= 0; --i)
+	{
+		const ACharacter* Character = CapsuleKnockbacks[i].Character.Get();
+		const float Age = static_cast<float>(KnockbackTime - CapsuleKnockbacks[i].StartTime);
+
+		if (!Character || (Age >= CombatRagdoll::ServerKnockbackTime && (!Character->GetCharacterMovement()->IsFalling() || Age >= CombatRagdoll::ServerKnockbackTime * 3.0f)))
+		{
+			EndCapsuleKnockback(i);
+		}
+	}
+}
+
+TStatId UCombatRagdollSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCombatRagdollSubsystem, STATGROUP_Tickables);
+}
+
+bool UCombatRagdollSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UCombatRagdollSubsystem::Deinitialize()
+{
+	ActiveRagdolls.Reset();
+	CapsuleKnockbacks.Reset();
+
+	Super::Deinitialize();
+}
+
+bool UCombatRagdollSubsystem::AreRagdollsEnabled() const
+{
+	// ragdolls are cosmetic, so dedicated servers don't need to simulate them
+	return GetWorld()->GetNetMode() != NM_DedicatedServer && CombatRagdoll::MaxActiveRagdolls > 0;
+}
+
+float UCombatRagdollSubsystem::GetSignificance(const FActiveRagdoll& Ragdoll, double CurrentTime) const
+{
+	const USkeletalMeshComponent* Mesh = Ragdoll.Mesh.Get();
+
+	if (!Mesh)
+	{
+		return 0.0f;
+	}
+
+	const FVector Location = Mesh->Bounds.Origin;
+	const float Radius = Mesh->Bounds.SphereRadius;
+
+	// approximate the screen size as the bounds radius over the distance to the closest player view
+	float ScreenSize = 0.0f;
+
+	if (UTPSPlayerCacheSubsystem* PlayerCache = UTPSPlayerCacheSubsystem::Get(GetWorld()))
+	{
+		for (const FTPSCachedPlayer& Player : PlayerCache->GetPlayers())
+		{
+			const FVector ToRagdoll = Location - Player.ViewLocation;
+			const float Distance = FMath::Max(ToRagdoll.Size(), 1.0f);
+
+			float PlayerScreenSize = Radius / Distance;
+
+			// ragdolls behind the player matter less
+			if ((ToRagdoll | Player.ViewDirection) < 0.0f)
+			{
+				PlayerScreenSize *= 0.25f;
+			}
+
+			ScreenSize = FMath::Max(ScreenSize, PlayerScreenSize);
+		}
+	}
+
+	// older ragdolls lose significance
+	const float Age = static_cast<float>(CurrentTime - Ragdoll.StartTime);
+
+	return ScreenSize / (1.0f + Age * CombatRagdoll::AgeWeight);
+}
+
+void UCombatRagdollSubsystem::SleepRagdoll(int32 Index)
+{
+	// sleeping bodies hold their pose and stop costing simulation time
+	if (USkeletalMeshComponent* Mesh = ActiveRagdolls[Index].Mesh.Get())
+	{
+		Mesh->PutAllRigidBodiesToSleep();
+		INC_DWORD_STAT(STAT_CombatRagdollsSlept);
+	}
+
+	ActiveRagdolls.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+}
+
+void UCombatRagdollSubsystem::EndCapsuleKnockback(int32 Index)
+{
+	if (ACharacter* Character = CapsuleKnockbacks[Index].Character.Get())
+	{
+		Character->GetCharacterMovement()->DisableMovement();
+
+		if (CapsuleKnockbacks[Index].bDisableCollision)
+		{
+			Character->GetCapsuleComponent()->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		}
+	}
+
+	CapsuleKnockbacks.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+}
@@ -0,0 +1,99 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CombatRagdollSubsystem.generated.h"
+
+class USkeletalMeshComponent;
+class ACharacter;
+
+/**
+ *  Caps the number of skeletal meshes simulating ragdoll physics at the same time.
+ *  When the budget is full, the least significant ragdoll is put to sleep to make room, ranked by its
+ *  approximate screen size to the nearest player and how long it has been simulating.
+ *  Ragdolls are purely cosmetic, so dedicated servers skip them and knock the dead character's capsule back instead,
+ *  disabling its movement once the knockback is over.
+ */
+UCLASS()
+class UCombatRagdollSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+	/** A ragdoll counted against the budget */
+	struct FActiveRagdoll
+	{
+		/** Simulating mesh */
+		TWeakObjectPtr<USkeletalMeshComponent> Mesh;
+
+		/** World time the ragdoll started simulating */
+		double StartTime = 0.0;
+	};
+
+	/** Ragdolls currently counted against the budget */
+	TArray<FActiveRagdoll> ActiveRagdolls;
+
+	/** A dead character whose capsule is being knocked back in place of a ragdoll */
+	struct FCapsuleKnockback
+	{
+		/** Character being knocked back */
+		TWeakObjectPtr<ACharacter> Character;
+
+		/** World time the knockback started */
+		double StartTime = 0.0;
+
+		/** If true, the capsule's collision is disabled once the knockback is over */
+		bool bDisableCollision = false;
+	};
+
+	/** Capsule knockbacks in progress */
+	TArray<FCapsuleKnockback> CapsuleKnockbacks;
+
+public:
+
+	/** Returns the subsystem for the provided world, if any */
+	static UCombatRagdollSubsystem* Get(const UWorld* World);
+
+	/** Enables full ragdoll physics on a mesh, putting older ragdolls to sleep if needed. Returns false if ragdolls are disabled */
+	bool RequestRagdoll(USkeletalMeshComponent* Mesh);
+
+	/** Keeps a dying character's movement enabled on dedicated servers so the death blow's impulse moves its capsule. Returns false if the character should stop moving right away */
+	bool RequestCapsuleKnockback(ACharacter* Character, bool bDisableCollision);
+
+	/** Stops tracking a capsule knockback without ending it, e.g. when the character is reset */
+	void CancelCapsuleKnockback(ACharacter* Character);
+
+	/** Returns true if partial physics hit reactions can be blended in */
+	bool CanPlayHitReaction() const;
+
+	/** Returns the number of ragdolls currently counted against the budget */
+	int32 GetNumActiveRagdolls() const { return ActiveRagdolls.Num(); }
+
+public:
+
+	// ~begin FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	// ~end FTickableGameObject interface
+
+protected:
+
+	/** Only create this subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Cleanup */
+	virtual void Deinitialize() override;
+
+	/** Returns true if ragdolls should be simulated in this world */
+	bool AreRagdollsEnabled() const;
+
+	/** Returns the significance of a ragdoll. Lower values are evicted first */
+	float GetSignificance(const FActiveRagdoll& Ragdoll, double CurrentTime) const;
+
+	/** Puts a ragdoll to sleep and stops counting it against the budget */
+	void SleepRagdoll(int32 Index);
+
+	/** Disables a knocked back character's movement and stops tracking it */
+	void EndCapsuleKnockback(int32 Index);
+};
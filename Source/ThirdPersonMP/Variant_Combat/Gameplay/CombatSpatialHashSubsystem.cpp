@@ -0,0 +1,579 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "CombatSpatialHashSubsystem.h"
+#include "CombatDamageable.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+#include "Components/SphereComponent.h"
+#include "HAL/IConsoleManager.h"
+#include "TimerManager.h"
+#include "ThirdPersonMP.h"
+
+namespace CombatSpatialHash
+{
+	static float CellSize = 500.0f;
+	static FAutoConsoleVariableRef CVarCellSize(
+		TEXT("TPS.Combat.SpatialHashCellSize"),
+		CellSize,
+		TEXT("Size of a combat spatial hash cell, in cm. Only applies to worlds created after it changes."));
+
+	/** Upper bound on the number of cells a single query will visit before falling back to a linear scan */
+	static constexpr int32 MaxCellsPerQuery = 512;
+
+	/** Radius of the spheres used by the benchmark actors */
+	static constexpr float BenchmarkActorRadius = 40.0f;
+
+	/** Half size of the area the benchmark actors are scattered in */
+	static constexpr float BenchmarkExtent = 5000.0f;
+
+	/** Length and radius of the benchmark sweeps. Matches the default danger notification sweep */
+	static constexpr float BenchmarkSweepLength = 300.0f;
+	static constexpr float BenchmarkSweepRadius = 100.0f;
+
+	static FAutoConsoleCommandWithWorldAndArgs BenchmarkCommand(
+		TEXT("TPS.Combat.BenchSpatialHash"),
+		TEXT("Compares combat spatial hash sweeps against SweepMultiByObjectType at 10, 100 and 1000 actors.\n")
+		TEXT("Usage: TPS.Combat.BenchSpatialHash [NumQueries=1000]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			if (UCombatSpatialHashSubsystem* SpatialHash = UCombatSpatialHashSubsystem::Get(World))
+			{
+				const int32 NumQueries = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 1000;
+
+				// center the test on the first player, if we have one
+				FVector Origin = FVector::ZeroVector;
+
+				if (APlayerController* PC = World->GetFirstPlayerController())
+				{
+					if (APawn* Pawn = PC->GetPawn())
+					{
+						Origin = Pawn->GetActorLocation();
+					}
+				}
+
+				SpatialHash->RunBenchmark(Origin, { 10, 100, 1000 }, NumQueries);
+			}
+		}));
+}
+
+UCombatSpatialHashSubsystem* UCombatSpatialHashSubsystem::Get(const UWorld* World)
+{
+	return World ? World->GetSubsystem<UCombatSpatialHashSubsystem>() : nullptr;
+}
+
+void UCombatSpatialHashSubsystem::RegisterActor(AActor* Actor)
+{
+	if (!IsValid(Actor) || EntryIndices.Contains(Actor))
+	{
+		return;
+	}
+
+	FEntry NewEntry;
+	NewEntry.Actor = Actor;
+	NewEntry.Location = Actor->GetActorLocation();
+	NewEntry.Cell = GetCell(NewEntry.Location);
+	NewEntry.bIsPawn = Actor->IsA<APawn>();
+	Actor->GetSimpleCollisionCylinder(NewEntry.Radius, NewEntry.HalfHeight);
+
+	const int32 EntryIndex = Entries.Add(NewEntry);
+	EntryIndices.Add(Actor, EntryIndex);
+	Cells.FindOrAdd(NewEntry.Cell).Add(EntryIndex);
+
+	// stop tracking the actor once it leaves play
+	Actor->OnEndPlay.AddUniqueDynamic(this, &UCombatSpatialHashSubsystem::OnActorEndPlay);
+}
+
+void UCombatSpatialHashSubsystem::UnregisterActor(AActor* Actor)
+{
+	int32 EntryIndex = INDEX_NONE;
+
+	if (EntryIndices.RemoveAndCopyValue(Actor, EntryIndex))
+	{
+		RemoveEntry(EntryIndex);
+
+		if (IsValid(Actor))
+		{
+			Actor->OnEndPlay.RemoveDynamic(this, &UCombatSpatialHashSubsystem::OnActorEndPlay);
+		}
+	}
+}
+
+void UCombatSpatialHashSubsystem::QueryRadius(const FVector& Center, float Radius, const FCombatSpatialQueryFilter& Filter, TArray<AActor*>& OutActors) const
+{
+	// sweep with a zero length segment
+	QueryCapsuleSweep(Center, Center, Radius, Filter, OutActors);
+}
+
+void UCombatSpatialHashSubsystem::QueryCapsuleSweep(const FVector& Start, const FVector& End, float Radius, const FCombatSpatialQueryFilter& Filter, TArray<AActor*>& OutActors) const
+{
+	OutActors.Reset();
+
+	TArray<TPair<double, AActor*>> Hits;
+
+	FBox Bounds(ForceInit);
+	Bounds += Start;
+	Bounds += End;
+
+	ForEachEntryInBounds(Bounds.ExpandBy(Radius), [&](int32 EntryIndex, const FEntry& Entry)
+	{
+		if (!PassesFilter(Entry, Filter))
+		{
+			return;
+		}
+
+		// find the closest point along the sweep
+		const FVector ClosestPoint = FMath::ClosestPointOnSegment(Entry.Location, Start, End);
+		const FVector Delta = Entry.Location - ClosestPoint;
+
+		// test the swept sphere against the actor's collision cylinder
+		if (Delta.SizeSquared2D() <= FMath::Square(Radius + Entry.Radius) && FMath::Abs(Delta.Z) <= Radius + Entry.HalfHeight)
+		{
+			Hits.Emplace(FVector::DistSquared(Start, ClosestPoint) + Delta.SizeSquared(), Entry.Actor.Get());
+		}
+	});
+
+	// sort by distance along the sweep, same as a physics sweep would
+	Hits.Sort([](const TPair<double, AActor*>& A, const TPair<double, AActor*>& B) { return A.Key < B.Key; });
+
+	OutActors.Reserve(Hits.Num());
+
+	for (const TPair<double, AActor*>& Hit : Hits)
+	{
+		OutActors.Add(Hit.Value);
+	}
+}
+
+void UCombatSpatialHashSubsystem::QueryCone(const FVector& Origin, const FVector& Direction, float Length, float HalfAngleDegrees, const FCombatSpatialQueryFilter& Filter, TArray<AActor*>& OutActors) const
+{
+	OutActors.Reset();
+
+	TArray<TPair<double, AActor*>> Hits;
+
+	const FVector ConeDirection = Direction.GetSafeNormal();
+	const double CosHalfAngle = FMath::Cos(FMath::DegreesToRadians(HalfAngleDegrees));
+
+	ForEachEntryInBounds(FBox::BuildAABB(Origin, FVector(Length)), [&](int32 EntryIndex, const FEntry& Entry)
+	{
+		if (!PassesFilter(Entry, Filter))
+		{
+			return;
+		}
+
+		const FVector Delta = Entry.Location - Origin;
+		const double DistSquared = Delta.SizeSquared();
+
+		// check the cone length
+		if (DistSquared > FMath::Square(Length + Entry.Radius))
+		{
+			return;
+		}
+
+		// check the cone angle. Actors right at the origin are always inside
+		if (DistSquared > UE_KINDA_SMALL_NUMBER && (Delta / FMath::Sqrt(DistSquared) | ConeDirection) < CosHalfAngle)
+		{
+			return;
+		}
+
+		Hits.Emplace(DistSquared, Entry.Actor.Get());
+	});
+
+	// sort by distance to the origin
+	Hits.Sort([](const TPair<double, AActor*>& A, const TPair<double, AActor*>& B) { return A.Key < B.Key; });
+
+	OutActors.Reserve(Hits.Num());
+
+	for (const TPair<double, AActor*>& Hit : Hits)
+	{
+		OutActors.Add(Hit.Value);
+	}
+}
+
+AActor* UCombatSpatialHashSubsystem::FindNearest(const FVector& Origin, float MaxRadius, const FCombatSpatialQueryFilter& Filter) const
+{
+	AActor* Nearest = nullptr;
+	int32 NearestIndex = INDEX_NONE;
+	double NearestDistSquared = FMath::Square(MaxRadius);
+
+	ForEachEntryInBounds(FBox::BuildAABB(Origin, FVector(MaxRadius)), [&](int32 EntryIndex, const FEntry& Entry)
+	{
+		if (!PassesFilter(Entry, Filter))
+		{
+			return;
+		}
+
+		const double DistSquared = FVector::DistSquared(Origin, Entry.Location);
+
+		// break ties on entry index so the result doesn't depend on cell iteration order
+		if (DistSquared < NearestDistSquared || (Nearest && DistSquared == NearestDistSquared && EntryIndex < NearestIndex))
+		{
+			Nearest = Entry.Actor.Get();
+			NearestIndex = EntryIndex;
+			NearestDistSquared = DistSquared;
+		}
+	});
+
+	return Nearest;
+}
+
+void UCombatSpatialHashSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	// re-bin any actors that moved into a different cell
+	for (auto It = Entries.CreateIterator(); It; ++It)
+	{
+		FEntry& Entry = *It;
+		const AActor* Actor = Entry.Actor.Get();
+
+		// drop actors that went away without ending play
+		if (!Actor)
+		{
+			const int32 EntryIndex = It.GetIndex();
+
+			for (auto IndexIt = EntryIndices.CreateIterator(); IndexIt; ++IndexIt)
+			{
+				if (IndexIt.Value() == EntryIndex)
+				{
+					IndexIt.RemoveCurrent();
+					break;
+				}
+			}
+
+			RemoveEntry(EntryIndex);
+			continue;
+		}
+
+		Entry.Location = Actor->GetActorLocation();
+
+		const FIntVector NewCell = GetCell(Entry.Location);
+
+		if (NewCell != Entry.Cell)
+		{
+			MoveEntry(It.GetIndex(), NewCell);
+		}
+	}
+}
+
+TStatId UCombatSpatialHashSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCombatSpatialHashSubsystem, STATGROUP_Tickables);
+}
+
+bool UCombatSpatialHashSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UCombatSpatialHashSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	// latch the cell size
+	CellSize = FMath::Max(CombatSpatialHash::CellSize, 50.0f);
+
+	// track damageable actors as they're spawned
+	ActorSpawnedHandle = GetWorld()->AddOnActorSpawnedHandler(FOnActorSpawned::FDelegate::CreateUObject(this, &UCombatSpatialHashSubsystem::OnActorSpawned));
+}
+
+void UCombatSpatialHashSubsystem::Deinitialize()
+{
+	GetWorld()->RemoveOnActorSpawnedHandler(ActorSpawnedHandle);
+
+	DestroyBenchmarkActors();
+	PendingBenchmarkCounts.Reset();
+
+	Entries.Reset();
+	EntryIndices.Reset();
+	Cells.Reset();
+
+	Super::Deinitialize();
+}
+
+void UCombatSpatialHashSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	// register all damageable actors already in the level
+	for (TActorIterator<AActor> It(&InWorld); It; ++It)
+	{
+		if (It->Implements<UCombatDamageable>())
+		{
+			RegisterActor(*It);
+		}
+	}
+}
+
+void UCombatSpatialHashSubsystem::OnActorSpawned(AActor* Actor)
+{
+	if (Actor && Actor->Implements<UCombatDamageable>())
+	{
+		RegisterActor(Actor);
+	}
+}
+
+void UCombatSpatialHashSubsystem::OnActorEndPlay(AActor* Actor, EEndPlayReason::Type EndPlayReason)
+{
+	UnregisterActor(Actor);
+}
+
+FIntVector UCombatSpatialHashSubsystem::GetCell(const FVector& Location) const
+{
+	return FIntVector(
+		FMath::FloorToInt32(Location.X / CellSize),
+		FMath::FloorToInt32(Location.Y / CellSize),
+		FMath::FloorToInt32(Location.Z / CellSize));
+}
+
+void UCombatSpatialHashSubsystem::MoveEntry(int32 EntryIndex, const FIntVector& NewCell)
+{
+	FEntry& Entry = Entries[EntryIndex];
+
+	// remove from the old cell, releasing it if it's now empty
+	if (TArray<int32>* OldCell = Cells.Find(Entry.Cell))
+	{
+		OldCell->RemoveSingleSwap(EntryIndex, EAllowShrinking::No);
+
+		if (OldCell->IsEmpty())
+		{
+			Cells.Remove(Entry.Cell);
+		}
+	}
+
+	// add to the new cell
+	Entry.Cell = NewCell;
+	Cells.FindOrAdd(NewCell).Add(EntryIndex);
+}
+
+void UCombatSpatialHashSubsystem::RemoveEntry(int32 EntryIndex)
+{
+	const FIntVector Cell = Entries[EntryIndex].Cell;
+
+	if (TArray<int32>* CellEntries = Cells.Find(Cell))
+	{
+		CellEntries->RemoveSingleSwap(EntryIndex, EAllowShrinking::No);
+
+		if (CellEntries->IsEmpty())
+		{
+			Cells.Remove(Cell);
+		}
+	}
+
+	Entries.RemoveAt(EntryIndex);
+}
+
+void UCombatSpatialHashSubsystem::ForEachEntryInBounds(const FBox& Bounds, TFunctionRef<void(int32 EntryIndex, const FEntry& Entry)> Visitor) const
+{
+	// pad the bounds so actors binned near a cell edge are still considered
+	const FIntVector MinCell = GetCell(Bounds.Min - FVector(CellSize * 0.5f));
+	const FIntVector MaxCell = GetCell(Bounds.Max + FVector(CellSize * 0.5f));
+
+	const int64 NumCells = int64(MaxCell.X - MinCell.X + 1) * int64(MaxCell.Y - MinCell.Y + 1) * int64(MaxCell.Z - MinCell.Z + 1);
+
+	// for very large queries, walking the occupied cells is cheaper than walking the bounds
+	if (NumCells > CombatSpatialHash::MaxCellsPerQuery || NumCells > Cells.Num())
+	{
+		for (const TPair<FIntVector, TArray<int32>>& Cell : Cells)
+		{
+			if (Cell.Key.X >= MinCell.X && Cell.Key.X <= MaxCell.X
+				&& Cell.Key.Y >= MinCell.Y && Cell.Key.Y <= MaxCell.Y
+				&& Cell.Key.Z >= MinCell.Z && Cell.Key.Z <= MaxCell.Z)
+			{
+				for (const int32 EntryIndex : Cell.Value)
+				{
+					Visitor(EntryIndex, Entries[EntryIndex]);
+				}
+			}
+		}
+
+		return;
+	}
+
+	for (int32 Z = MinCell.Z; Z <= MaxCell.Z; ++Z)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+		{
+			for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+			{
+				if (const TArray<int32>* CellEntries = Cells.Find(FIntVector(X, Y, Z)))
+				{
+					for (const int32 EntryIndex : *CellEntries)
+					{
+						Visitor(EntryIndex, Entries[EntryIndex]);
+					}
+				}
+			}
+		}
+	}
+}
+
+bool UCombatSpatialHashSubsystem::PassesFilter(const FEntry& Entry, const FCombatSpatialQueryFilter& Filter)
+{
+	const AActor* Actor = Entry.Actor.Get();
+
+	if (!Actor || Actor == Filter.IgnoredActor)
+	{
+		return false;
+	}
+
+	if (Filter.bPawnsOnly && !Entry.bIsPawn)
+	{
+		return false;
+	}
+
+	return Filter.RequiredTag.IsNone() || Actor->ActorHasTag(Filter.RequiredTag);
+}
+
+void UCombatSpatialHashSubsystem::RunBenchmark(const FVector& Origin, const TArray<int32>& ActorCounts, int32 NumQueries)
+{
+	// ignore the request if a benchmark is already running
+	if (!PendingBenchmarkCounts.IsEmpty() || !BenchmarkActors.IsEmpty())
+	{
+		UE_LOG(LogThirdPersonMP, Warning, TEXT("Combat spatial hash benchmark already running."));
+		return;
+	}
+
+	BenchmarkOrigin = Origin;
+	BenchmarkNumQueries = NumQueries;
+	PendingBenchmarkCounts = ActorCounts;
+
+	StepBenchmark();
+}
+
+void UCombatSpatialHashSubsystem::StepBenchmark()
+{
+	// time the actors spawned last frame, now that physics has picked them up
+	if (!BenchmarkActors.IsEmpty())
+	{
+		RunBenchmarkPass();
+		DestroyBenchmarkActors();
+	}
+
+	if (PendingBenchmarkCounts.IsEmpty())
+	{
+		return;
+	}
+
+	SpawnBenchmarkActors(PendingBenchmarkCounts[0]);
+	PendingBenchmarkCounts.RemoveAt(0);
+
+	GetWorld()->GetTimerManager().SetTimerForNextTick(this, &UCombatSpatialHashSubsystem::StepBenchmark);
+}
+
+void UCombatSpatialHashSubsystem::RunBenchmarkPass()
+{
+	UWorld* World = GetWorld();
+
+	// use a fixed seed so both methods run the same queries
+	FRandomStream Stream(BenchmarkActors.Num());
+
+	TArray<FVector> Starts;
+	TArray<FVector> Ends;
+	Starts.Reserve(BenchmarkNumQueries);
+	Ends.Reserve(BenchmarkNumQueries);
+
+	for (int32 i = 0; i < BenchmarkNumQueries; ++i)
+	{
+		const FVector Start = BenchmarkOrigin + FVector(Stream.FRandRange(-CombatSpatialHash::BenchmarkExtent, CombatSpatialHash::BenchmarkExtent), Stream.FRandRange(-CombatSpatialHash::BenchmarkExtent, CombatSpatialHash::BenchmarkExtent), 0.0f);
+		const FVector Direction = FVector(Stream.FRandRange(-1.0f, 1.0f), Stream.FRandRange(-1.0f, 1.0f), 0.0f).GetSafeNormal();
+
+		Starts.Add(Start);
+		Ends.Add(Start + Direction * CombatSpatialHash::BenchmarkSweepLength);
+	}
+
+	// time the physics sweeps
+	FCollisionObjectQueryParams ObjectParams;
+	ObjectParams.AddObjectTypesToQuery(ECC_Pawn);
+
+	const FCollisionShape CollisionShape = FCollisionShape::MakeSphere(CombatSpatialHash::BenchmarkSweepRadius);
+
+	TArray<FHitResult> OutHits;
+	int32 PhysicsHits = 0;
+
+	const double PhysicsStartTime = FPlatformTime::Seconds();
+
+	for (int32 i = 0; i < BenchmarkNumQueries; ++i)
+	{
+		World->SweepMultiByObjectType(OutHits, Starts[i], Ends[i], FQuat::Identity, ObjectParams, CollisionShape);
+		PhysicsHits += OutHits.Num();
+	}
+
+	const double PhysicsTime = FPlatformTime::Seconds() - PhysicsStartTime;
+
+	// time the spatial hash sweeps
+	const FCombatSpatialQueryFilter Filter;
+
+	TArray<AActor*> OutActors;
+	int32 HashHits = 0;
+
+	const double HashStartTime = FPlatformTime::Seconds();
+
+	for (int32 i = 0; i < BenchmarkNumQueries; ++i)
+	{
+		QueryCapsuleSweep(Starts[i], Ends[i], CombatSpatialHash::BenchmarkSweepRadius, Filter, OutActors);
+		HashHits += OutActors.Num();
+	}
+
+	const double HashTime = FPlatformTime::Seconds() - HashStartTime;
+
+	UE_LOG(LogThirdPersonMP, Log, TEXT("Combat spatial hash benchmark: %d actors, %d queries. SweepMultiByObjectType: %.2f us/query (%d hits). Spatial hash: %.2f us/query (%d hits)."),
+		BenchmarkActors.Num(),
+		BenchmarkNumQueries,
+		PhysicsTime * 1000000.0 / BenchmarkNumQueries,
+		PhysicsHits,
+		HashTime * 1000000.0 / BenchmarkNumQueries,
+		HashHits);
+}
+
+void UCombatSpatialHashSubsystem::SpawnBenchmarkActors(int32 Count)
+{
+	UWorld* World = GetWorld();
+
+	FRandomStream Stream(Count);
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	BenchmarkActors.Reserve(Count);
+
+	for (int32 i = 0; i < Count; ++i)
+	{
+		const FVector Location = BenchmarkOrigin + FVector(Stream.FRandRange(-CombatSpatialHash::BenchmarkExtent, CombatSpatialHash::BenchmarkExtent), Stream.FRandRange(-CombatSpatialHash::BenchmarkExtent, CombatSpatialHash::BenchmarkExtent), 0.0f);
+
+		AActor* Actor = World->SpawnActor<AActor>(AActor::StaticClass(), FTransform(Location), SpawnParams);
+
+		if (!Actor)
+		{
+			continue;
+		}
+
+		// give the actor a query-only pawn collision sphere so both methods see it
+		USphereComponent* Sphere = NewObject<USphereComponent>(Actor);
+		Sphere->SetSphereRadius(CombatSpatialHash::BenchmarkActorRadius);
+		Sphere->SetCollisionObjectType(ECC_Pawn);
+		Sphere->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
+		Sphere->SetCollisionResponseToAllChannels(ECR_Overlap);
+		Actor->SetRootComponent(Sphere);
+		Sphere->RegisterComponent();
+		Sphere->SetWorldLocation(Location);
+
+		RegisterActor(Actor);
+		BenchmarkActors.Add(Actor);
+	}
+}
+
+void UCombatSpatialHashSubsystem::DestroyBenchmarkActors()
+{
+	for (const TWeakObjectPtr<AActor>& Actor : BenchmarkActors)
+	{
+		if (Actor.IsValid())
+		{
+			UnregisterActor(Actor.Get());
+			Actor->Destroy();
+		}
+	}
+
+	BenchmarkActors.Reset();
+}
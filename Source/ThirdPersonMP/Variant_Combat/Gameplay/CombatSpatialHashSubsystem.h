@@ -0,0 +1,169 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Containers/SparseArray.h"
+#include "UObject/ObjectKey.h"
+#include "CombatSpatialHashSubsystem.generated.h"
+
+/**
+ *  Filters applied to spatial hash query results
+ */
+struct FCombatSpatialQueryFilter
+{
+	/** If set, only actors with this tag will be returned */
+	FName RequiredTag = NAME_None;
+
+	/** Actor to skip, usually the one running the query */
+	const AActor* IgnoredActor = nullptr;
+
+	/** If true, only pawns will be returned */
+	bool bPawnsOnly = false;
+};
+
+/**
+ *  Keeps a uniform grid spatial hash of all ICombatDamageable actors in the world.
+ *  Actors are registered automatically as they're spawned and re-binned incrementally as they move,
+ *  so danger notifications and target lookups can avoid going through the physics scene.
+ *  Query results are sorted by distance so they come out in a deterministic order.
+ */
+UCLASS()
+class UCombatSpatialHashSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+	/** A single actor tracked by the hash */
+	struct FEntry
+	{
+		/** Tracked actor */
+		TWeakObjectPtr<AActor> Actor;
+
+		/** Location the actor was last binned at */
+		FVector Location = FVector::ZeroVector;
+
+		/** Radius of the actor's simple collision cylinder, used to pad the queries */
+		float Radius = 0.0f;
+
+		/** Half height of the actor's simple collision cylinder, used to pad the queries */
+		float HalfHeight = 0.0f;
+
+		/** Cell the actor is currently binned in */
+		FIntVector Cell = FIntVector::ZeroValue;
+
+		/** Cached so pawn filtering doesn't need a cast */
+		bool bIsPawn = false;
+	};
+
+	/** Tracked actors. Sparse so entry indices stay stable as actors come and go */
+	TSparseArray<FEntry> Entries;
+
+	/** Maps each tracked actor to its entry index */
+	TMap<TObjectKey<AActor>, int32> EntryIndices;
+
+	/** Maps each occupied cell to the entries binned in it */
+	TMap<FIntVector, TArray<int32>> Cells;
+
+	/** Size of a grid cell, latched on initialization so cells stay consistent */
+	float CellSize = 500.0f;
+
+	/** Handle for the actor spawned delegate */
+	FDelegateHandle ActorSpawnedHandle;
+
+	/** Actors spawned for the benchmark command */
+	TArray<TWeakObjectPtr<AActor>> BenchmarkActors;
+
+	/** Actor counts still to be benchmarked */
+	TArray<int32> PendingBenchmarkCounts;
+
+	/** Number of queries to run per benchmark pass */
+	int32 BenchmarkNumQueries = 0;
+
+	/** Center of the benchmark area */
+	FVector BenchmarkOrigin = FVector::ZeroVector;
+
+public:
+
+	/** Returns the subsystem for the provided world, if any */
+	static UCombatSpatialHashSubsystem* Get(const UWorld* World);
+
+	/** Starts tracking an actor. Damageable actors are registered automatically */
+	void RegisterActor(AActor* Actor);
+
+	/** Stops tracking an actor */
+	void UnregisterActor(AActor* Actor);
+
+	/** Returns the actors overlapping a sphere */
+	void QueryRadius(const FVector& Center, float Radius, const FCombatSpatialQueryFilter& Filter, TArray<AActor*>& OutActors) const;
+
+	/** Returns the actors touched by a sphere swept from Start to End, sorted by distance along the sweep */
+	void QueryCapsuleSweep(const FVector& Start, const FVector& End, float Radius, const FCombatSpatialQueryFilter& Filter, TArray<AActor*>& OutActors) const;
+
+	/** Returns the actors inside a cone, sorted by distance to the origin */
+	void QueryCone(const FVector& Origin, const FVector& Direction, float Length, float HalfAngleDegrees, const FCombatSpatialQueryFilter& Filter, TArray<AActor*>& OutActors) const;
+
+	/** Returns the closest actor within the given radius that passes the filter */
+	AActor* FindNearest(const FVector& Origin, float MaxRadius, const FCombatSpatialQueryFilter& Filter) const;
+
+	/** Returns the number of tracked actors */
+	int32 GetNumActors() const { return Entries.Num(); }
+
+	/** Spawns sets of test actors and compares hash queries against physics sweeps, one set per frame */
+	void RunBenchmark(const FVector& Origin, const TArray<int32>& ActorCounts, int32 NumQueries);
+
+public:
+
+	// ~begin FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	// ~end FTickableGameObject interface
+
+protected:
+
+	/** Only create this subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Initialization */
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	/** Cleanup */
+	virtual void Deinitialize() override;
+
+	/** Registers the damageable actors placed in the level */
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	/** Registers damageable actors as they're spawned */
+	void OnActorSpawned(AActor* Actor);
+
+	/** Unregisters actors as they leave play */
+	UFUNCTION()
+	void OnActorEndPlay(AActor* Actor, EEndPlayReason::Type EndPlayReason);
+
+	/** Returns the grid cell containing the location */
+	FIntVector GetCell(const FVector& Location) const;
+
+	/** Moves an entry to a new cell */
+	void MoveEntry(int32 EntryIndex, const FIntVector& NewCell);
+
+	/** Removes an entry from its cell and the entry list */
+	void RemoveEntry(int32 EntryIndex);
+
+	/** Calls the visitor for every entry in the cells overlapping the provided bounds */
+	void ForEachEntryInBounds(const FBox& Bounds, TFunctionRef<void(int32 EntryIndex, const FEntry& Entry)> Visitor) const;
+
+	/** Returns true if the entry passes the query filter */
+	static bool PassesFilter(const FEntry& Entry, const FCombatSpatialQueryFilter& Filter);
+
+	/** Times the pending benchmark pass and spawns the actors for the next one */
+	void StepBenchmark();
+
+	/** Runs one benchmark pass against the currently spawned benchmark actors */
+	void RunBenchmarkPass();
+
+	/** Spawns the benchmark actors */
+	void SpawnBenchmarkActors(int32 Count);
+
+	/** Destroys the benchmark actors */
+	void DestroyBenchmarkActors();
+};
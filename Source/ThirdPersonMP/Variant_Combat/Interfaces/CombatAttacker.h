@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "UObject/Interface.h"
+#include "Engine/HitResult.h"
 #include "CombatAttacker.generated.h"
 
 /**
@@ -33,4 +34,7 @@ public:
 	/** Performs a charged attack's check to loop the charge animation. Usually called from a montage's AnimNotify */
 	UFUNCTION(BlueprintCallable, Category="Attacker")
 	virtual void CheckChargedAttack() = 0;
+
+	/** Applies the results of an attack's collision check. Called once the melee query requested by DoAttackTrace resolves */
+	virtual void ResolveAttackTrace(const TArray<FHitResult>& Hits) = 0;
 };
@@ -0,0 +1,76 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "CombatHUD.h"
+#include "CombatLifeBarSubsystem.h"
+#include "Engine/Canvas.h"
+#include "GameFramework/Actor.h"
+#include "GameFramework/PlayerController.h"
+#include "Camera/PlayerCameraManager.h"
+#include "ThirdPersonMPStats.h"
+
+void ACombatHUD::DrawHUD()
+{
+	TPS_SCOPED_TIMER(DrawHUD, TPSUI);
+
+	Super::DrawHUD();
+
+	DrawLifeBars();
+}
+
+void ACombatHUD::DrawLifeBars()
+{
+	UCombatLifeBarSubsystem* LifeBars = UCombatLifeBarSubsystem::Get(GetWorld());
+
+	if (!LifeBars || !Canvas || !PlayerOwner || !PlayerOwner->PlayerCameraManager)
+	{
+		return;
+	}
+
+	const FVector CameraLocation = PlayerOwner->PlayerCameraManager->GetCameraLocation();
+	const double MaxDistSquared = FMath::Square(LifeBarDrawDistance);
+	const FVector2D HalfSize = LifeBarSize * 0.5f;
+
+	for (const FCombatLifeBar& Bar : LifeBars->GetBars())
+	{
+		const AActor* Owner = Bar.Owner.Get();
+
+		if (!Bar.bVisible || !Owner || Owner->IsHidden())
+		{
+			continue;
+		}
+
+		// cull by distance to the camera
+		const FVector BarLocation = Owner->GetActorLocation() + Bar.Offset;
+
+		if (FVector::DistSquared(CameraLocation, BarLocation) > MaxDistSquared)
+		{
+			continue;
+		}
+
+		// cull bars behind the camera
+		const FVector ScreenLocation = Project(BarLocation);
+
+		if (ScreenLocation.Z <= 0.0f)
+		{
+			continue;
+		}
+
+		const float Left = ScreenLocation.X - HalfSize.X;
+		const float Top = ScreenLocation.Y - HalfSize.Y;
+
+		// cull bars outside the viewport
+		if (Left + LifeBarSize.X < 0.0f || Left > Canvas->ClipX || Top + LifeBarSize.Y < 0.0f || Top > Canvas->ClipY)
+		{
+			continue;
+		}
+
+		// draw the background, then the fill on top
+		DrawRect(LifeBarBackgroundColor, Left - LifeBarBorder, Top - LifeBarBorder, LifeBarSize.X + LifeBarBorder * 2.0f, LifeBarSize.Y + LifeBarBorder * 2.0f);
+
+		if (Bar.Percent > 0.0f)
+		{
+			DrawRect(Bar.Color, Left, Top, LifeBarSize.X * Bar.Percent, LifeBarSize.Y);
+		}
+	}
+}
@@ -0,0 +1,44 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/HUD.h"
+#include "CombatHUD.generated.h"
+
+/**
+ *  HUD for the combat game.
+ *  Draws the overhead life bars of all combat characters in a single batched canvas pass,
+ *  culling the ones that are too far away or off-screen.
+ */
+UCLASS()
+class ACombatHUD : public AHUD
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Size of a life bar on screen */
+	UPROPERTY(EditAnywhere, Category="Life Bars", meta = (Units = "px"))
+	FVector2D LifeBarSize = FVector2D(80.0f, 8.0f);
+
+	/** Thickness of the life bar background border */
+	UPROPERTY(EditAnywhere, Category="Life Bars", meta = (ClampMin = 0, ClampMax = 10, Units = "px"))
+	float LifeBarBorder = 1.0f;
+
+	/** Color of the life bar background */
+	UPROPERTY(EditAnywhere, Category="Life Bars")
+	FLinearColor LifeBarBackgroundColor = FLinearColor(0.0f, 0.0f, 0.0f, 0.6f);
+
+	/** Life bars further away from the camera than this won't be drawn */
+	UPROPERTY(EditAnywhere, Category="Life Bars", meta = (ClampMin = 0, Units = "cm"))
+	float LifeBarDrawDistance = 3000.0f;
+
+protected:
+
+	/** Draws the HUD */
+	virtual void DrawHUD() override;
+
+	/** Draws all visible life bars */
+	void DrawLifeBars();
+};
@@ -0,0 +1,94 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "CombatLifeBarSubsystem.h"
+#include "Engine/World.h"
+
+UCombatLifeBarSubsystem* UCombatLifeBarSubsystem::Get(const UWorld* World)
+{
+	return World ? World->GetSubsystem<UCombatLifeBarSubsystem>() : nullptr;
+}
+
+void UCombatLifeBarSubsystem::RegisterBar(AActor* Owner, const FVector& Offset, const FLinearColor& Color)
+{
+	if (!Owner)
+	{
+		return;
+	}
+
+	FCombatLifeBar* Bar = FindBar(Owner);
+
+	if (!Bar)
+	{
+		BarIndices.Add(Owner, Bars.Num());
+
+		Bar = &Bars.AddDefaulted_GetRef();
+		Bar->Owner = Owner;
+		Bar->OwnerKey = Owner;
+	}
+
+	Bar->Offset = Offset;
+	Bar->Color = Color;
+}
+
+void UCombatLifeBarSubsystem::UnregisterBar(AActor* Owner)
+{
+	int32 Index = INDEX_NONE;
+
+	if (!BarIndices.RemoveAndCopyValue(Owner, Index))
+	{
+		return;
+	}
+
+	// swap the last bar into the hole and fix up its index
+	Bars.RemoveAtSwap(Index, EAllowShrinking::No);
+
+	if (Bars.IsValidIndex(Index))
+	{
+		BarIndices.Add(Bars[Index].OwnerKey, Index);
+	}
+}
+
+void UCombatLifeBarSubsystem::SetPercentage(const AActor* Owner, float Percent)
+{
+	if (FCombatLifeBar* Bar = FindBar(Owner))
+	{
+		Bar->Percent = FMath::Clamp(Percent, 0.0f, 1.0f);
+	}
+}
+
+void UCombatLifeBarSubsystem::SetColor(const AActor* Owner, const FLinearColor& Color)
+{
+	if (FCombatLifeBar* Bar = FindBar(Owner))
+	{
+		Bar->Color = Color;
+	}
+}
+
+void UCombatLifeBarSubsystem::SetVisible(const AActor* Owner, bool bVisible)
+{
+	if (FCombatLifeBar* Bar = FindBar(Owner))
+	{
+		Bar->bVisible = bVisible;
+	}
+}
+
+bool UCombatLifeBarSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UCombatLifeBarSubsystem::Deinitialize()
+{
+	Bars.Reset();
+	BarIndices.Reset();
+
+	Super::Deinitialize();
+}
+
+FCombatLifeBar* UCombatLifeBarSubsystem::FindBar(const AActor* Owner)
+{
+	const int32* Index = BarIndices.Find(Owner);
+
+	return Index ? &Bars[*Index] : nullptr;
+}
@@ -0,0 +1,83 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "CombatLifeBarSubsystem.generated.h"
+
+/**
+ *  Draw data for a single overhead life bar
+ */
+struct FCombatLifeBar
+{
+	/** Actor the bar floats over */
+	TWeakObjectPtr<AActor> Owner;
+
+	/** Key of the owner in the index map, valid even after the owner is gone */
+	TObjectKey<AActor> OwnerKey;
+
+	/** Offset from the owner's location to the center of the bar */
+	FVector Offset = FVector::ZeroVector;
+
+	/** Fill color */
+	FLinearColor Color = FLinearColor::Red;
+
+	/** Fill percentage, 0-1 */
+	float Percent = 1.0f;
+
+	/** If false, the bar is skipped when drawing */
+	bool bVisible = true;
+};
+
+/**
+ *  Keeps a packed list of the overhead life bars of all combat characters in the world.
+ *  Owners only push data when their HP, color or visibility changes, and the combat HUD
+ *  draws every bar in a single canvas pass, so the cost per bar stays constant.
+ */
+UCLASS()
+class UCombatLifeBarSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+	/** Packed life bar draw data */
+	TArray<FCombatLifeBar> Bars;
+
+	/** Maps each owner to the index of its bar */
+	TMap<TObjectKey<AActor>, int32> BarIndices;
+
+public:
+
+	/** Returns the subsystem for the provided world, if any */
+	static UCombatLifeBarSubsystem* Get(const UWorld* World);
+
+	/** Adds a life bar for the provided actor, or updates its offset and color if it already has one */
+	void RegisterBar(AActor* Owner, const FVector& Offset, const FLinearColor& Color);
+
+	/** Removes the actor's life bar */
+	void UnregisterBar(AActor* Owner);
+
+	/** Sets the fill percentage of the actor's life bar */
+	void SetPercentage(const AActor* Owner, float Percent);
+
+	/** Sets the fill color of the actor's life bar */
+	void SetColor(const AActor* Owner, const FLinearColor& Color);
+
+	/** Shows or hides the actor's life bar */
+	void SetVisible(const AActor* Owner, bool bVisible);
+
+	/** Returns the packed life bar list */
+	const TArray<FCombatLifeBar>& GetBars() const { return Bars; }
+
+protected:
+
+	/** Only create this subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Cleanup */
+	virtual void Deinitialize() override;
+
+	/** Returns the bar for the provided actor, if any */
+	FCombatLifeBar* FindBar(const AActor* Owner);
+};
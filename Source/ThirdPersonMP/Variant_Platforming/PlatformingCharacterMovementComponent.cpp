@@ -0,0 +1,414 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "PlatformingCharacterMovementComponent.h"
+#include "GameFramework/Character.h"
+#include "Components/CapsuleComponent.h"
+#include "Engine/World.h"
+
+/**
+ *  Saved move that also captures the dash input and the platforming ability state,
+ *  so replayed moves start from the same state they were originally performed with
+ */
+class FSavedMove_Platforming : public FSavedMove_Character
+{
+public:
+
+	typedef FSavedMove_Character Super;
+
+	/** Dash input */
+	uint8 bSavedWantsToDash : 1;
+
+	/** Ability state at the start of the move */
+	uint8 bSavedHasDoubleJumped : 1;
+	uint8 bSavedHasDashed : 1;
+	float SavedWallJumpLockTime = 0.0f;
+	float SavedTimeInAir = 0.0f;
+	float SavedDashTimeRemaining = 0.0f;
+	FVector SavedDashDirection = FVector::ForwardVector;
+
+	virtual void Clear() override
+	{
+		Super::Clear();
+
+		bSavedWantsToDash = false;
+		bSavedHasDoubleJumped = false;
+		bSavedHasDashed = false;
+		SavedWallJumpLockTime = 0.0f;
+		SavedTimeInAir = 0.0f;
+		SavedDashTimeRemaining = 0.0f;
+		SavedDashDirection = FVector::ForwardVector;
+	}
+
+	virtual uint8 GetCompressedFlags() const override
+	{
+		uint8 Result = Super::GetCompressedFlags();
+
+		if (bSavedWantsToDash)
+		{
+			Result |= FLAG_Custom_0;
+		}
+
+		return Result;
+	}
+
+	virtual bool CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const override
+	{
+		// never merge away a dash request
+		if (bSavedWantsToDash || static_cast<const FSavedMove_Platforming*>(NewMove.Get())->bSavedWantsToDash)
+		{
+			return false;
+		}
+
+		return Super::CanCombineWith(NewMove, InCharacter, MaxDelta);
+	}
+
+	virtual void SetMoveFor(ACharacter* Character, float InDeltaTime, FVector const& NewAccel, FNetworkPredictionData_Client_Character& ClientData) override
+	{
+		Super::SetMoveFor(Character, InDeltaTime, NewAccel, ClientData);
+
+		if (const UPlatformingCharacterMovementComponent* Movement = Cast<UPlatformingCharacterMovementComponent>(Character->GetCharacterMovement()))
+		{
+			bSavedWantsToDash = Movement->bWantsToDash;
+			bSavedHasDoubleJumped = Movement->bHasDoubleJumped;
+			bSavedHasDashed = Movement->bHasDashed;
+			SavedWallJumpLockTime = Movement->WallJumpLockTime;
+			SavedTimeInAir = Movement->TimeInAir;
+			SavedDashTimeRemaining = Movement->DashTimeRemaining;
+			SavedDashDirection = Movement->DashDirection;
+		}
+	}
+
+	virtual void PrepMoveFor(ACharacter* Character) override
+	{
+		Super::PrepMoveFor(Character);
+
+		if (UPlatformingCharacterMovementComponent* Movement = Cast<UPlatformingCharacterMovementComponent>(Character->GetCharacterMovement()))
+		{
+			Movement->bHasDoubleJumped = bSavedHasDoubleJumped;
+			Movement->bHasDashed = bSavedHasDashed;
+			Movement->WallJumpLockTime = SavedWallJumpLockTime;
+			Movement->TimeInAir = SavedTimeInAir;
+			Movement->DashTimeRemaining = SavedDashTimeRemaining;
+			Movement->DashDirection = SavedDashDirection;
+		}
+	}
+};
+
+/**
+ *  Client prediction data that allocates platforming saved moves
+ */
+class FNetworkPredictionData_Client_Platforming : public FNetworkPredictionData_Client_Character
+{
+public:
+
+	typedef FNetworkPredictionData_Client_Character Super;
+
+	FNetworkPredictionData_Client_Platforming(const UCharacterMovementComponent& ClientMovement)
+		: Super(ClientMovement)
+	{
+	}
+
+	virtual FSavedMovePtr AllocateNewMove() override
+	{
+		return FSavedMovePtr(new FSavedMove_Platforming());
+	}
+};
+
+UPlatformingCharacterMovementComponent::UPlatformingCharacterMovementComponent()
+{
+	// initialize the flags
+	bWantsToDash = false;
+	bHasDoubleJumped = false;
+	bHasDashed = false;
+}
+
+bool UPlatformingCharacterMovementComponent::IsDashing() const
+{
+	return MovementMode == MOVE_Custom && CustomMovementMode == static_cast<uint8>(EPlatformingMovementMode::Dash);
+}
+
+FNetworkPredictionData_Client* UPlatformingCharacterMovementComponent::GetPredictionData_Client() const
+{
+	if (ClientPredictionData == nullptr)
+	{
+		UPlatformingCharacterMovementComponent* MutableThis = const_cast<UPlatformingCharacterMovementComponent*>(this);
+		MutableThis->ClientPredictionData = new FNetworkPredictionData_Client_Platforming(*this);
+	}
+
+	return ClientPredictionData;
+}
+
+bool UPlatformingCharacterMovementComponent::CanAttemptJump() const
+{
+	// no jumping mid-dash
+	return !IsDashing() && Super::CanAttemptJump();
+}
+
+bool UPlatformingCharacterMovementComponent::DoJump(bool bReplayingMoves, float DeltaTime)
+{
+	// keep applying a jump that's being held
+	if (CharacterOwner->bWasJumping)
+	{
+		return Super::DoJump(bReplayingMoves, DeltaTime);
+	}
+
+	// we're grounded so just do a regular jump
+	if (!IsFalling())
+	{
+		if (Super::DoJump(bReplayingMoves, DeltaTime))
+		{
+			BroadcastMovementEvent(EPlatformingMovementEvent::Jumped);
+			return true;
+		}
+
+		return false;
+	}
+
+	// ignore jumps right after a wall jump
+	if (WallJumpLockTime > 0.0f)
+	{
+		return false;
+	}
+
+	// try to jump off a wall first
+	if (TryWallJump())
+	{
+		BroadcastMovementEvent(EPlatformingMovementEvent::WallJumped);
+		return true;
+	}
+
+	// are we still within coyote time after walking off a ledge?
+	// CheckJumpInput has already counted this jump, so look at the count from before it. Saved moves restore it on replay
+	const bool bCoyoteJump = TimeInAir < MaxCoyoteTime && CharacterOwner->JumpCurrentCountPreJump == 0;
+
+	// only double jump once while we're in the air
+	if (!bCoyoteJump && bHasDoubleJumped)
+	{
+		return false;
+	}
+
+	if (!Super::DoJump(bReplayingMoves, DeltaTime))
+	{
+		return false;
+	}
+
+	if (bCoyoteJump)
+	{
+		BroadcastMovementEvent(EPlatformingMovementEvent::Jumped);
+	}
+	else
+	{
+		bHasDoubleJumped = true;
+		BroadcastMovementEvent(EPlatformingMovementEvent::DoubleJumped);
+	}
+
+	return true;
+}
+
+void UPlatformingCharacterMovementComponent::UpdateFromCompressedFlags(uint8 Flags)
+{
+	Super::UpdateFromCompressedFlags(Flags);
+
+	bWantsToDash = (Flags & FSavedMove_Character::FLAG_Custom_0) != 0;
+}
+
+void UPlatformingCharacterMovementComponent::UpdateCharacterStateBeforeMovement(float DeltaSeconds)
+{
+	Super::UpdateCharacterStateBeforeMovement(DeltaSeconds);
+
+	// advance the wall jump lock with the move, so it expires at the same point on every machine
+	if (WallJumpLockTime > 0.0f)
+	{
+		WallJumpLockTime -= DeltaSeconds;
+
+		if (WallJumpLockTime <= 0.0f)
+		{
+			WallJumpLockTime = 0.0f;
+			BroadcastMovementEvent(EPlatformingMovementEvent::WallJumpLockEnded);
+		}
+	}
+
+	// track coyote time
+	if (IsFalling())
+	{
+		TimeInAir += DeltaSeconds;
+	}
+
+	// start a requested dash. Only one dash is allowed until we land
+	if (bWantsToDash)
+	{
+		bWantsToDash = false;
+
+		if (!bHasDashed && !IsDashing() && (IsMovingOnGround() || IsFalling()))
+		{
+			bHasDashed = true;
+			DashTimeRemaining = DashDuration;
+			DashDirection = CharacterOwner->GetActorForwardVector().GetSafeNormal2D();
+
+			// don't carry momentum into the dash
+			Velocity = FVector::ZeroVector;
+
+			SetMovementMode(MOVE_Custom, static_cast<uint8>(EPlatformingMovementMode::Dash));
+
+			BroadcastMovementEvent(EPlatformingMovementEvent::DashStarted);
+		}
+	}
+}
+
+void UPlatformingCharacterMovementComponent::PhysCustom(float DeltaTime, int32 Iterations)
+{
+	if (CustomMovementMode == static_cast<uint8>(EPlatformingMovementMode::Dash))
+	{
+		PhysDash(DeltaTime, Iterations);
+		return;
+	}
+
+	Super::PhysCustom(DeltaTime, Iterations);
+}
+
+void UPlatformingCharacterMovementComponent::OnMovementModeChanged(EMovementMode PreviousMovementMode, uint8 PreviousCustomMode)
+{
+	Super::OnMovementModeChanged(PreviousMovementMode, PreviousCustomMode);
+
+	const bool bWasDashing = PreviousMovementMode == MOVE_Custom && PreviousCustomMode == static_cast<uint8>(EPlatformingMovementMode::Dash);
+
+	if (bWasDashing && !IsDashing())
+	{
+		DashTimeRemaining = 0.0f;
+		BroadcastMovementEvent(EPlatformingMovementEvent::DashEnded);
+	}
+
+	if (IsMovingOnGround())
+	{
+		// reset the double jump and dash flags
+		const bool bLanded = bHasDoubleJumped || bHasDashed || PreviousMovementMode == MOVE_Falling || bWasDashing;
+
+		bHasDoubleJumped = false;
+		bHasDashed = false;
+		TimeInAir = 0.0f;
+
+		if (bLanded)
+		{
+			BroadcastMovementEvent(EPlatformingMovementEvent::Landed);
+		}
+	}
+	else if (IsFalling())
+	{
+		// restart coyote time
+		TimeInAir = 0.0f;
+	}
+}
+
+FVector UPlatformingCharacterMovementComponent::ConstrainInputAcceleration(const FVector& InputAcceleration) const
+{
+	// momentarily disable movement inputs if we've just wall jumped
+	if (WallJumpLockTime > 0.0f)
+	{
+		return FVector::ZeroVector;
+	}
+
+	return Super::ConstrainInputAcceleration(InputAcceleration);
+}
+
+bool UPlatformingCharacterMovementComponent::TryWallJump()
+{
+	// run a sphere sweep to check if we're in front of a wall
+	FHitResult OutHit;
+
+	const FVector TraceStart = UpdatedComponent->GetComponentLocation();
+	const FVector TraceEnd = TraceStart + (CharacterOwner->GetActorForwardVector() * WallJumpTraceDistance);
+	const FCollisionShape TraceShape = FCollisionShape::MakeSphere(WallJumpTraceRadius);
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(PlatformingWallJump), false, CharacterOwner);
+
+	if (!GetWorld()->SweepSingleByChannel(OutHit, TraceStart, TraceEnd, FQuat::Identity, ECC_Visibility, TraceShape, QueryParams))
+	{
+		return false;
+	}
+
+	// rotate the character to face away from the wall, so we're correctly oriented for the next wall jump
+	FRotator WallOrientation = OutHit.ImpactNormal.ToOrientationRotator();
+	WallOrientation.Pitch = 0.0f;
+	WallOrientation.Roll = 0.0f;
+
+	MoveUpdatedComponent(FVector::ZeroVector, WallOrientation.Quaternion(), false);
+
+	// bounce off the wall
+	Velocity = (OutHit.ImpactNormal * WallJumpBounceImpulse) + (FVector::UpVector * WallJumpVerticalImpulse);
+
+	// lock out jumps and steering for a moment
+	WallJumpLockTime = DelayBetweenWallJumps;
+
+	return true;
+}
+
+void UPlatformingCharacterMovementComponent::PhysDash(float DeltaTime, int32 Iterations)
+{
+	if (DeltaTime < MIN_TICK_TIME)
+	{
+		return;
+	}
+
+	// simulated proxies follow the replicated velocity until the server ends the dash
+	if (CharacterOwner->GetLocalRole() == ROLE_SimulatedProxy)
+	{
+		FHitResult Hit(1.0f);
+		SafeMoveUpdatedComponent(Velocity * DeltaTime, UpdatedComponent->GetComponentQuat(), true, Hit);
+		return;
+	}
+
+	const float DashTime = FMath::Min(DeltaTime, DashTimeRemaining);
+	DashTimeRemaining -= DashTime;
+
+	// move at a constant speed, ignoring gravity and input
+	Velocity = DashDirection * DashSpeed;
+
+	const FVector Delta = Velocity * DashTime;
+
+	FHitResult Hit(1.0f);
+	SafeMoveUpdatedComponent(Delta, UpdatedComponent->GetComponentQuat(), true, Hit);
+
+	// slide along anything we run into
+	if (Hit.IsValidBlockingHit())
+	{
+		HandleImpact(Hit, DashTime, Delta);
+		SlideAlongSurface(Delta, 1.0f - Hit.Time, Hit.Normal, Hit, true);
+	}
+
+	// finish the dash and spend the rest of the time in the new mode
+	if (DashTimeRemaining <= 0.0f)
+	{
+		EndDash();
+		StartNewPhysics(DeltaTime - DashTime, Iterations);
+	}
+}
+
+void UPlatformingCharacterMovementComponent::EndDash()
+{
+	// don't carry the full dash speed out of the dash
+	Velocity = Velocity.GetClampedToMaxSize(MaxWalkSpeed);
+
+	// are we grounded after the dash?
+	FFindFloorResult FloorResult;
+	FindFloor(UpdatedComponent->GetComponentLocation(), FloorResult, false);
+
+	if (FloorResult.IsWalkableFloor())
+	{
+		CurrentFloor = FloorResult;
+		SetMovementMode(MOVE_Walking);
+	}
+	else
+	{
+		SetMovementMode(MOVE_Falling);
+	}
+}
+
+void UPlatformingCharacterMovementComponent::BroadcastMovementEvent(EPlatformingMovementEvent Event) const
+{
+	// replayed moves already raised their events the first time around
+	if (CharacterOwner && !CharacterOwner->bClientUpdating)
+	{
+		OnMovementEvent.Broadcast(Event);
+	}
+}
@@ -0,0 +1,139 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TPSCharacterMovementComponent.h"
+#include "PlatformingCharacterMovementComponent.generated.h"
+
+/**
+ *  Custom movement modes used by platforming characters
+ */
+UENUM(BlueprintType)
+enum class EPlatformingMovementMode : uint8
+{
+	Dash
+};
+
+/**
+ *  Cosmetic events raised by the platforming movement component
+ */
+enum class EPlatformingMovementEvent : uint8
+{
+	Jumped,
+	DoubleJumped,
+	WallJumped,
+	WallJumpLockEnded,
+	DashStarted,
+	DashEnded,
+	Landed
+};
+
+/** Platforming movement event delegate */
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnPlatformingMovementEvent, EPlatformingMovementEvent /* Event */);
+
+/**
+ *  Character Movement Component that runs the platforming abilities inside the predicted movement simulation.
+ *  Double jump, wall jump, coyote time and dash are resolved while performing each move, with their timers
+ *  advanced by the move's delta time instead of game thread timers, and their state saved with every move,
+ *  so client moves replay the same way on the server and after corrections.
+ *  Dash is a custom movement mode with a fixed speed and duration.
+ */
+UCLASS()
+class UPlatformingCharacterMovementComponent : public UTPSCharacterMovementComponent
+{
+	GENERATED_BODY()
+
+	friend class FSavedMove_Platforming;
+
+	/** If true, a dash has been requested and will start on the next move */
+	uint8 bWantsToDash : 1;
+
+	/** If true, the character has double jumped since it last landed */
+	uint8 bHasDoubleJumped : 1;
+
+	/** If true, the character has dashed since it last landed */
+	uint8 bHasDashed : 1;
+
+	/** Time left before the character can jump or steer again after a wall jump */
+	float WallJumpLockTime = 0.0f;
+
+	/** Time spent falling since the character last left the ground */
+	float TimeInAir = 0.0f;
+
+	/** Time left in the current dash */
+	float DashTimeRemaining = 0.0f;
+
+	/** Direction of the current dash */
+	FVector DashDirection = FVector::ForwardVector;
+
+protected:
+
+	/** Speed of the dash */
+	UPROPERTY(EditAnywhere, Category="Character Movement: Dash", meta = (ClampMin = 0, ClampMax = 10000, Units = "cm/s"))
+	float DashSpeed = 1800.0f;
+
+	/** Duration of the dash */
+	UPROPERTY(EditAnywhere, Category="Character Movement: Dash", meta = (ClampMin = 0, ClampMax = 2, Units = "s"))
+	float DashDuration = 0.25f;
+
+public:
+
+	/** Wall jump and coyote time settings. Copied from the owning character so they're tuned in one place */
+	float WallJumpTraceDistance = 50.0f;
+	float WallJumpTraceRadius = 25.0f;
+	float WallJumpBounceImpulse = 800.0f;
+	float WallJumpVerticalImpulse = 900.0f;
+	float DelayBetweenWallJumps = 0.1f;
+	float MaxCoyoteTime = 0.16f;
+
+	/** Raised for cosmetic feedback. Never raised while replaying moves */
+	FOnPlatformingMovementEvent OnMovementEvent;
+
+public:
+
+	/** Constructor */
+	UPlatformingCharacterMovementComponent();
+
+	/** Requests a dash on the next move */
+	void RequestDash() { bWantsToDash = true; }
+
+	/** Returns true if the character is dashing */
+	bool IsDashing() const;
+
+	/** Returns true if the character has double jumped since it last landed */
+	bool HasDoubleJumped() const { return bHasDoubleJumped; }
+
+	/** Returns true if the character has wall jumped and is still locked out of further jumps */
+	bool HasWallJumped() const { return WallJumpLockTime > 0.0f; }
+
+public:
+
+	// ~begin UCharacterMovementComponent interface
+	virtual FNetworkPredictionData_Client* GetPredictionData_Client() const override;
+	virtual bool CanAttemptJump() const override;
+	virtual bool DoJump(bool bReplayingMoves, float DeltaTime) override;
+	// ~end UCharacterMovementComponent interface
+
+protected:
+
+	// ~begin UCharacterMovementComponent interface
+	virtual void UpdateFromCompressedFlags(uint8 Flags) override;
+	virtual void UpdateCharacterStateBeforeMovement(float DeltaSeconds) override;
+	virtual void PhysCustom(float DeltaTime, int32 Iterations) override;
+	virtual void OnMovementModeChanged(EMovementMode PreviousMovementMode, uint8 PreviousCustomMode) override;
+	virtual FVector ConstrainInputAcceleration(const FVector& InputAcceleration) const override;
+	// ~end UCharacterMovementComponent interface
+
+	/** Looks for a wall in front of the character and bounces off it. Returns false if there's no wall */
+	bool TryWallJump();
+
+	/** Moves the character along the dash */
+	void PhysDash(float DeltaTime, int32 Iterations);
+
+	/** Ends the dash, landing on the floor if there is one */
+	void EndDash();
+
+	/** Raises a movement event, unless we're replaying moves */
+	void BroadcastMovementEvent(EPlatformingMovementEvent Event) const;
+};
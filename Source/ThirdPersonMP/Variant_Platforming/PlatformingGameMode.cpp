@@ -2,8 +2,218 @@
 
 
 #include "Variant_Platforming/PlatformingGameMode.h"
+#include "PlatformingCharacter.h"
+#include "TPSCharacterMovementComponent.h"
+#include "GameFramework/Controller.h"
+#include "GameFramework/PlayerStart.h"
+#include "Kismet/GameplayStatics.h"
+#include "Engine/World.h"
+#include "TimerManager.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "ThirdPersonMP.h"
+
+namespace PlatformingGameMode
+{
+	static FAutoConsoleCommandWithWorldAndArgs BenchmarkCommand(
+		TEXT("TPS.Platforming.BenchMovement"),
+		TEXT("Compares the game thread movement cost of the regular and predicted platforming characters.\n")
+		TEXT("Usage: TPS.Platforming.BenchMovement [NumCharacters=100] [NumFrames=300]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			if (APlatformingGameMode* GameMode = World ? World->GetAuthGameMode<APlatformingGameMode>() : nullptr)
+			{
+				const int32 NumCharacters = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 100;
+				const int32 NumFrames = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 300;
+
+				GameMode->RunMovementBenchmark(NumCharacters, NumFrames);
+			}
+		}));
+
+	/** Spacing between benchmark characters */
+	static constexpr float BenchmarkSpacing = 250.0f;
+}
 
 APlatformingGameMode::APlatformingGameMode()
 {
 	// stub
-}
\ No newline at end of file
+}
+
+TSubclassOf<APlatformingCharacter> APlatformingGameMode::GetPlayerCharacterClass(TSubclassOf<APlatformingCharacter> DefaultClass) const
+{
+	return (bUsePredictedMovement && PredictedCharacterClass) ? PredictedCharacterClass : DefaultClass;
+}
+
+void APlatformingGameMode::RunMovementBenchmark(int32 NumCharacters, int32 NumFrames)
+{
+	// ignore the request if a benchmark is already running
+	if (!PendingBenchmarkClasses.IsEmpty() || !BenchmarkCharacters.IsEmpty())
+	{
+		UE_LOG(LogThirdPersonMP, Warning, TEXT("Platforming movement benchmark already running."));
+		return;
+	}
+
+	// benchmark the regular character first, then the predicted one
+	if (DefaultPawnClass && DefaultPawnClass->IsChildOf(APlatformingCharacter::StaticClass()))
+	{
+		PendingBenchmarkClasses.Add(TSubclassOf<APlatformingCharacter>(DefaultPawnClass.Get()));
+	}
+
+	if (PredictedCharacterClass)
+	{
+		PendingBenchmarkClasses.Add(PredictedCharacterClass);
+	}
+
+	if (PendingBenchmarkClasses.IsEmpty())
+	{
+		UE_LOG(LogThirdPersonMP, Warning, TEXT("Platforming movement benchmark needs a platforming default pawn class or predicted character class."));
+		return;
+	}
+
+	BenchmarkNumCharacters = NumCharacters;
+	BenchmarkNumFrames = NumFrames;
+
+	SpawnBenchmarkCharacters(PendingBenchmarkClasses[0]);
+	PendingBenchmarkClasses.RemoveAt(0);
+
+	GetWorldTimerManager().SetTimerForNextTick(this, &APlatformingGameMode::StepMovementBenchmark);
+}
+
+UClass* APlatformingGameMode::GetDefaultPawnClassForController_Implementation(AController* InController)
+{
+	if (bUsePredictedMovement && PredictedCharacterClass)
+	{
+		return PredictedCharacterClass;
+	}
+
+	return Super::GetDefaultPawnClassForController_Implementation(InController);
+}
+
+void APlatformingGameMode::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	Super::EndPlay(EndPlayReason);
+
+	PendingBenchmarkClasses.Reset();
+	BenchmarkCharacters.Reset();
+}
+
+void APlatformingGameMode::StepMovementBenchmark()
+{
+	// is this pass done?
+	if (++BenchmarkFrame >= BenchmarkNumFrames)
+	{
+		FinishBenchmarkPass();
+
+		if (PendingBenchmarkClasses.IsEmpty())
+		{
+			return;
+		}
+
+		SpawnBenchmarkCharacters(PendingBenchmarkClasses[0]);
+		PendingBenchmarkClasses.RemoveAt(0);
+	}
+	else
+	{
+		// drive the characters with a repeating pattern of running, jumping and dashing, staggered per character
+		for (int32 i = 0; i < BenchmarkCharacters.Num(); ++i)
+		{
+			APlatformingCharacter* Character = BenchmarkCharacters[i].Get();
+
+			if (!Character)
+			{
+				continue;
+			}
+
+			const int32 PatternFrame = (BenchmarkFrame + i * 7) % 120;
+
+			Character->AddMovementInput(FVector(PatternFrame < 60 ? 1.0f : -1.0f, 0.0f, 0.0f));
+
+			if (PatternFrame == 10 || PatternFrame == 30)
+			{
+				Character->DoJumpStart();
+			}
+			else if (PatternFrame == 15 || PatternFrame == 35)
+			{
+				Character->DoJumpEnd();
+			}
+			else if (PatternFrame == 80)
+			{
+				Character->DoDash();
+			}
+		}
+	}
+
+	GetWorldTimerManager().SetTimerForNextTick(this, &APlatformingGameMode::StepMovementBenchmark);
+}
+
+void APlatformingGameMode::SpawnBenchmarkCharacters(TSubclassOf<APlatformingCharacter> CharacterClass)
+{
+	BenchmarkFrame = 0;
+
+	// lay the characters out in a grid around the first player start
+	FVector Origin = FVector::ZeroVector;
+
+	if (AActor* PlayerStart = UGameplayStatics::GetActorOfClass(GetWorld(), APlayerStart::StaticClass()))
+	{
+		Origin = PlayerStart->GetActorLocation();
+	}
+
+	const int32 GridSize = FMath::CeilToInt32(FMath::Sqrt(static_cast<float>(BenchmarkNumCharacters)));
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+	for (int32 i = 0; i < BenchmarkNumCharacters; ++i)
+	{
+		const FVector Offset((i % GridSize) * PlatformingGameMode::BenchmarkSpacing, (i / GridSize) * PlatformingGameMode::BenchmarkSpacing, 0.0f);
+
+		if (APlatformingCharacter* Character = GetWorld()->SpawnActor<APlatformingCharacter>(CharacterClass, Origin + Offset, FRotator::ZeroRotator, SpawnParams))
+		{
+			// possess the character with an AI controller so it processes jump inputs like a player
+			Character->SpawnDefaultController();
+
+			BenchmarkCharacters.Add(Character);
+		}
+	}
+}
+
+void APlatformingGameMode::FinishBenchmarkPass()
+{
+	uint64 TickCycles = 0;
+	UClass* CharacterClass = nullptr;
+
+	for (const TWeakObjectPtr<APlatformingCharacter>& CharacterPtr : BenchmarkCharacters)
+	{
+		if (APlatformingCharacter* Character = CharacterPtr.Get())
+		{
+			CharacterClass = Character->GetClass();
+
+			if (const UTPSCharacterMovementComponent* Movement = Cast<UTPSCharacterMovementComponent>(Character->GetCharacterMovement()))
+			{
+				TickCycles += Movement->GetTickCycles();
+			}
+
+			if (AController* Controller = Character->GetController())
+			{
+				Controller->Destroy();
+			}
+
+			Character->Destroy();
+		}
+	}
+
+	const int32 NumCharacters = BenchmarkCharacters.Num();
+	BenchmarkCharacters.Reset();
+
+	if (NumCharacters > 0 && BenchmarkNumFrames > 0)
+	{
+		const double MsPerFrame = FPlatformTime::ToMilliseconds64(TickCycles) / BenchmarkNumFrames;
+
+		UE_LOG(LogThirdPersonMP, Log, TEXT("Platforming movement benchmark: %s, %d characters, %d frames. %.3f ms per frame, %.3f ms per frame per 100 characters"),
+			*GetNameSafe(CharacterClass),
+			NumCharacters,
+			BenchmarkNumFrames,
+			MsPerFrame,
+			MsPerFrame * 100.0 / NumCharacters);
+	}
+}
@@ -6,16 +6,67 @@
 #include "GameFramework/GameModeBase.h"
 #include "PlatformingGameMode.generated.h"
 
+class APlatformingCharacter;
+
 /**
  *  Simple GameMode for a third person platforming game
+ *  Selects between the regular and the predicted platforming character
  */
 UCLASS()
 class APlatformingGameMode : public AGameModeBase
 {
 	GENERATED_BODY()
-	
+
+protected:
+
+	/** Character class to use instead of the default pawn when predicted movement is enabled */
+	UPROPERTY(EditAnywhere, Category="Platforming")
+	TSubclassOf<APlatformingCharacter> PredictedCharacterClass;
+
+	/** If true, players use the predicted character, which runs its abilities inside the movement simulation */
+	UPROPERTY(EditAnywhere, Category="Platforming")
+	bool bUsePredictedMovement = false;
+
+	/** Characters spawned for the movement benchmark */
+	TArray<TWeakObjectPtr<APlatformingCharacter>> BenchmarkCharacters;
+
+	/** Character classes still to be benchmarked */
+	TArray<TSubclassOf<APlatformingCharacter>> PendingBenchmarkClasses;
+
+	/** Number of characters to spawn per benchmark pass */
+	int32 BenchmarkNumCharacters = 0;
+
+	/** Number of frames to run each benchmark pass for */
+	int32 BenchmarkNumFrames = 0;
+
+	/** Frames run in the current benchmark pass */
+	int32 BenchmarkFrame = 0;
+
 public:
 
 	/** Constructor */
 	APlatformingGameMode();
+
+	/** Returns the character class players should use, given the class they'd use otherwise */
+	TSubclassOf<APlatformingCharacter> GetPlayerCharacterClass(TSubclassOf<APlatformingCharacter> DefaultClass) const;
+
+	/** Compares the game thread movement cost of the regular and predicted characters */
+	void RunMovementBenchmark(int32 NumCharacters, int32 NumFrames);
+
+protected:
+
+	/** Swaps in the predicted character when it's enabled */
+	virtual UClass* GetDefaultPawnClassForController_Implementation(AController* InController) override;
+
+	/** Cleanup */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/** Drives the benchmark characters for one frame, and moves on to the next pass when this one is done */
+	void StepMovementBenchmark();
+
+	/** Spawns the benchmark characters for a class */
+	void SpawnBenchmarkCharacters(TSubclassOf<APlatformingCharacter> CharacterClass);
+
+	/** Logs the movement cost of the current benchmark characters and destroys them */
+	void FinishBenchmarkPass();
 };
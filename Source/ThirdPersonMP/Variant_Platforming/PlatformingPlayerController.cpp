@@ -7,6 +7,7 @@
 #include "Kismet/GameplayStatics.h"
 #include "GameFramework/PlayerStart.h"
 #include "PlatformingCharacter.h"
+#include "PlatformingGameMode.h"
 #include "Engine/LocalPlayer.h"
 #include "Engine/World.h"
 #include "Blueprint/UserWidget.h"
@@ -83,7 +84,15 @@ void APlatformingPlayerController::OnPawnDestroyed(AActor* DestroyedActor)
 		// spawn a character at the player start
 		const FTransform SpawnTransform = ActorList[0]->GetActorTransform();
 
-		if (APlatformingCharacter* RespawnedCharacter = GetWorld()->SpawnActor<APlatformingCharacter>(CharacterClass, SpawnTransform))
+		// let the game mode swap in the predicted character if it's enabled
+		TSubclassOf<APlatformingCharacter> RespawnClass = CharacterClass;
+
+		if (APlatformingGameMode* GameMode = GetWorld()->GetAuthGameMode<APlatformingGameMode>())
+		{
+			RespawnClass = GameMode->GetPlayerCharacterClass(CharacterClass);
+		}
+
+		if (APlatformingCharacter* RespawnedCharacter = GetWorld()->SpawnActor<APlatformingCharacter>(RespawnClass, SpawnTransform))
 		{
 			// possess the character
 			Possess(RespawnedCharacter);
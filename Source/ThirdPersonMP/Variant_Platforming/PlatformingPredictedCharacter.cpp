@@ -0,0 +1,122 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "PlatformingPredictedCharacter.h"
+#include "PlatformingCharacterMovementComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Animation/AnimInstance.h"
+
+APlatformingPredictedCharacter::APlatformingPredictedCharacter(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<UPlatformingCharacterMovementComponent>(ACharacter::CharacterMovementComponentName))
+{
+}
+
+void APlatformingPredictedCharacter::PostInitializeComponents()
+{
+	Super::PostInitializeComponents();
+
+	PlatformingMovement = Cast<UPlatformingCharacterMovementComponent>(GetCharacterMovement());
+
+	if (PlatformingMovement)
+	{
+		// keep the abilities tuned on the character
+		PlatformingMovement->WallJumpTraceDistance = WallJumpTraceDistance;
+		PlatformingMovement->WallJumpTraceRadius = WallJumpTraceRadius;
+		PlatformingMovement->WallJumpBounceImpulse = WallJumpBounceImpulse;
+		PlatformingMovement->WallJumpVerticalImpulse = WallJumpVerticalImpulse;
+		PlatformingMovement->DelayBetweenWallJumps = DelayBetweenWallJumps;
+		PlatformingMovement->MaxCoyoteTime = MaxCoyoteTime;
+
+		PlatformingMovement->OnMovementEvent.AddUObject(this, &APlatformingPredictedCharacter::OnMovementEvent);
+	}
+}
+
+void APlatformingPredictedCharacter::DoMove(float Right, float Forward)
+{
+	if (GetController() != nullptr)
+	{
+		// find out which way is forward
+		const FRotator Rotation = GetController()->GetControlRotation();
+		const FRotator YawRotation(0, Rotation.Yaw, 0);
+
+		// add movement
+		AddMovementInput(FRotationMatrix(YawRotation).GetUnitAxis(EAxis::X), Forward);
+		AddMovementInput(FRotationMatrix(YawRotation).GetUnitAxis(EAxis::Y), Right);
+	}
+}
+
+void APlatformingPredictedCharacter::DoDash()
+{
+	if (PlatformingMovement)
+	{
+		PlatformingMovement->RequestDash();
+	}
+}
+
+void APlatformingPredictedCharacter::DoJumpStart()
+{
+	// the jump type is resolved while performing the move
+	Jump();
+}
+
+bool APlatformingPredictedCharacter::CanJumpInternal_Implementation() const
+{
+	// jump counts are enforced by the movement component. Only stop a held jump once it runs out
+	const bool bJumpKeyHeld = bPressedJump && JumpKeyHoldTime < GetJumpMaxHoldTime();
+
+	return !bIsCrouched && GetCharacterMovement()->CanAttemptJump() && (!bWasJumping || bJumpKeyHeld);
+}
+
+void APlatformingPredictedCharacter::OnMovementEvent(EPlatformingMovementEvent Event)
+{
+	switch (Event)
+	{
+	case EPlatformingMovementEvent::Jumped:
+
+		SetJumpTrailState(true);
+		break;
+
+	case EPlatformingMovementEvent::DoubleJumped:
+
+		bHasDoubleJumped = true;
+		SetJumpTrailState(true);
+		break;
+
+	case EPlatformingMovementEvent::WallJumped:
+
+		bHasWallJumped = true;
+		SetJumpTrailState(true);
+		break;
+
+	case EPlatformingMovementEvent::WallJumpLockEnded:
+
+		bHasWallJumped = false;
+		break;
+
+	case EPlatformingMovementEvent::DashStarted:
+
+		bIsDashing = true;
+		bHasDashed = true;
+		SetJumpTrailState(true);
+
+		// play the dash montage for feedback. The movement itself is driven by the dash movement mode
+		if (UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance())
+		{
+			AnimInstance->Montage_Play(DashMontage, 1.0f, EMontagePlayReturnType::MontageLength, 0.0f, true);
+		}
+
+		break;
+
+	case EPlatformingMovementEvent::DashEnded:
+
+		bIsDashing = false;
+		break;
+
+	case EPlatformingMovementEvent::Landed:
+
+		bHasDoubleJumped = false;
+		bHasDashed = false;
+		SetJumpTrailState(false);
+		break;
+	}
+}
@@ -0,0 +1,55 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PlatformingCharacter.h"
+#include "PlatformingPredictedCharacter.generated.h"
+
+class UPlatformingCharacterMovementComponent;
+enum class EPlatformingMovementEvent : uint8;
+
+/**
+ *  Platforming character whose multi-jump, wall jump, coyote time and dash run inside
+ *  the predicted movement simulation instead of game thread callbacks and timers.
+ *  The character only forwards inputs to its movement component and plays the cosmetic feedback.
+ */
+UCLASS(abstract)
+class APlatformingPredictedCharacter : public APlatformingCharacter
+{
+	GENERATED_BODY()
+
+	/** Cached platforming movement component */
+	UPROPERTY(Transient)
+	TObjectPtr<UPlatformingCharacterMovementComponent> PlatformingMovement;
+
+public:
+
+	/** Constructor */
+	APlatformingPredictedCharacter(const FObjectInitializer& ObjectInitializer);
+
+	/** Returns the platforming movement component */
+	UPlatformingCharacterMovementComponent* GetPlatformingMovement() const { return PlatformingMovement; }
+
+public:
+
+	/** Passes the ability settings to the movement component */
+	virtual void PostInitializeComponents() override;
+
+	/** Handles move inputs. Steering lockout is handled by the movement component */
+	virtual void DoMove(float Right, float Forward) override;
+
+	/** Handles dash inputs by requesting a predicted dash */
+	virtual void DoDash() override;
+
+	/** Handles jump inputs. The movement component decides which kind of jump to do */
+	virtual void DoJumpStart() override;
+
+protected:
+
+	/** Lets the movement component decide which jumps are allowed */
+	virtual bool CanJumpInternal_Implementation() const override;
+
+	/** Plays the cosmetic feedback for movement events */
+	void OnMovementEvent(EPlatformingMovementEvent Event);
+};
@@ -0,0 +1,71 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "SideScrollingCrowdSpawner.h"
+#include "SideScrollingCrowdSubsystem.h"
+#include "SideScrollingNPC.h"
+#include "Components/BoxComponent.h"
+#include "Components/CapsuleComponent.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Engine/World.h"
+
+ASideScrollingCrowdSpawner::ASideScrollingCrowdSpawner()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	// create the crowd area
+	RootComponent = Area = CreateDefaultSubobject<UBoxComponent>(TEXT("Area"));
+
+	Area->SetBoxExtent(FVector(2000.0f, 100.0f, 200.0f), false);
+	Area->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Area->SetCanEverAffectNavigation(false);
+
+	// create the instanced mesh. Agents don't collide, they follow the ground cache instead
+	Instances = CreateDefaultSubobject<UInstancedStaticMeshComponent>(TEXT("Instances"));
+	Instances->SetupAttachment(Area);
+
+	Instances->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Instances->SetCanEverAffectNavigation(false);
+	Instances->SetCastShadow(false);
+}
+
+void ASideScrollingCrowdSpawner::BeginPlay()
+{
+	Super::BeginPlay();
+
+	USideScrollingCrowdSubsystem* Crowd = USideScrollingCrowdSubsystem::Get(GetWorld());
+
+	if (!Crowd)
+	{
+		return;
+	}
+
+	FSideScrollingCrowdParams Params;
+	Params.Owner = this;
+	Params.Instances = Instances;
+	Params.NPCClass = NPCClass;
+	Params.Bounds = Area->Bounds.GetBox();
+	Params.NumAgents = NumAgents;
+	Params.MinSpeed = MinSpeed;
+	Params.MaxSpeed = FMath::Max(MinSpeed, MaxSpeed);
+	Params.PatrolLength = PatrolLength;
+	Params.Seed = Seed;
+
+	// stand the agents on the ground like the NPCs they'll be promoted to
+	if (NPCClass)
+	{
+		Params.HalfHeight = NPCClass->GetDefaultObject<ASideScrollingNPC>()->GetCapsuleComponent()->GetScaledCapsuleHalfHeight();
+	}
+
+	Crowd->AddCrowd(Params);
+}
+
+void ASideScrollingCrowdSpawner::EndPlay(EEndPlayReason::Type EndPlayReason)
+{
+	if (USideScrollingCrowdSubsystem* Crowd = USideScrollingCrowdSubsystem::Get(GetWorld()))
+	{
+		Crowd->RemoveCrowd(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
@@ -0,0 +1,69 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "SideScrollingCrowdSpawner.generated.h"
+
+class UBoxComponent;
+class UInstancedStaticMeshComponent;
+class ASideScrollingNPC;
+
+/**
+ *  Populates an area with a large background crowd of side scrolling NPCs.
+ *  Agents are simulated as data by the crowd subsystem and drawn through an instanced mesh,
+ *  and only become full NPC actors while a player is near them.
+ */
+UCLASS(abstract)
+class ASideScrollingCrowdSpawner : public AActor
+{
+	GENERATED_BODY()
+
+	/** Area the crowd is scattered in */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Components", meta = (AllowPrivateAccess = "true"))
+	UBoxComponent* Area;
+
+	/** Instanced mesh drawing the agents that haven't been promoted to actors */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Components", meta = (AllowPrivateAccess = "true"))
+	UInstancedStaticMeshComponent* Instances;
+
+protected:
+
+	/** NPC class agents are promoted to near the player */
+	UPROPERTY(EditAnywhere, Category="Crowd")
+	TSubclassOf<ASideScrollingNPC> NPCClass;
+
+	/** Number of agents in the crowd */
+	UPROPERTY(EditAnywhere, Category="Crowd", meta = (ClampMin = 0, ClampMax = 20000))
+	int32 NumAgents = 200;
+
+	/** Minimum agent walk speed */
+	UPROPERTY(EditAnywhere, Category="Crowd", meta = (ClampMin = 0, ClampMax = 1000, Units = "cm/s"))
+	float MinSpeed = 100.0f;
+
+	/** Maximum agent walk speed */
+	UPROPERTY(EditAnywhere, Category="Crowd", meta = (ClampMin = 0, ClampMax = 1000, Units = "cm/s"))
+	float MaxSpeed = 150.0f;
+
+	/** Length of each agent's patrol segment */
+	UPROPERTY(EditAnywhere, Category="Crowd", meta = (ClampMin = 0, ClampMax = 10000, Units = "cm"))
+	float PatrolLength = 800.0f;
+
+	/** Random seed for the crowd layout. Keep it the same on every machine */
+	UPROPERTY(EditAnywhere, Category="Crowd")
+	int32 Seed = 0;
+
+public:
+
+	/** Constructor */
+	ASideScrollingCrowdSpawner();
+
+protected:
+
+	/** Creates the crowd */
+	virtual void BeginPlay() override;
+
+	/** Removes the crowd */
+	virtual void EndPlay(EEndPlayReason::Type EndPlayReason) override;
+};
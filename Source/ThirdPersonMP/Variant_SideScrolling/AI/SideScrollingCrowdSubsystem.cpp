@@ -0,0 +1,569 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "SideScrollingCrowdSubsystem.h"
+#include "SideScrollingNPC.h"
+#include "SideScrollingGroundCacheSubsystem.h"
+#include "TPSPlayerCacheSubsystem.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/Controller.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+#include "ThirdPersonMP.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Crowd Agents"), STAT_SideScrollingCrowdAgents, STATGROUP_ThirdPersonMP);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Promoted Crowd NPCs"), STAT_SideScrollingCrowdPromoted, STATGROUP_ThirdPersonMP);
+DECLARE_CYCLE_STAT(TEXT("Crowd Tick"), STAT_SideScrollingCrowdTick, STATGROUP_ThirdPersonMP);
+
+namespace SideScrollingCrowd
+{
+	static float PromoteDistance = 1200.0f;
+	static FAutoConsoleVariableRef CVarPromoteDistance(
+		TEXT("TPS.SideScrolling.Crowd.PromoteDistance"),
+		PromoteDistance,
+		TEXT("Distance to the nearest player below which crowd agents are promoted to NPC actors, in cm. Should exceed the NPC StateTree's player range."));
+
+	static float DemoteDistance = 1600.0f;
+	static FAutoConsoleVariableRef CVarDemoteDistance(
+		TEXT("TPS.SideScrolling.Crowd.DemoteDistance"),
+		DemoteDistance,
+		TEXT("Distance to the nearest player beyond which promoted NPC actors return to the crowd, in cm."));
+
+	static int32 MaxActors = 16;
+	static FAutoConsoleVariableRef CVarMaxActors(
+		TEXT("TPS.SideScrolling.Crowd.MaxActors"),
+		MaxActors,
+		TEXT("Maximum number of agents each crowd can have promoted to NPC actors at once."));
+
+	static float StepHeight = 45.0f;
+	static FAutoConsoleVariableRef CVarStepHeight(
+		TEXT("TPS.SideScrolling.Crowd.StepHeight"),
+		StepHeight,
+		TEXT("Height crowd agents can step up or down while walking, in cm. Agents turn around at larger drops."));
+
+	static FAutoConsoleCommandWithWorldAndArgs BenchmarkCommand(
+		TEXT("TPS.SideScrolling.BenchCrowd"),
+		TEXT("Times the crowd simulation at 1000 and 10000 agents. Runs headless.\n")
+		TEXT("Usage: TPS.SideScrolling.BenchCrowd [NumFrames=100]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			if (USideScrollingCrowdSubsystem* Crowd = USideScrollingCrowdSubsystem::Get(World))
+			{
+				const int32 NumFrames = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 100;
+
+				// center the test on the first player, if we have one
+				FVector Origin = FVector::ZeroVector;
+
+				if (APlayerController* PC = World->GetFirstPlayerController())
+				{
+					if (APawn* Pawn = PC->GetPawn())
+					{
+						Origin = Pawn->GetActorLocation();
+					}
+				}
+
+				Crowd->RunBenchmark(Origin, { 1000, 10000 }, NumFrames);
+			}
+		}));
+
+	/** Half length of the area the benchmark agents are scattered in */
+	static constexpr float BenchmarkExtent = 20000.0f;
+}
+
+USideScrollingCrowdSubsystem* USideScrollingCrowdSubsystem::Get(const UWorld* World)
+{
+	return World ? World->GetSubsystem<USideScrollingCrowdSubsystem>() : nullptr;
+}
+
+void USideScrollingCrowdSubsystem::AddCrowd(const FSideScrollingCrowdParams& Params)
+{
+	if (!Params.Owner || Params.NumAgents <= 0)
+	{
+		return;
+	}
+
+	// replace any previous crowd from the same owner
+	RemoveCrowd(Params.Owner);
+
+	InitCrowd(Crowds.AddDefaulted_GetRef(), Params);
+
+	// pick up any NPCs that replicated in before the crowd was created
+	if (GetWorld()->GetNetMode() == NM_Client)
+	{
+		for (TActorIterator<ASideScrollingNPC> It(GetWorld()); It; ++It)
+		{
+			if (It->GetCrowdOwner() == Params.Owner)
+			{
+				BindReplicatedNPC(*It);
+			}
+		}
+	}
+}
+
+void USideScrollingCrowdSubsystem::RemoveCrowd(const UObject* Owner)
+{
+	const int32 CrowdIndex = Crowds.IndexOfByPredicate([Owner](const FCrowd& Crowd) { return Crowd.Owner == Owner; });
+
+	if (CrowdIndex == INDEX_NONE)
+	{
+		return;
+	}
+
+	// destroy the promoted actors
+	DemoteAllAgents(Crowds[CrowdIndex]);
+
+	Crowds.RemoveAtSwap(CrowdIndex);
+}
+
+void USideScrollingCrowdSubsystem::BindReplicatedNPC(ASideScrollingNPC* NPC)
+{
+	int32 AgentIndex = INDEX_NONE;
+	FCrowd* Crowd = FindReplicatedAgent(NPC, AgentIndex);
+
+	if (!Crowd)
+	{
+		return;
+	}
+
+	if (!Crowd->Promoted[AgentIndex])
+	{
+		Crowd->Promoted[AgentIndex] = true;
+		++Crowd->NumPromoted;
+	}
+
+	Crowd->Actors[AgentIndex] = NPC;
+}
+
+void USideScrollingCrowdSubsystem::UnbindReplicatedNPC(ASideScrollingNPC* NPC)
+{
+	int32 AgentIndex = INDEX_NONE;
+	FCrowd* Crowd = FindReplicatedAgent(NPC, AgentIndex);
+
+	// the agent may already have been rebound to a newer NPC
+	if (!Crowd || Crowd->Actors[AgentIndex] != NPC)
+	{
+		return;
+	}
+
+	// resume the agent from where the NPC was last seen. The server does the same when it demotes it
+	Crowd->Locations[AgentIndex] = NPC->GetActorLocation();
+	Crowd->Actors[AgentIndex].Reset();
+	Crowd->Promoted[AgentIndex] = false;
+	--Crowd->NumPromoted;
+}
+
+int32 USideScrollingCrowdSubsystem::GetNumAgents() const
+{
+	int32 NumAgents = 0;
+
+	for (const FCrowd& Crowd : Crowds)
+	{
+		NumAgents += Crowd.Locations.Num();
+	}
+
+	return NumAgents;
+}
+
+void USideScrollingCrowdSubsystem::RunBenchmark(const FVector& Origin, const TArray<int32>& AgentCounts, int32 NumFrames)
+{
+	// use the real players for the range checks, or a stand-in at the origin if we're headless
+	PlayerLocations.Reset();
+
+	if (UTPSPlayerCacheSubsystem* PlayerCache = UTPSPlayerCacheSubsystem::Get(GetWorld()))
+	{
+		for (const FTPSCachedPlayer& Player : PlayerCache->GetPlayers())
+		{
+			PlayerLocations.Add(Player.Location);
+		}
+	}
+
+	if (PlayerLocations.IsEmpty())
+	{
+		PlayerLocations.Add(Origin);
+	}
+
+	constexpr float DeltaTime = 1.0f / 60.0f;
+
+	for (const int32 AgentCount : AgentCounts)
+	{
+		// set up a crowd with no representation, spread along the side scrolling axis
+		FSideScrollingCrowdParams Params;
+		Params.NumAgents = AgentCount;
+		Params.Bounds = FBox(Origin - FVector(SideScrollingCrowd::BenchmarkExtent, 0.0f, 0.0f), Origin + FVector(SideScrollingCrowd::BenchmarkExtent, 0.0f, 200.0f));
+
+		FCrowd Crowd;
+		InitCrowd(Crowd, Params);
+
+		const double StartTime = FPlatformTime::Seconds();
+
+		for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			ProcessCrowd(Crowd, DeltaTime, false);
+		}
+
+		const double ElapsedMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+		UE_LOG(LogThirdPersonMP, Log, TEXT("Crowd benchmark: %d agents, %d frames. %.3f ms per frame, %.1f ns per agent"),
+			AgentCount,
+			NumFrames,
+			ElapsedMs / NumFrames,
+			ElapsedMs * 1000000.0 / (double(NumFrames) * AgentCount));
+	}
+}
+
+void USideScrollingCrowdSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	SCOPE_CYCLE_COUNTER(STAT_SideScrollingCrowdTick);
+
+	// drop any crowds whose owner went away without removing them, along with their promoted actors
+	for (int32 CrowdIndex = Crowds.Num() - 1; CrowdIndex >= 0; --CrowdIndex)
+	{
+		if (!Crowds[CrowdIndex].Owner.IsValid())
+		{
+			DemoteAllAgents(Crowds[CrowdIndex]);
+			Crowds.RemoveAtSwap(CrowdIndex, 1, EAllowShrinking::No);
+		}
+	}
+
+	if (Crowds.IsEmpty())
+	{
+		return;
+	}
+
+	// gather the players once for all crowds
+	PlayerLocations.Reset();
+
+	if (UTPSPlayerCacheSubsystem* PlayerCache = UTPSPlayerCacheSubsystem::Get(GetWorld()))
+	{
+		for (const FTPSCachedPlayer& Player : PlayerCache->GetPlayers())
+		{
+			PlayerLocations.Add(Player.Location);
+		}
+	}
+
+	int32 NumPromoted = 0;
+
+	// clients get the promoted set from the server's NPCs
+	const bool bAllowPromotion = GetWorld()->GetNetMode() != NM_Client;
+
+	for (FCrowd& Crowd : Crowds)
+	{
+		ProcessCrowd(Crowd, DeltaTime, bAllowPromotion);
+
+		NumPromoted += Crowd.NumPromoted;
+	}
+
+	SET_DWORD_STAT(STAT_SideScrollingCrowdAgents, GetNumAgents());
+	SET_DWORD_STAT(STAT_SideScrollingCrowdPromoted, NumPromoted);
+}
+
+TStatId USideScrollingCrowdSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USideScrollingCrowdSubsystem, STATGROUP_Tickables);
+}
+
+bool USideScrollingCrowdSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void USideScrollingCrowdSubsystem::Deinitialize()
+{
+	Crowds.Reset();
+	PlayerLocations.Reset();
+	InstanceTransforms.Reset();
+
+	Super::Deinitialize();
+}
+
+void USideScrollingCrowdSubsystem::InitCrowd(FCrowd& Crowd, const FSideScrollingCrowdParams& Params) const
+{
+	Crowd.Owner = Params.Owner;
+	Crowd.Instances = Params.Instances;
+	Crowd.NPCClass = Params.NPCClass;
+	Crowd.HalfHeight = Params.HalfHeight;
+
+	const USideScrollingGroundCacheSubsystem* GroundCache = USideScrollingGroundCacheSubsystem::Get(GetWorld());
+	Crowd.bFollowGround = GroundCache && GroundCache->IsAvailable();
+
+	const int32 NumAgents = Params.NumAgents;
+
+	Crowd.Locations.SetNumUninitialized(NumAgents);
+	Crowd.Velocities.SetNumUninitialized(NumAgents);
+	Crowd.PatrolRanges.SetNumUninitialized(NumAgents);
+	Crowd.PlayerDistancesSquared.Init(TNumericLimits<float>::Max(), NumAgents);
+	Crowd.Actors.SetNum(NumAgents);
+	Crowd.Promoted.Init(false, NumAgents);
+	Crowd.NumPromoted = 0;
+
+	FRandomStream Random(Params.Seed);
+
+	const FVector Center = Params.Bounds.GetCenter();
+	const float DropHeight = Params.Bounds.Max.Z - Params.Bounds.Min.Z;
+
+	for (int32 i = 0; i < NumAgents; ++i)
+	{
+		const float X = Random.FRandRange(Params.Bounds.Min.X, Params.Bounds.Max.X);
+		FVector Location(X, Center.Y, Params.Bounds.Max.Z);
+
+		// drop the agent onto the ground
+		float GroundZ = 0.0f;
+
+		if (Crowd.bFollowGround && GroundCache->FindGroundBelow(Location, DropHeight, FSideScrollingGroundFilter(), GroundZ))
+		{
+			Location.Z = GroundZ + Params.HalfHeight;
+		}
+
+		Crowd.Locations[i] = Location;
+
+		// walk in a random direction
+		const float Speed = Random.FRandRange(Params.MinSpeed, Params.MaxSpeed);
+		Crowd.Velocities[i] = Random.FRand() < 0.5f ? -Speed : Speed;
+
+		// patrol around the starting point
+		const float HalfPatrol = Params.PatrolLength * 0.5f;
+		Crowd.PatrolRanges[i] = FVector2f(
+			FMath::Max(X - HalfPatrol, Params.Bounds.Min.X),
+			FMath::Min(X + HalfPatrol, Params.Bounds.Max.X));
+	}
+
+	// one instance per agent
+	if (UInstancedStaticMeshComponent* Instances = Crowd.Instances.Get())
+	{
+		TArray<FTransform> Transforms;
+		Transforms.Init(FTransform::Identity, NumAgents);
+
+		Instances->ClearInstances();
+		Instances->AddInstances(Transforms, false, true);
+	}
+}
+
+void USideScrollingCrowdSubsystem::ProcessCrowd(FCrowd& Crowd, float DeltaTime, bool bAllowPromotion)
+{
+	MoveAgents(Crowd, DeltaTime);
+	UpdatePlayerDistances(Crowd);
+	UpdateLOD(Crowd, bAllowPromotion);
+	UpdateInstances(Crowd);
+}
+
+void USideScrollingCrowdSubsystem::MoveAgents(FCrowd& Crowd, float DeltaTime) const
+{
+	const USideScrollingGroundCacheSubsystem* GroundCache = Crowd.bFollowGround ? USideScrollingGroundCacheSubsystem::Get(GetWorld()) : nullptr;
+	const FSideScrollingGroundFilter Filter;
+
+	const float StepHeight = SideScrollingCrowd::StepHeight;
+
+	for (int32 i = 0; i < Crowd.Locations.Num(); ++i)
+	{
+		// promoted agents are moved by their actor
+		if (Crowd.Promoted[i])
+		{
+			continue;
+		}
+
+		FVector& Location = Crowd.Locations[i];
+		float& Velocity = Crowd.Velocities[i];
+		const FVector2f& PatrolRange = Crowd.PatrolRanges[i];
+
+		const float NewX = Location.X + Velocity * DeltaTime;
+
+		// turn around at the ends of the patrol segment
+		bool bTurn = NewX < PatrolRange.X || NewX > PatrolRange.Y;
+
+		// follow the ground, and turn around at ledges
+		if (!bTurn && GroundCache)
+		{
+			const FVector Feet(NewX, Location.Y, Location.Z - Crowd.HalfHeight + StepHeight);
+			float GroundZ = 0.0f;
+
+			if (GroundCache->FindGroundBelow(Feet, StepHeight * 2.0f, Filter, GroundZ))
+			{
+				Location.Z = GroundZ + Crowd.HalfHeight;
+			}
+			else
+			{
+				bTurn = true;
+			}
+		}
+
+		if (bTurn)
+		{
+			Velocity = -Velocity;
+		}
+		else
+		{
+			Location.X = NewX;
+		}
+	}
+}
+
+void USideScrollingCrowdSubsystem::UpdatePlayerDistances(FCrowd& Crowd) const
+{
+	// same range test as the NPC StateTree's Get Player task, run over the whole crowd at once
+	for (int32 i = 0; i < Crowd.Locations.Num(); ++i)
+	{
+		const FVector& Location = Crowd.Locations[i];
+		float NearestDistSquared = TNumericLimits<float>::Max();
+
+		for (const FVector& PlayerLocation : PlayerLocations)
+		{
+			NearestDistSquared = FMath::Min(NearestDistSquared, static_cast<float>(FVector::DistSquared(Location, PlayerLocation)));
+		}
+
+		Crowd.PlayerDistancesSquared[i] = NearestDistSquared;
+	}
+}
+
+void USideScrollingCrowdSubsystem::UpdateLOD(FCrowd& Crowd, bool bAllowPromotion)
+{
+	const float PromoteDistSquared = FMath::Square(SideScrollingCrowd::PromoteDistance);
+	const float DemoteDistSquared = FMath::Square(FMath::Max(SideScrollingCrowd::DemoteDistance, SideScrollingCrowd::PromoteDistance));
+
+	for (int32 i = 0; i < Crowd.Locations.Num(); ++i)
+	{
+		const float DistSquared = Crowd.PlayerDistancesSquared[i];
+
+		if (Crowd.Promoted[i])
+		{
+			ASideScrollingNPC* NPC = Crowd.Actors[i].Get();
+
+			// keep the agent in sync with its actor so it resumes from the same place
+			if (NPC)
+			{
+				Crowd.Locations[i] = NPC->GetActorLocation();
+			}
+
+			// demote once the players are far enough, unless the NPC is still reacting to an interaction
+			if (bAllowPromotion && DistSquared > DemoteDistSquared && (!NPC || !NPC->bDeactivated))
+			{
+				DemoteAgent(Crowd, i);
+			}
+		}
+		else if (bAllowPromotion && DistSquared < PromoteDistSquared && Crowd.NumPromoted < SideScrollingCrowd::MaxActors)
+		{
+			PromoteAgent(Crowd, i);
+		}
+	}
+}
+
+void USideScrollingCrowdSubsystem::UpdateInstances(FCrowd& Crowd)
+{
+	UInstancedStaticMeshComponent* Instances = Crowd.Instances.Get();
+
+	if (!Instances || Instances->GetInstanceCount() != Crowd.Locations.Num())
+	{
+		return;
+	}
+
+	InstanceTransforms.Reset(Crowd.Locations.Num());
+
+	const FVector FeetOffset(0.0f, 0.0f, Crowd.HalfHeight);
+	const FQuat FacingForward = FQuat::Identity;
+	const FQuat FacingBackward = FRotator(0.0f, 180.0f, 0.0f).Quaternion();
+
+	for (int32 i = 0; i < Crowd.Locations.Num(); ++i)
+	{
+		// hide promoted agents by collapsing their instance
+		if (Crowd.Promoted[i])
+		{
+			InstanceTransforms.Emplace(FQuat::Identity, Crowd.Locations[i], FVector::ZeroVector);
+			continue;
+		}
+
+		InstanceTransforms.Emplace(Crowd.Velocities[i] >= 0.0f ? FacingForward : FacingBackward, Crowd.Locations[i] - FeetOffset);
+	}
+
+	Instances->BatchUpdateInstancesTransforms(0, InstanceTransforms, true, true, false);
+}
+
+bool USideScrollingCrowdSubsystem::PromoteAgent(FCrowd& Crowd, int32 AgentIndex)
+{
+	if (!Crowd.NPCClass)
+	{
+		return false;
+	}
+
+	const FRotator Rotation(0.0f, Crowd.Velocities[AgentIndex] >= 0.0f ? 0.0f : 180.0f, 0.0f);
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+	SpawnParams.bDeferConstruction = true;
+
+	ASideScrollingNPC* NPC = GetWorld()->SpawnActor<ASideScrollingNPC>(Crowd.NPCClass, Crowd.Locations[AgentIndex], Rotation, SpawnParams);
+
+	if (!NPC)
+	{
+		return false;
+	}
+
+	// tag the NPC with its agent before it replicates, so clients can hide their copy of the agent
+	NPC->SetCrowdAgent(Cast<AActor>(const_cast<UObject*>(Crowd.Owner.Get())), AgentIndex);
+	NPC->FinishSpawning(FTransform(Rotation, Crowd.Locations[AgentIndex]));
+
+	// spawned NPCs aren't possessed automatically unless their class asks for it
+	if (!NPC->GetController())
+	{
+		NPC->SpawnDefaultController();
+	}
+
+	Crowd.Actors[AgentIndex] = NPC;
+
+	Crowd.Promoted[AgentIndex] = true;
+	++Crowd.NumPromoted;
+
+	return true;
+}
+
+void USideScrollingCrowdSubsystem::DemoteAgent(FCrowd& Crowd, int32 AgentIndex)
+{
+	// clients leave replicated NPCs to the server
+	ASideScrollingNPC* NPC = Crowd.Actors[AgentIndex].Get();
+
+	if (NPC && NPC->HasAuthority())
+	{
+		// destroy the AI controller along with the NPC
+		if (AController* Controller = NPC->GetController())
+		{
+			Controller->Destroy();
+		}
+
+		NPC->Destroy();
+	}
+
+	Crowd.Actors[AgentIndex].Reset();
+	Crowd.Promoted[AgentIndex] = false;
+	--Crowd.NumPromoted;
+}
+
+USideScrollingCrowdSubsystem::FCrowd* USideScrollingCrowdSubsystem::FindReplicatedAgent(const ASideScrollingNPC* NPC, int32& OutAgentIndex)
+{
+	const AActor* CrowdOwner = NPC ? NPC->GetCrowdOwner() : nullptr;
+
+	if (!CrowdOwner)
+	{
+		return nullptr;
+	}
+
+	FCrowd* Crowd = Crowds.FindByPredicate([CrowdOwner](const FCrowd& Candidate) { return Candidate.Owner == CrowdOwner; });
+
+	OutAgentIndex = NPC->GetCrowdAgentIndex();
+
+	return Crowd && Crowd->Locations.IsValidIndex(OutAgentIndex) ? Crowd : nullptr;
+}
+
+void USideScrollingCrowdSubsystem::DemoteAllAgents(FCrowd& Crowd)
+{
+	for (int32 i = 0; i < Crowd.Promoted.Num(); ++i)
+	{
+		if (Crowd.Promoted[i])
+		{
+			DemoteAgent(Crowd, i);
+		}
+	}
+}
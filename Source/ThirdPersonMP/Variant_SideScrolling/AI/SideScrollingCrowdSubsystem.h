@@ -0,0 +1,176 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SideScrollingCrowdSubsystem.generated.h"
+
+class ASideScrollingNPC;
+class UInstancedStaticMeshComponent;
+
+/**
+ *  Settings used to populate a crowd
+ */
+struct FSideScrollingCrowdParams
+{
+	/** Object that owns the crowd */
+	const UObject* Owner = nullptr;
+
+	/** Instanced mesh representing the agents that haven't been promoted to actors. Optional */
+	UInstancedStaticMeshComponent* Instances = nullptr;
+
+	/** NPC class agents are promoted to. If unset, agents are never promoted */
+	TSubclassOf<ASideScrollingNPC> NPCClass;
+
+	/** Area the agents are scattered in. Agents are dropped to the ground from the top of the area */
+	FBox Bounds = FBox(ForceInit);
+
+	/** Number of agents to create */
+	int32 NumAgents = 0;
+
+	/** Range of agent walk speeds */
+	float MinSpeed = 100.0f;
+	float MaxSpeed = 150.0f;
+
+	/** Length of each agent's patrol segment */
+	float PatrolLength = 800.0f;
+
+	/** Half height of the agents, used to stand them on the ground */
+	float HalfHeight = 90.0f;
+
+	/** Random seed, so the crowd is laid out the same way on every machine */
+	int32 Seed = 0;
+};
+
+/**
+ *  Lightweight simulation for large background crowds of side scrolling NPCs.
+ *  Agents are plain data, stored as one array per fragment so each processing pass only touches what it needs:
+ *  a patrol pass walks agents along the ground cache, a bulk pass finds each agent's distance to the nearest player,
+ *  and a LOD pass promotes agents near a player to full ASideScrollingNPC actors, where their StateTree
+ *  and interactions take over, and demotes them back to data once the players move away.
+ *  Only the server decides which agents are promoted. Each NPC replicates the agent it was promoted from,
+ *  and clients hide that agent and follow the NPC until it's destroyed, so both sides agree on the promoted set.
+ */
+UCLASS()
+class USideScrollingCrowdSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+	/** A single crowd, stored as fragment arrays indexed by agent */
+	struct FCrowd
+	{
+		/** Object that owns the crowd. Null for benchmark crowds */
+		TWeakObjectPtr<const UObject> Owner;
+
+		/** Instanced mesh representing the crowd */
+		TWeakObjectPtr<UInstancedStaticMeshComponent> Instances;
+
+		/** NPC class agents are promoted to */
+		TSubclassOf<ASideScrollingNPC> NPCClass;
+
+		/** Half height of the agents */
+		float HalfHeight = 90.0f;
+
+		/** If true, agents follow the ground cache as they walk */
+		bool bFollowGround = false;
+
+		/** Agent locations, at the center of their capsules */
+		TArray<FVector> Locations;
+
+		/** Agent velocities along the side scrolling axis */
+		TArray<float> Velocities;
+
+		/** Agent patrol segments along the side scrolling axis */
+		TArray<FVector2f> PatrolRanges;
+
+		/** Squared distance from each agent to the nearest player */
+		TArray<float> PlayerDistancesSquared;
+
+		/** Actors agents have been promoted to */
+		TArray<TWeakObjectPtr<ASideScrollingNPC>> Actors;
+
+		/** Set for agents that are currently represented by an actor, or hidden on clients */
+		TBitArray<> Promoted;
+
+		/** Number of promoted agents */
+		int32 NumPromoted = 0;
+	};
+
+	/** Active crowds */
+	TArray<FCrowd> Crowds;
+
+	/** Player locations gathered for this frame's range checks */
+	TArray<FVector> PlayerLocations;
+
+	/** Instance transforms scratch buffer */
+	TArray<FTransform> InstanceTransforms;
+
+public:
+
+	/** Returns the subsystem for the provided world, if any */
+	static USideScrollingCrowdSubsystem* Get(const UWorld* World);
+
+	/** Creates a crowd */
+	void AddCrowd(const FSideScrollingCrowdParams& Params);
+
+	/** Removes a crowd and destroys any actors its agents were promoted to */
+	void RemoveCrowd(const UObject* Owner);
+
+	/** Hides the client agent a replicated NPC was promoted from, and keeps the agent on the NPC until it goes away */
+	void BindReplicatedNPC(ASideScrollingNPC* NPC);
+
+	/** Returns the agent of a replicated NPC that went away to the client's crowd */
+	void UnbindReplicatedNPC(ASideScrollingNPC* NPC);
+
+	/** Returns the total number of agents across all crowds */
+	int32 GetNumAgents() const;
+
+	/** Simulates benchmark crowds of each size for a number of frames and logs the timings */
+	void RunBenchmark(const FVector& Origin, const TArray<int32>& AgentCounts, int32 NumFrames);
+
+public:
+
+	// ~begin FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	// ~end FTickableGameObject interface
+
+protected:
+
+	/** Only create this subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Cleanup */
+	virtual void Deinitialize() override;
+
+	/** Fills in a crowd's agents */
+	void InitCrowd(FCrowd& Crowd, const FSideScrollingCrowdParams& Params) const;
+
+	/** Runs all processing passes on a crowd */
+	void ProcessCrowd(FCrowd& Crowd, float DeltaTime, bool bAllowPromotion);
+
+	/** Walks the agents along their patrol segments */
+	void MoveAgents(FCrowd& Crowd, float DeltaTime) const;
+
+	/** Finds the distance from every agent to the nearest player */
+	void UpdatePlayerDistances(FCrowd& Crowd) const;
+
+	/** Promotes agents near players to actors and demotes the ones players moved away from. Without promotion, only keeps promoted agents on their actors */
+	void UpdateLOD(FCrowd& Crowd, bool bAllowPromotion);
+
+	/** Returns the crowd and agent index a replicated NPC was promoted from, or nullptr */
+	FCrowd* FindReplicatedAgent(const ASideScrollingNPC* NPC, int32& OutAgentIndex);
+
+	/** Pushes the agent transforms to the instanced mesh */
+	void UpdateInstances(FCrowd& Crowd);
+
+	/** Spawns the actor for an agent. Returns false if the agent could not be promoted */
+	bool PromoteAgent(FCrowd& Crowd, int32 AgentIndex);
+
+	/** Returns an agent to the data simulation */
+	void DemoteAgent(FCrowd& Crowd, int32 AgentIndex);
+
+	/** Returns every promoted agent in a crowd to the data simulation */
+	void DemoteAllAgents(FCrowd& Crowd);
+};
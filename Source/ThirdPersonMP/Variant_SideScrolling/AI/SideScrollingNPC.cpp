@@ -5,6 +5,8 @@
 #include "Engine/World.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "TimerManager.h"
+#include "Net/UnrealNetwork.h"
+#include "SideScrollingCrowdSubsystem.h"
 
 ASideScrollingNPC::ASideScrollingNPC()
 {
@@ -19,6 +21,37 @@ void ASideScrollingNPC::EndPlay(EEndPlayReason::Type EndPlayReason)
 
 	// clear the deactivation timer
 	GetWorld()->GetTimerManager().ClearTimer(DeactivationTimer);
+
+	// give the crowd agent back to the client's crowd
+	if (!HasAuthority() && CrowdAgentIndex != INDEX_NONE)
+	{
+		if (USideScrollingCrowdSubsystem* Crowd = USideScrollingCrowdSubsystem::Get(GetWorld()))
+		{
+			Crowd->UnbindReplicatedNPC(this);
+		}
+	}
+}
+
+void ASideScrollingNPC::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME_CONDITION(ASideScrollingNPC, CrowdOwner, COND_InitialOnly);
+	DOREPLIFETIME_CONDITION(ASideScrollingNPC, CrowdAgentIndex, COND_InitialOnly);
+}
+
+void ASideScrollingNPC::SetCrowdAgent(AActor* InCrowdOwner, int32 AgentIndex)
+{
+	CrowdOwner = InCrowdOwner;
+	CrowdAgentIndex = AgentIndex;
+}
+
+void ASideScrollingNPC::OnRep_CrowdAgent()
+{
+	if (USideScrollingCrowdSubsystem* Crowd = USideScrollingCrowdSubsystem::Get(GetWorld()))
+	{
+		Crowd->BindReplicatedNPC(this);
+	}
 }
 
 void ASideScrollingNPC::Interaction(AActor* Interactor)
@@ -40,6 +40,16 @@ public:
 	/** Timer to reactivate the NPC */
 	FTimerHandle DeactivationTimer;
 
+protected:
+
+	/** Crowd spawner this NPC was promoted from, if any. Level placed spawners are stably named, so the reference resolves on clients */
+	UPROPERTY(Replicated)
+	TObjectPtr<AActor> CrowdOwner;
+
+	/** Index of the crowd agent this NPC represents, or INDEX_NONE */
+	UPROPERTY(ReplicatedUsing = OnRep_CrowdAgent)
+	int32 CrowdAgentIndex = INDEX_NONE;
+
 public:
 
 	/** Constructor */
@@ -50,6 +60,24 @@ public:
 	/** Cleanup */
 	virtual void EndPlay(EEndPlayReason::Type EndPlayReason) override;
 
+	/** Sets up property replication */
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	/** Records the crowd agent this NPC was promoted from, so clients can hide their copy of it */
+	void SetCrowdAgent(AActor* InCrowdOwner, int32 AgentIndex);
+
+	/** Returns the crowd spawner this NPC was promoted from, if any */
+	const AActor* GetCrowdOwner() const { return CrowdOwner; }
+
+	/** Returns the index of the crowd agent this NPC represents, or INDEX_NONE */
+	int32 GetCrowdAgentIndex() const { return CrowdAgentIndex; }
+
+protected:
+
+	/** Hides the client's copy of the crowd agent */
+	UFUNCTION()
+	void OnRep_CrowdAgent();
+
 public:
 
 //	~begin IInteractable interface 
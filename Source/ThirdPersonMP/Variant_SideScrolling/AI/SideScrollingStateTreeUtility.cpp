@@ -5,20 +5,32 @@
 #include "StateTreeExecutionContext.h"
 #include "StateTreeExecutionTypes.h"
 #include "AIController.h"
-#include "Kismet/GameplayStatics.h"
+#include "TPSPlayerCacheSubsystem.h"
+#include "ThirdPersonMPStats.h"
 
 EStateTreeRunStatus FStateTreeGetPlayerTask::Tick(FStateTreeExecutionContext& Context, const float DeltaTime) const
 {
+	TPS_SCOPED_TIMER(StateTreeTaskTick, TPSAI);
+
 	// get the instance data
 	FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
 
-	// set the player pawn as the target
-	InstanceData.TargetPlayer = UGameplayStatics::GetPlayerPawn(InstanceData.Controller.Get(), 0);
+	// set the nearest player pawn as the target
+	InstanceData.TargetPlayer = nullptr;
+	InstanceData.bValidTarget = false;
 
-	// are the NPC and target valid?
-	if (IsValid(InstanceData.TargetPlayer) && IsValid(InstanceData.NPC))
+	if (IsValid(InstanceData.NPC))
 	{
-		InstanceData.bValidTarget = FVector::Distance(InstanceData.NPC->GetActorLocation(), InstanceData.TargetPlayer->GetActorLocation()) < InstanceData.RangeMax;
+		if (UTPSPlayerCacheSubsystem* PlayerCache = UTPSPlayerCacheSubsystem::Get(InstanceData.NPC->GetWorld()))
+		{
+			if (const FTPSCachedPlayer* NearestPlayer = PlayerCache->FindNearestPlayer(InstanceData.NPC->GetActorLocation()))
+			{
+				InstanceData.TargetPlayer = NearestPlayer->Pawn.Get();
+
+				// is the target close enough?
+				InstanceData.bValidTarget = FVector::Distance(InstanceData.NPC->GetActorLocation(), NearestPlayer->Location) < InstanceData.RangeMax;
+			}
+		}
 	}
 
 	return EStateTreeRunStatus::Running;
@@ -0,0 +1,298 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "SideScrollingGroundCacheSubsystem.h"
+#include "Components/PrimitiveComponent.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerStart.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "Algo/BinarySearch.h"
+#include "HAL/IConsoleManager.h"
+#include "ThirdPersonMP.h"
+
+namespace SideScrollingGroundCache
+{
+	static bool bEnabled = true;
+	static FAutoConsoleVariableRef CVarEnabled(
+		TEXT("TPS.SideScrolling.GroundCache"),
+		bEnabled,
+		TEXT("If true, ground checks under side scrolling characters use the cached heightfield instead of traces."));
+
+	static float ColumnWidth = 25.0f;
+	static FAutoConsoleVariableRef CVarColumnWidth(
+		TEXT("TPS.SideScrolling.GroundCacheColumnWidth"),
+		ColumnWidth,
+		TEXT("Width of a ground cache column, in cm. Applied the next time the cache is built."));
+
+	/** Distance from the side scrolling plane within which geometry is considered ground */
+	static constexpr float PlaneTolerance = 50.0f;
+
+	/** Extra columns added on either side of the level so moving platforms stay covered */
+	static constexpr float RangePadding = 2000.0f;
+
+	/** Maximum number of columns, to bound memory on very long levels */
+	static constexpr int32 MaxColumns = 1 << 16;
+
+	static FAutoConsoleCommandWithWorld RebuildCommand(
+		TEXT("TPS.SideScrolling.RebuildGroundCache"),
+		TEXT("Rebuilds the side scrolling ground cache from the level geometry."),
+		FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+		{
+			if (USideScrollingGroundCacheSubsystem* GroundCache = USideScrollingGroundCacheSubsystem::Get(World))
+			{
+				GroundCache->Rebuild();
+			}
+		}));
+}
+
+USideScrollingGroundCacheSubsystem* USideScrollingGroundCacheSubsystem::Get(const UWorld* World)
+{
+	return World ? World->GetSubsystem<USideScrollingGroundCacheSubsystem>() : nullptr;
+}
+
+bool USideScrollingGroundCacheSubsystem::IsAvailable() const
+{
+	return SideScrollingGroundCache::bEnabled && !Columns.IsEmpty();
+}
+
+bool USideScrollingGroundCacheSubsystem::FindGroundBelow(const FVector& Location, float MaxDistance, const FSideScrollingGroundFilter& Filter, float& OutGroundZ) const
+{
+	const int32 ColumnIndex = GetColumnIndex(Location.X);
+
+	if (!Columns.IsValidIndex(ColumnIndex))
+	{
+		return false;
+	}
+
+	const float MinZ = Location.Z - MaxDistance;
+
+	// samples are sorted top to bottom, so the first one below us that passes the filter is the ground
+	for (const FGroundSample& Sample : Columns[ColumnIndex])
+	{
+		if (Sample.Z > Location.Z)
+		{
+			continue;
+		}
+
+		if (Sample.Z < MinZ)
+		{
+			break;
+		}
+
+		const FGroundSurface& Surface = Surfaces[Sample.SurfaceIndex];
+
+		if (Filter.ObjectType != ECC_MAX && Surface.ObjectType != Filter.ObjectType)
+		{
+			continue;
+		}
+
+		if (Filter.bVisibilityBlockersOnly && !Surface.bBlocksVisibility)
+		{
+			continue;
+		}
+
+		OutGroundZ = Sample.Z;
+		return true;
+	}
+
+	return false;
+}
+
+void USideScrollingGroundCacheSubsystem::Rebuild()
+{
+	Surfaces.Reset();
+	DynamicSurfaces.Reset();
+	Columns.Reset();
+
+	UWorld* World = GetWorld();
+
+	// use the first player start to find the side scrolling plane
+	for (TActorIterator<APlayerStart> It(World); It; ++It)
+	{
+		PlaneY = It->GetActorLocation().Y;
+		break;
+	}
+
+	// gather the surfaces and the range they cover
+	float MinX = TNumericLimits<float>::Max();
+	float MaxX = TNumericLimits<float>::Lowest();
+
+	for (TActorIterator<AActor> It(World); It; ++It)
+	{
+		// characters aren't ground
+		if (It->IsA<APawn>())
+		{
+			continue;
+		}
+
+		It->ForEachComponent<UPrimitiveComponent>(false, [&](UPrimitiveComponent* Component)
+		{
+			if (!IsGroundComponent(Component))
+			{
+				return;
+			}
+
+			FGroundSurface& Surface = Surfaces.AddDefaulted_GetRef();
+			Surface.Component = Component;
+			Surface.ObjectType = Component->GetCollisionObjectType();
+			Surface.bBlocksVisibility = Component->GetCollisionResponseToChannel(ECC_Visibility) == ECR_Block;
+			UpdateSurfaceBounds(Surface, Component->Bounds.GetBox());
+
+			if (Component->Mobility == EComponentMobility::Movable)
+			{
+				DynamicSurfaces.Add(Surfaces.Num() - 1);
+			}
+
+			MinX = FMath::Min(MinX, Surface.MinX);
+			MaxX = FMath::Max(MaxX, Surface.MaxX);
+		});
+	}
+
+	if (Surfaces.IsEmpty())
+	{
+		return;
+	}
+
+	// size the heightfield to the level plus some padding
+	ColumnWidth = FMath::Max(1.0f, SideScrollingGroundCache::ColumnWidth);
+	OriginX = MinX - SideScrollingGroundCache::RangePadding;
+
+	const float RangeX = (MaxX + SideScrollingGroundCache::RangePadding) - OriginX;
+	const int32 NumColumns = FMath::CeilToInt32(RangeX / ColumnWidth);
+
+	if (NumColumns > SideScrollingGroundCache::MaxColumns)
+	{
+		UE_LOG(LogThirdPersonMP, Warning, TEXT("Side scrolling ground cache would need %d columns, widening them to stay under %d."), NumColumns, SideScrollingGroundCache::MaxColumns);
+
+		ColumnWidth = RangeX / SideScrollingGroundCache::MaxColumns;
+	}
+
+	Columns.SetNum(FMath::Min(NumColumns, SideScrollingGroundCache::MaxColumns));
+
+	// sample every surface into its columns
+	for (int32 SurfaceIndex = 0; SurfaceIndex < Surfaces.Num(); ++SurfaceIndex)
+	{
+		AddSamples(SurfaceIndex);
+	}
+
+	UE_LOG(LogThirdPersonMP, Log, TEXT("Side scrolling ground cache built: %d surfaces (%d movable), %d columns of %.0f cm."), Surfaces.Num(), DynamicSurfaces.Num(), Columns.Num(), ColumnWidth);
+}
+
+void USideScrollingGroundCacheSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	// re-sample any movable surfaces that have moved, and drop the ones whose component went away
+	DynamicSurfaces.RemoveAllSwap([this](int32 SurfaceIndex)
+	{
+		FGroundSurface& Surface = Surfaces[SurfaceIndex];
+		const UPrimitiveComponent* Component = Surface.Component.Get();
+
+		if (!Component)
+		{
+			RemoveSamples(SurfaceIndex);
+			return true;
+		}
+
+		const FBox Bounds = Component->Bounds.GetBox();
+
+		if (!FMath::IsNearlyEqual(Bounds.Max.Z, Surface.TopZ, 1.0f) || !FMath::IsNearlyEqual(Bounds.Min.X, Surface.MinX, 1.0f) || !FMath::IsNearlyEqual(Bounds.Max.X, Surface.MaxX, 1.0f))
+		{
+			RemoveSamples(SurfaceIndex);
+			UpdateSurfaceBounds(Surface, Bounds);
+			AddSamples(SurfaceIndex);
+		}
+
+		return false;
+
+	}, EAllowShrinking::No);
+}
+
+TStatId USideScrollingGroundCacheSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USideScrollingGroundCacheSubsystem, STATGROUP_Tickables);
+}
+
+bool USideScrollingGroundCacheSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void USideScrollingGroundCacheSubsystem::Deinitialize()
+{
+	Surfaces.Reset();
+	DynamicSurfaces.Reset();
+	Columns.Reset();
+
+	Super::Deinitialize();
+}
+
+void USideScrollingGroundCacheSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	Rebuild();
+}
+
+bool USideScrollingGroundCacheSubsystem::IsGroundComponent(const UPrimitiveComponent* Component) const
+{
+	if (!Component->IsRegistered() || !Component->IsCollisionEnabled())
+	{
+		return false;
+	}
+
+	// characters need to be able to stand on it
+	if (Component->GetCollisionResponseToChannel(ECC_Pawn) != ECR_Block)
+	{
+		return false;
+	}
+
+	// skip geometry in front of or behind the side scrolling plane
+	const FBox Bounds = Component->Bounds.GetBox();
+
+	return Bounds.Min.Y - SideScrollingGroundCache::PlaneTolerance <= PlaneY && Bounds.Max.Y + SideScrollingGroundCache::PlaneTolerance >= PlaneY;
+}
+
+int32 USideScrollingGroundCacheSubsystem::GetColumnIndex(float X) const
+{
+	return FMath::FloorToInt32((X - OriginX) / ColumnWidth);
+}
+
+void USideScrollingGroundCacheSubsystem::AddSamples(int32 SurfaceIndex)
+{
+	const FGroundSurface& Surface = Surfaces[SurfaceIndex];
+
+	const int32 FirstColumn = FMath::Max(0, GetColumnIndex(Surface.MinX));
+	const int32 LastColumn = FMath::Min(Columns.Num() - 1, GetColumnIndex(Surface.MaxX));
+
+	for (int32 ColumnIndex = FirstColumn; ColumnIndex <= LastColumn; ++ColumnIndex)
+	{
+		FGroundColumn& Column = Columns[ColumnIndex];
+
+		// keep the column sorted from highest to lowest
+		const int32 InsertIndex = Algo::LowerBoundBy(Column, -Surface.TopZ, [](const FGroundSample& Sample) { return -Sample.Z; });
+
+		Column.Insert(FGroundSample{ Surface.TopZ, SurfaceIndex }, InsertIndex);
+	}
+}
+
+void USideScrollingGroundCacheSubsystem::RemoveSamples(int32 SurfaceIndex)
+{
+	const FGroundSurface& Surface = Surfaces[SurfaceIndex];
+
+	const int32 FirstColumn = FMath::Max(0, GetColumnIndex(Surface.MinX));
+	const int32 LastColumn = FMath::Min(Columns.Num() - 1, GetColumnIndex(Surface.MaxX));
+
+	for (int32 ColumnIndex = FirstColumn; ColumnIndex <= LastColumn; ++ColumnIndex)
+	{
+		Columns[ColumnIndex].RemoveAll([SurfaceIndex](const FGroundSample& Sample) { return Sample.SurfaceIndex == SurfaceIndex; });
+	}
+}
+
+void USideScrollingGroundCacheSubsystem::UpdateSurfaceBounds(FGroundSurface& Surface, const FBox& Bounds)
+{
+	Surface.MinX = Bounds.Min.X;
+	Surface.MaxX = Bounds.Max.X;
+	Surface.TopZ = Bounds.Max.Z;
+}
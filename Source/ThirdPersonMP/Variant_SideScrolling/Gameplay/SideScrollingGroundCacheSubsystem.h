@@ -0,0 +1,134 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Engine/EngineTypes.h"
+#include "SideScrollingGroundCacheSubsystem.generated.h"
+
+class UPrimitiveComponent;
+
+/**
+ *  Filters applied to ground cache queries
+ */
+struct FSideScrollingGroundFilter
+{
+	/** If set to anything other than ECC_MAX, only surfaces of this object type will be returned */
+	ECollisionChannel ObjectType = ECC_MAX;
+
+	/** If true, only surfaces that block the visibility channel will be returned */
+	bool bVisibilityBlockersOnly = false;
+};
+
+/**
+ *  Caches the walkable surfaces of the level along the side scrolling plane as a layered 1D heightfield along X.
+ *  Static geometry is sampled once when play begins, and movable geometry such as moving platforms is
+ *  re-sampled incrementally as it moves, so "ground below this point" queries are a column lookup
+ *  instead of a physics trace.
+ *  Surfaces are sampled from the top of each component's bounds, so the cache suits the box-shaped geometry
+ *  side scrolling levels are built from.
+ */
+UCLASS()
+class USideScrollingGroundCacheSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+	/** A single cached surface */
+	struct FGroundSurface
+	{
+		/** Component the surface was sampled from */
+		TWeakObjectPtr<UPrimitiveComponent> Component;
+
+		/** Horizontal extent of the surface */
+		float MinX = 0.0f;
+		float MaxX = 0.0f;
+
+		/** Height of the top of the surface */
+		float TopZ = 0.0f;
+
+		/** Object type of the component */
+		TEnumAsByte<ECollisionChannel> ObjectType = ECC_WorldStatic;
+
+		/** If true, the component blocks the visibility channel */
+		bool bBlocksVisibility = false;
+	};
+
+	/** A surface sampled into a column */
+	struct FGroundSample
+	{
+		/** Height of the surface in this column */
+		float Z = 0.0f;
+
+		/** Index of the surface */
+		int32 SurfaceIndex = INDEX_NONE;
+	};
+
+	/** Samples in a single column, sorted from highest to lowest */
+	using FGroundColumn = TArray<FGroundSample, TInlineAllocator<4>>;
+
+	/** Cached surfaces */
+	TArray<FGroundSurface> Surfaces;
+
+	/** Indices of the surfaces sampled from movable components */
+	TArray<int32> DynamicSurfaces;
+
+	/** Heightfield columns */
+	TArray<FGroundColumn> Columns;
+
+	/** X coordinate of the start of the first column */
+	float OriginX = 0.0f;
+
+	/** Width of a column, latched when the cache is built */
+	float ColumnWidth = 25.0f;
+
+	/** Y coordinate of the side scrolling plane */
+	float PlaneY = 0.0f;
+
+public:
+
+	/** Returns the subsystem for the provided world, if any */
+	static USideScrollingGroundCacheSubsystem* Get(const UWorld* World);
+
+	/** Returns true if ground caching is enabled and the cache has been built */
+	bool IsAvailable() const;
+
+	/** Finds the highest cached surface at or below the location, within MaxDistance. Returns false if there is none */
+	bool FindGroundBelow(const FVector& Location, float MaxDistance, const FSideScrollingGroundFilter& Filter, float& OutGroundZ) const;
+
+	/** Rebuilds the whole cache from the level geometry */
+	void Rebuild();
+
+public:
+
+	// ~begin FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	// ~end FTickableGameObject interface
+
+protected:
+
+	/** Only create this subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Cleanup */
+	virtual void Deinitialize() override;
+
+	/** Builds the cache once the level is loaded */
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	/** Returns true if the component is something characters can stand on, along the side scrolling plane */
+	bool IsGroundComponent(const UPrimitiveComponent* Component) const;
+
+	/** Returns the column index containing the X coordinate */
+	int32 GetColumnIndex(float X) const;
+
+	/** Adds a surface's samples to the columns it covers */
+	void AddSamples(int32 SurfaceIndex);
+
+	/** Removes a surface's samples from the columns it covers */
+	void RemoveSamples(int32 SurfaceIndex);
+
+	/** Updates a surface's extents from its component's current bounds */
+	static void UpdateSurfaceBounds(FGroundSurface& Surface, const FBox& Bounds);
+};
@@ -2,6 +2,7 @@
 
 
 #include "SideScrollingMovingPlatform.h"
+#include "SideScrollingPlatformMoverComponent.h"
 #include "Components/SceneComponent.h"
 
 ASideScrollingMovingPlatform::ASideScrollingMovingPlatform()
@@ -10,12 +11,45 @@ ASideScrollingMovingPlatform::ASideScrollingMovingPlatform()
 
 	// create the root comp
 	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+
+	// create the mover
+	Mover = CreateDefaultSubobject<USideScrollingPlatformMoverComponent>(TEXT("Mover"));
+
+	// only the mover's start time and path are replicated. Clients compute the platform's location locally,
+	// so the platform can sleep between moves
+	bReplicates = true;
+	SetReplicatingMovement(false);
+	NetDormancy = DORM_DormantAll;
+}
+
+void ASideScrollingMovingPlatform::BeginPlay()
+{
+	// build the paths before the mover starts play so it can pick up any replicated move
+	if (bNativeMovement)
+	{
+		const FVector TargetOffset = PlatformTarget - GetActorLocation();
+
+		TArray<FSideScrollingPlatformPath> Paths;
+
+		FSideScrollingPlatformPath& ToTarget = Paths.AddDefaulted_GetRef();
+		ToTarget.Points = { FVector::ZeroVector, TargetOffset };
+		ToTarget.Duration = MoveDuration;
+
+		FSideScrollingPlatformPath& Return = Paths.AddDefaulted_GetRef();
+		Return.Points = { TargetOffset, FVector::ZeroVector };
+		Return.Duration = MoveDuration;
+
+		Mover->SetPaths(Paths);
+		Mover->OnMoveFinished.BindUObject(this, &ASideScrollingMovingPlatform::OnMoveFinished);
+	}
+
+	Super::BeginPlay();
 }
 
 void ASideScrollingMovingPlatform::Interaction(AActor* Interactor)
 {
-	// ignore interactions if we're already moving
-	if (bMoving)
+	// ignore interactions if we're already moving. Native moves are only started by the server
+	if (bMoving || (bNativeMovement && !HasAuthority()))
 	{
 		return;
 	}
@@ -23,6 +57,13 @@ void ASideScrollingMovingPlatform::Interaction(AActor* Interactor)
 	// raise the movement flag
 	bMoving = true;
 
+	// move natively. Clients follow through the replicated move
+	if (bNativeMovement)
+	{
+		Mover->StartMove(ToTargetPath);
+		return;
+	}
+
 	// pass control to BP for the actual movement
 	BP_MoveToTarget();
 }
@@ -38,3 +79,24 @@ void ASideScrollingMovingPlatform::ResetInteraction()
 	// reset the movement flag
 	bMoving = false;
 }
+
+void ASideScrollingMovingPlatform::OnMoveFinished(int32 PathId)
+{
+	// only the server chains moves
+	if (!HasAuthority())
+	{
+		return;
+	}
+
+	// start the return move exactly when the first one ended, so both machines agree on the timing
+	if (PathId == ToTargetPath && !bOneShot)
+	{
+		Mover->StartMove(ReturnPath, Mover->GetMoveEndTime());
+		return;
+	}
+
+	if (PathId == ReturnPath)
+	{
+		ResetInteraction();
+	}
+}
@@ -7,14 +7,21 @@
 #include "SideScrollingInteractable.h"
 #include "SideScrollingMovingPlatform.generated.h"
 
+class USideScrollingPlatformMoverComponent;
+
 /**
  *  Simple moving platform that can be triggered through interactions by other actors.
- *  The actual movement is performed by Blueprint code through latent execution nodes.
+ *  By default the movement is performed by Blueprint code through latent execution nodes.
+ *  With native movement enabled, the platform instead moves to its target and back, driven by the synchronized server time.
  */
 UCLASS(abstract)
 class ASideScrollingMovingPlatform : public AActor, public ISideScrollingInteractable
 {
 	GENERATED_BODY()
+
+	/** Moves the platform along its paths */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Components", meta = (AllowPrivateAccess = "true"))
+	USideScrollingPlatformMoverComponent* Mover;
 	
 public:	
 	
@@ -38,6 +45,16 @@ protected:
 	UPROPERTY(EditAnywhere, Category="Moving Platform")
 	bool bOneShot = false;
 
+	/** If true, the platform is moved natively by the mover component. If false, movement is left to Blueprint code. Off by default so existing Blueprint platforms keep their movement */
+	UPROPERTY(EditAnywhere, Category="Moving Platform")
+	bool bNativeMovement = false;
+
+	/** Path index for the move to the target */
+	static constexpr int32 ToTargetPath = 0;
+
+	/** Path index for the move back to the starting location */
+	static constexpr int32 ReturnPath = 1;
+
 public:
 
 // ~begin IInteractable interface 
@@ -53,6 +70,12 @@ public:
 
 protected:
 
+	/** Builds the mover paths from the platform target */
+	virtual void BeginPlay() override;
+
+	/** Chains the return move and resets the platform once it's back */
+	void OnMoveFinished(int32 PathId);
+
 	/** Allows Blueprint code to do the actual platform movement */
 	UFUNCTION(BlueprintImplementableEvent, BlueprintCallable, Category="Moving Platform", meta = (DisplayName="Move to Target"))
 	void BP_MoveToTarget();
@@ -0,0 +1,208 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "SideScrollingPickupField.h"
+#include "SideScrollingGameMode.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "GameFramework/Pawn.h"
+#include "TPSPlayerCacheSubsystem.h"
+#include "Net/UnrealNetwork.h"
+#include "Algo/BinarySearch.h"
+#include "Algo/StableSort.h"
+#include "Engine/World.h"
+
+ASideScrollingPickupField::ASideScrollingPickupField()
+{
+	PrimaryActorTick.bCanEverTick = true;
+
+	// the collected pickups are replicated
+	bReplicates = true;
+
+	// create the instanced mesh. Pickups don't need collision since they're tested manually
+	RootComponent = Instances = CreateDefaultSubobject<UInstancedStaticMeshComponent>(TEXT("Instances"));
+
+	Instances->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Instances->SetCanEverAffectNavigation(false);
+
+	// swap the last instance into removed slots so removals don't shift every instance after them
+	Instances->bSupportRemoveAtSwap = true;
+}
+
+void ASideScrollingPickupField::OnConstruction(const FTransform& Transform)
+{
+	Super::OnConstruction(Transform);
+
+	BuildPickups();
+}
+
+void ASideScrollingPickupField::BeginPlay()
+{
+	Super::BeginPlay();
+
+	BuildPickups();
+
+	// size the collected pickup bitfield
+	if (HasAuthority())
+	{
+		CollectedPickups.SetNumZeroed(FMath::DivideAndRoundUp(Pickups.Num(), 8));
+	}
+	else
+	{
+		// the bitfield may have arrived before BeginPlay
+		OnRep_CollectedPickups();
+	}
+}
+
+void ASideScrollingPickupField::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	// only the server collects pickups
+	if (!HasAuthority() || InstancePickups.IsEmpty())
+	{
+		return;
+	}
+
+	if (UTPSPlayerCacheSubsystem* PlayerCache = UTPSPlayerCacheSubsystem::Get(GetWorld()))
+	{
+		for (const FTPSCachedPlayer& Player : PlayerCache->GetPlayers())
+		{
+			if (APawn* Pawn = Player.Pawn.Get())
+			{
+				CollectPickupsForPawn(Pawn, Player.Location);
+			}
+		}
+	}
+}
+
+void ASideScrollingPickupField::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(ASideScrollingPickupField, CollectedPickups);
+}
+
+void ASideScrollingPickupField::OnRep_CollectedPickups()
+{
+	// remove the instances of any pickups the server collected
+	for (int32 PickupIndex = 0; PickupIndex < Pickups.Num(); ++PickupIndex)
+	{
+		if (Pickups[PickupIndex].InstanceIndex != INDEX_NONE && IsCollected(PickupIndex))
+		{
+			RemovePickup(PickupIndex);
+			BP_OnPickedUp(Pickups[PickupIndex].Location);
+		}
+	}
+}
+
+void ASideScrollingPickupField::BuildPickups()
+{
+	const FTransform& ActorTransform = GetActorTransform();
+
+	// convert the pickups to world space and sort them along the side scrolling axis
+	Pickups.Reset(PickupLocations.Num());
+
+	for (const FVector& RelativeLocation : PickupLocations)
+	{
+		FPickupEntry& Entry = Pickups.AddDefaulted_GetRef();
+		Entry.Location = ActorTransform.TransformPosition(RelativeLocation);
+	}
+
+	Algo::StableSortBy(Pickups, [](const FPickupEntry& Entry) { return Entry.Location.X; });
+
+	// add one instance per pickup, in sorted order
+	TArray<FTransform> InstanceTransforms;
+	InstanceTransforms.Reserve(Pickups.Num());
+
+	InstancePickups.Reset(Pickups.Num());
+
+	for (int32 PickupIndex = 0; PickupIndex < Pickups.Num(); ++PickupIndex)
+	{
+		Pickups[PickupIndex].InstanceIndex = PickupIndex;
+		InstancePickups.Add(PickupIndex);
+		InstanceTransforms.Emplace(Pickups[PickupIndex].Location);
+	}
+
+	Instances->ClearInstances();
+	Instances->AddInstances(InstanceTransforms, false, true);
+}
+
+void ASideScrollingPickupField::CollectPickupsForPawn(APawn* Pawn, const FVector& PawnLocation)
+{
+	float CapsuleRadius = 0.0f;
+	float CapsuleHalfHeight = 0.0f;
+	Pawn->GetSimpleCollisionCylinder(CapsuleRadius, CapsuleHalfHeight);
+
+	const float CollectRadius = PickupRadius + CapsuleRadius;
+	const float SegmentHalfHeight = FMath::Max(0.0f, CapsuleHalfHeight - CapsuleRadius);
+
+	// find the first pickup within the pawn's horizontal range
+	const int32 FirstIndex = Algo::LowerBoundBy(Pickups, PawnLocation.X - CollectRadius, [](const FPickupEntry& Entry) { return Entry.Location.X; });
+
+	for (int32 PickupIndex = FirstIndex; PickupIndex < Pickups.Num(); ++PickupIndex)
+	{
+		const FPickupEntry& Entry = Pickups[PickupIndex];
+
+		// past the end of the range
+		if (Entry.Location.X > PawnLocation.X + CollectRadius)
+		{
+			break;
+		}
+
+		if (Entry.InstanceIndex == INDEX_NONE)
+		{
+			continue;
+		}
+
+		// test the pickup sphere against the pawn's capsule
+		const FVector ClosestPoint(PawnLocation.X, PawnLocation.Y, FMath::Clamp(Entry.Location.Z, PawnLocation.Z - SegmentHalfHeight, PawnLocation.Z + SegmentHalfHeight));
+
+		if (FVector::DistSquared(ClosestPoint, Entry.Location) > FMath::Square(CollectRadius))
+		{
+			continue;
+		}
+
+		// get the game mode
+		if (ASideScrollingGameMode* GM = Cast<ASideScrollingGameMode>(GetWorld()->GetAuthGameMode()))
+		{
+			// tell the game mode to process a pickup
+			GM->ProcessPickup();
+		}
+
+		// flag the pickup for replication and remove it
+		CollectedPickups[PickupIndex / 8] |= 1 << (PickupIndex % 8);
+
+		RemovePickup(PickupIndex);
+
+		// call the BP handler to play effects
+		BP_OnPickedUp(Entry.Location);
+	}
+}
+
+void ASideScrollingPickupField::RemovePickup(int32 PickupIndex)
+{
+	const int32 InstanceIndex = Pickups[PickupIndex].InstanceIndex;
+	Pickups[PickupIndex].InstanceIndex = INDEX_NONE;
+
+	// the instanced mesh moves its last instance into the removed slot, so mirror that in our lookup
+	Instances->RemoveInstance(InstanceIndex);
+
+	const int32 LastInstanceIndex = InstancePickups.Num() - 1;
+
+	if (InstanceIndex != LastInstanceIndex)
+	{
+		const int32 MovedPickupIndex = InstancePickups[LastInstanceIndex];
+
+		InstancePickups[InstanceIndex] = MovedPickupIndex;
+		Pickups[MovedPickupIndex].InstanceIndex = InstanceIndex;
+	}
+
+	InstancePickups.RemoveAt(LastInstanceIndex, EAllowShrinking::No);
+}
+
+bool ASideScrollingPickupField::IsCollected(int32 PickupIndex) const
+{
+	const int32 ByteIndex = PickupIndex / 8;
+
+	return CollectedPickups.IsValidIndex(ByteIndex) && (CollectedPickups[ByteIndex] & (1 << (PickupIndex % 8))) != 0;
+}
@@ -0,0 +1,97 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "SideScrollingPickupField.generated.h"
+
+class UInstancedStaticMeshComponent;
+
+/**
+ *  A large set of side scrolling pickups drawn as a single instanced static mesh.
+ *  Pickups have no collision of their own: they're kept sorted along the side scrolling axis,
+ *  and each frame only the pickups within the players' horizontal range are tested, found through a binary search.
+ *  Collected pickups are removed from the instanced mesh and counted on the GameMode like regular pickups.
+ */
+UCLASS(abstract)
+class ASideScrollingPickupField : public AActor
+{
+	GENERATED_BODY()
+
+	/** Instanced mesh drawing all uncollected pickups */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category ="Components", meta = (AllowPrivateAccess = "true"))
+	UInstancedStaticMeshComponent* Instances;
+
+	/** A single pickup */
+	struct FPickupEntry
+	{
+		/** World location of the pickup */
+		FVector Location = FVector::ZeroVector;
+
+		/** Index of the pickup's mesh instance, or INDEX_NONE once collected */
+		int32 InstanceIndex = INDEX_NONE;
+	};
+
+	/** Pickups, sorted by X */
+	TArray<FPickupEntry> Pickups;
+
+	/** Maps each mesh instance back to its pickup */
+	TArray<int32> InstancePickups;
+
+	/** One bit per pickup, in sorted order, set once the pickup has been collected */
+	UPROPERTY(ReplicatedUsing=OnRep_CollectedPickups)
+	TArray<uint8> CollectedPickups;
+
+protected:
+
+	/** Pickup locations, relative to the actor */
+	UPROPERTY(EditAnywhere, Category="Pickup Field", meta = (MakeEditWidget))
+	TArray<FVector> PickupLocations;
+
+	/** Radius around each pickup that collects it */
+	UPROPERTY(EditAnywhere, Category="Pickup Field", meta = (ClampMin = 0, ClampMax = 1000, Units = "cm"))
+	float PickupRadius = 100.0f;
+
+public:
+
+	/** Constructor */
+	ASideScrollingPickupField();
+
+	/** Returns the number of pickups that haven't been collected yet */
+	int32 GetNumRemainingPickups() const { return InstancePickups.Num(); }
+
+protected:
+
+	/** Rebuilds the pickup instances for editor previews */
+	virtual void OnConstruction(const FTransform& Transform) override;
+
+	/** Sorts the pickups and builds their instances */
+	virtual void BeginPlay() override;
+
+	/** Checks the players against the pickups in their range */
+	virtual void Tick(float DeltaSeconds) override;
+
+	/** Sets up replication */
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	/** Removes the pickups collected on the server */
+	UFUNCTION()
+	void OnRep_CollectedPickups();
+
+	/** Rebuilds the sorted pickup list and the mesh instances */
+	void BuildPickups();
+
+	/** Collects the pickups overlapping a pawn */
+	void CollectPickupsForPawn(APawn* Pawn, const FVector& PawnLocation);
+
+	/** Marks a pickup as collected and removes its instance */
+	void RemovePickup(int32 PickupIndex);
+
+	/** Returns true if the pickup has been collected */
+	bool IsCollected(int32 PickupIndex) const;
+
+	/** Passes control to BP to play effects on pickup */
+	UFUNCTION(BlueprintImplementableEvent, Category="Pickup", meta = (DisplayName = "On Picked Up"))
+	void BP_OnPickedUp(const FVector& PickupLocation);
+};
@@ -0,0 +1,208 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "SideScrollingPlatformMoverComponent.h"
+#include "GameFramework/Actor.h"
+#include "GameFramework/GameStateBase.h"
+#include "Components/SceneComponent.h"
+#include "Net/UnrealNetwork.h"
+#include "Engine/World.h"
+
+USideScrollingPlatformMoverComponent::USideScrollingPlatformMoverComponent()
+{
+	// only tick while a move is in progress
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+
+	// move before characters so riders pick up the platform's new location this frame
+	PrimaryComponentTick.TickGroup = TG_PrePhysics;
+
+	SetIsReplicatedByDefault(true);
+}
+
+void USideScrollingPlatformMoverComponent::SetPaths(const TArray<FSideScrollingPlatformPath>& InPaths)
+{
+	Paths = InPaths;
+}
+
+void USideScrollingPlatformMoverComponent::StartMove(int32 PathId, double StartTime)
+{
+	AActor* Owner = GetOwner();
+
+	// only the server starts moves
+	if (!Owner || !Owner->HasAuthority() || !Paths.IsValidIndex(PathId))
+	{
+		return;
+	}
+
+	CurrentMove.StartTime = StartTime >= 0.0 ? StartTime : GetServerTime();
+	CurrentMove.PathId = static_cast<int8>(PathId);
+
+	// wake the owner up so the new move goes out
+	Owner->FlushNetDormancy();
+
+	SetComponentTickEnabled(true);
+	UpdateMove();
+}
+
+bool USideScrollingPlatformMoverComponent::IsMoving() const
+{
+	return IsComponentTickEnabled();
+}
+
+double USideScrollingPlatformMoverComponent::GetMoveEndTime() const
+{
+	return Paths.IsValidIndex(CurrentMove.PathId) ? CurrentMove.StartTime + Paths[CurrentMove.PathId].Duration : CurrentMove.StartTime;
+}
+
+FVector USideScrollingPlatformMoverComponent::EvaluatePath(int32 PathId, float Alpha) const
+{
+	if (!Paths.IsValidIndex(PathId) || Paths[PathId].Points.IsEmpty())
+	{
+		return HomeLocation;
+	}
+
+	const FSideScrollingPlatformPath& Path = Paths[PathId];
+	const TArray<FVector>& Points = Path.Points;
+
+	if (Points.Num() == 1)
+	{
+		return HomeLocation + Points[0];
+	}
+
+	// ease over the whole path
+	Alpha = FMath::Clamp(Alpha, 0.0f, 1.0f);
+
+	if (Path.EaseExponent > 1.0f)
+	{
+		Alpha = FMath::InterpEaseInOut(0.0f, 1.0f, Alpha, Path.EaseExponent);
+	}
+
+	// find the segment containing the alpha, so the platform moves at the same speed on every segment
+	double TotalLength = 0.0;
+
+	for (int32 i = 1; i < Points.Num(); ++i)
+	{
+		TotalLength += FVector::Dist(Points[i - 1], Points[i]);
+	}
+
+	double TargetLength = TotalLength * Alpha;
+	int32 Segment = 0;
+	double SegmentAlpha = 1.0;
+
+	for (; Segment < Points.Num() - 1; ++Segment)
+	{
+		const double SegmentLength = FVector::Dist(Points[Segment], Points[Segment + 1]);
+
+		if (TargetLength <= SegmentLength || Segment == Points.Num() - 2)
+		{
+			SegmentAlpha = SegmentLength > UE_KINDA_SMALL_NUMBER ? FMath::Clamp(TargetLength / SegmentLength, 0.0, 1.0) : 1.0;
+			break;
+		}
+
+		TargetLength -= SegmentLength;
+	}
+
+	const FVector& P1 = Points[Segment];
+	const FVector& P2 = Points[Segment + 1];
+
+	if (!Path.bSmooth)
+	{
+		return HomeLocation + FMath::Lerp(P1, P2, SegmentAlpha);
+	}
+
+	// Catmull-Rom through the waypoints, mirroring the end points for the outer tangents
+	const FVector& P0 = Points.IsValidIndex(Segment - 1) ? Points[Segment - 1] : P1 - (P2 - P1);
+	const FVector& P3 = Points.IsValidIndex(Segment + 2) ? Points[Segment + 2] : P2 + (P2 - P1);
+
+	return HomeLocation + FMath::CubicInterp(P1, (P2 - P0) * 0.5, P2, (P3 - P1) * 0.5, SegmentAlpha);
+}
+
+double USideScrollingPlatformMoverComponent::GetServerTime() const
+{
+	const UWorld* World = GetWorld();
+
+	if (!World)
+	{
+		return 0.0;
+	}
+
+	// the game state keeps the server time in sync on clients
+	if (const AGameStateBase* GameState = World->GetGameState())
+	{
+		return GameState->GetServerWorldTimeSeconds();
+	}
+
+	return World->GetTimeSeconds();
+}
+
+void USideScrollingPlatformMoverComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// paths are relative to where the platform was placed, which is the same on every machine
+	if (AActor* Owner = GetOwner())
+	{
+		HomeLocation = Owner->GetActorLocation();
+		bHasHome = true;
+	}
+
+	// the move may have replicated in before play started
+	if (Paths.IsValidIndex(CurrentMove.PathId))
+	{
+		OnRep_CurrentMove();
+	}
+}
+
+void USideScrollingPlatformMoverComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	UpdateMove();
+}
+
+void USideScrollingPlatformMoverComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(USideScrollingPlatformMoverComponent, CurrentMove);
+}
+
+void USideScrollingPlatformMoverComponent::OnRep_CurrentMove()
+{
+	// wait for BeginPlay to capture the home location
+	if (!bHasHome || !Paths.IsValidIndex(CurrentMove.PathId))
+	{
+		return;
+	}
+
+	SetComponentTickEnabled(true);
+	UpdateMove();
+}
+
+void USideScrollingPlatformMoverComponent::UpdateMove()
+{
+	AActor* Owner = GetOwner();
+
+	if (!Owner || !Paths.IsValidIndex(CurrentMove.PathId))
+	{
+		SetComponentTickEnabled(false);
+		return;
+	}
+
+	const FSideScrollingPlatformPath& Path = Paths[CurrentMove.PathId];
+
+	// the position depends only on the time since the move started
+	const double Elapsed = GetServerTime() - CurrentMove.StartTime;
+	const float Alpha = static_cast<float>(FMath::Clamp(Elapsed / Path.Duration, 0.0, 1.0));
+
+	Owner->SetActorLocation(EvaluatePath(CurrentMove.PathId, Alpha));
+
+	// finish the move once we reach the end
+	if (Alpha >= 1.0f)
+	{
+		SetComponentTickEnabled(false);
+
+		OnMoveFinished.ExecuteIfBound(CurrentMove.PathId);
+	}
+}
@@ -0,0 +1,128 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "SideScrollingPlatformMoverComponent.generated.h"
+
+/** Platform move finished delegate */
+DECLARE_DELEGATE_OneParam(FOnPlatformMoveFinished, int32 /* PathId */);
+
+/**
+ *  A waypoint path a platform can travel along
+ */
+USTRUCT(BlueprintType)
+struct FSideScrollingPlatformPath
+{
+	GENERATED_BODY()
+
+	/** Waypoints, as offsets from the platform's starting location */
+	UPROPERTY(EditAnywhere, Category="Path")
+	TArray<FVector> Points;
+
+	/** Time to travel the whole path */
+	UPROPERTY(EditAnywhere, Category="Path", meta = (ClampMin = 0.01, ClampMax = 60, Units="s"))
+	float Duration = 5.0f;
+
+	/** Easing exponent applied over the whole path. 1 moves at constant speed */
+	UPROPERTY(EditAnywhere, Category="Path", meta = (ClampMin = 1, ClampMax = 8))
+	float EaseExponent = 2.0f;
+
+	/** If true, the path is smoothed through the waypoints instead of following straight segments */
+	UPROPERTY(EditAnywhere, Category="Path")
+	bool bSmooth = false;
+};
+
+/**
+ *  Replicated state of a platform move
+ */
+USTRUCT()
+struct FSideScrollingPlatformMove
+{
+	GENERATED_BODY()
+
+	/** Server world time the move started at */
+	UPROPERTY()
+	double StartTime = 0.0;
+
+	/** Index of the path being travelled, or INDEX_NONE if the platform never moved */
+	UPROPERTY()
+	int8 PathId = INDEX_NONE;
+};
+
+/**
+ *  Moves its owner's root component along waypoint paths as a pure function of the synchronized server world time.
+ *  Only the start time and path index of each move are replicated, so clients evaluate the same positions locally
+ *  without any per-frame transform replication, and characters based on the platform move smoothly on every machine.
+ */
+UCLASS(ClassGroup=(SideScrolling), meta=(BlueprintSpawnableComponent))
+class USideScrollingPlatformMoverComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+	/** Currently playing or last played move */
+	UPROPERTY(ReplicatedUsing=OnRep_CurrentMove)
+	FSideScrollingPlatformMove CurrentMove;
+
+	/** Owner's root location when play started. Paths are relative to this */
+	FVector HomeLocation = FVector::ZeroVector;
+
+	/** If true, HomeLocation has been captured */
+	bool bHasHome = false;
+
+protected:
+
+	/** Paths the platform can travel along */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Platform Mover")
+	TArray<FSideScrollingPlatformPath> Paths;
+
+public:
+
+	/** Constructor */
+	USideScrollingPlatformMoverComponent();
+
+	/** Called on every machine when a move reaches the end of its path */
+	FOnPlatformMoveFinished OnMoveFinished;
+
+	/** Replaces the paths. Only valid before any move is started */
+	void SetPaths(const TArray<FSideScrollingPlatformPath>& InPaths);
+
+	/** Returns true if a path with this index exists */
+	bool HasPath(int32 PathId) const { return Paths.IsValidIndex(PathId); }
+
+	/** Starts travelling along a path. Authority only. If no start time is provided, the current server time is used */
+	void StartMove(int32 PathId, double StartTime = -1.0);
+
+	/** Returns true if a move is in progress */
+	bool IsMoving() const;
+
+	/** Returns the server time a move would end at */
+	double GetMoveEndTime() const;
+
+	/** Returns the location along a path at the provided alpha, in world space */
+	FVector EvaluatePath(int32 PathId, float Alpha) const;
+
+	/** Returns the current synchronized server world time */
+	double GetServerTime() const;
+
+public:
+
+	/** Captures the home location */
+	virtual void BeginPlay() override;
+
+	/** Moves the owner along the current path */
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	/** Sets up replication */
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+protected:
+
+	/** Picks up a move started by the server */
+	UFUNCTION()
+	void OnRep_CurrentMove();
+
+	/** Places the owner for the current server time, and finishes the move if it's past the end */
+	void UpdateMove();
+};
@@ -6,9 +6,13 @@
 #include "Engine/HitResult.h"
 #include "CollisionQueryParams.h"
 #include "Engine/World.h"
+#include "SideScrollingGroundCacheSubsystem.h"
+#include "ThirdPersonMPStats.h"
 
 void ASideScrollingCameraManager::UpdateViewTarget(FTViewTarget& OutVT, float DeltaTime)
 {
+	TPS_SCOPED_TIMER(CameraUpdate, TPSCamera);
+
 	// ensure the view target is a pawn
 	APawn* TargetPawn = Cast<APawn>(OutVT.Target);
 
@@ -55,12 +59,23 @@ void ASideScrollingCameraManager::UpdateViewTarget(FTViewTarget& OutVT, float De
 			// determine if we need to do a height update
 			bZUpdate = FMath::IsNearlyEqual(CurrentZ, CurrentCameraLocation.Z, 25.0f);
 
+		} else if (USideScrollingGroundCacheSubsystem* GroundCache = GetGroundCache()) {
+
+			// look up the ground below the character in the ground cache
+			FSideScrollingGroundFilter Filter;
+			Filter.bVisibilityBlockersOnly = true;
+
+			float GroundZ = 0.0f;
+
+			// only update height if we're not about to hit ground
+			bZUpdate = !GroundCache->FindGroundBelow(CurrentActorLocation, GroundCheckDistance, Filter, GroundZ);
+
 		} else {
 
 			// run a trace below the character to determine if we need to do a height update
 			FHitResult OutHit;
 
-			const FVector End = CurrentActorLocation + FVector(0.0f, 0.0f, -1000.0f);
+			const FVector End = CurrentActorLocation + FVector(0.0f, 0.0f, -GroundCheckDistance);
 
 			FCollisionQueryParams QueryParams;
 			QueryParams.AddIgnoredActor(TargetPawn);
@@ -102,4 +117,11 @@ void ASideScrollingCameraManager::UpdateViewTarget(FTViewTarget& OutVT, float De
 
 		OutVT.POV.Location = FMath::VInterpTo(CurrentCameraLocation, TargetCameraLocation, DeltaTime, 2.0f);
 	}
-}
\ No newline at end of file
+}
+
+USideScrollingGroundCacheSubsystem* ASideScrollingCameraManager::GetGroundCache() const
+{
+	USideScrollingGroundCacheSubsystem* GroundCache = USideScrollingGroundCacheSubsystem::Get(GetWorld());
+
+	return GroundCache && GroundCache->IsAvailable() ? GroundCache : nullptr;
+}
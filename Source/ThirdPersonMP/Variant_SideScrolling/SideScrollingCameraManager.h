@@ -6,6 +6,8 @@
 #include "Camera/PlayerCameraManager.h"
 #include "SideScrollingCameraManager.generated.h"
 
+class USideScrollingGroundCacheSubsystem;
+
 /**
  *  Simple side scrolling camera with smooth scrolling and horizontal bounds
  */
@@ -37,6 +39,10 @@ public:
 	UPROPERTY(EditAnywhere, Category="Side Scrolling Camera", meta=(ClampMin=-100000, ClampMax=100000, Units="cm"))
 	float CameraXMaxBounds = 10000.0f;
 
+	/** How far below an airborne target we look for ground before following it vertically */
+	UPROPERTY(EditAnywhere, Category="Side Scrolling Camera", meta=(ClampMin=0, ClampMax=10000, Units="cm"))
+	float GroundCheckDistance = 1000.0f;
+
 protected:
 
 	/** Last cached camera vertical location. The camera only adjusts its height if necessary. */
@@ -44,4 +50,7 @@ protected:
 
 	/** First-time update camera setup flag */
 	bool bSetup = true;
+
+	/** Returns the ground cache, if it's available for queries */
+	USideScrollingGroundCacheSubsystem* GetGroundCache() const;
 };
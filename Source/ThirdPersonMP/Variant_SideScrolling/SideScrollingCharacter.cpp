@@ -13,8 +13,11 @@
 #include "SideScrollingInteractable.h"
 #include "Kismet/KismetMathLibrary.h"
 #include "TimerManager.h"
+#include "SideScrollingCharacterMovementComponent.h"
+#include "SideScrollingGroundCacheSubsystem.h"
 
-ASideScrollingCharacter::ASideScrollingCharacter()
+ASideScrollingCharacter::ASideScrollingCharacter(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<USideScrollingCharacterMovementComponent>(ACharacter::CharacterMovementComponentName))
 {
 	PrimaryActorTick.bCanEverTick = true;
 
@@ -59,6 +62,17 @@ ASideScrollingCharacter::ASideScrollingCharacter()
 	JumpMaxCount = 3;
 }
 
+void ASideScrollingCharacter::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// tell the movement component which platforms are one-way
+	if (USideScrollingCharacterMovementComponent* SideScrollingMovement = Cast<USideScrollingCharacterMovementComponent>(GetCharacterMovement()))
+	{
+		SideScrollingMovement->SetOneWayPlatformObjectType(SoftCollisionObjectType);
+	}
+}
+
 void ASideScrollingCharacter::EndPlay(EEndPlayReason::Type EndPlayReason)
 {
 	Super::EndPlay(EndPlayReason);
@@ -187,6 +201,23 @@ void ASideScrollingCharacter::DoJumpEnd()
 }
 
 void ASideScrollingCharacter::DoInteract()
+{
+	// interact locally right away
+	InteractWithNearest();
+
+	// input only runs on the owning client, so let the server run the interaction too
+	if (!HasAuthority())
+	{
+		ServerInteract();
+	}
+}
+
+void ASideScrollingCharacter::ServerInteract_Implementation()
+{
+	InteractWithNearest();
+}
+
+void ASideScrollingCharacter::InteractWithNearest()
 {
 	// do a sphere trace to look for interactive objects
 	FHitResult OutHit;
@@ -305,6 +336,26 @@ void ASideScrollingCharacter::CheckForSoftCollision()
 	// reset the drop value
 	DropValue = 0.0f;
 
+	// look up the soft floor below us in the ground cache, if it's available
+	USideScrollingGroundCacheSubsystem* GroundCache = USideScrollingGroundCacheSubsystem::Get(GetWorld());
+
+	if (GroundCache && GroundCache->IsAvailable())
+	{
+		FSideScrollingGroundFilter Filter;
+		Filter.ObjectType = SoftCollisionObjectType;
+
+		float GroundZ = 0.0f;
+
+		// did we find a soft floor?
+		if (GroundCache->FindGroundBelow(GetActorLocation(), SoftCollisionTraceDistance, Filter, GroundZ))
+		{
+			// drop through the floor
+			DropThroughSoftPlatform();
+		}
+
+		return;
+	}
+
 	// trace down 
 	FHitResult OutHit;
 
@@ -323,7 +374,7 @@ void ASideScrollingCharacter::CheckForSoftCollision()
 	if (OutHit.GetActor())
 	{
 		// drop through the floor
-		SetSoftCollision(true);
+		DropThroughSoftPlatform();
 	}
 }
 
@@ -333,10 +384,13 @@ void ASideScrollingCharacter::ResetWallJump()
 	bHasWallJumped = false;
 }
 
-void ASideScrollingCharacter::SetSoftCollision(bool bEnabled)
+void ASideScrollingCharacter::DropThroughSoftPlatform()
 {
-	// enable or disable collision response to the soft collision channel
-	GetCapsuleComponent()->SetCollisionResponseToChannel(SoftCollisionObjectType, bEnabled ? ECR_Ignore : ECR_Block);
+	// let the movement component ignore the platform we're standing on until we've fallen through it
+	if (USideScrollingCharacterMovementComponent* SideScrollingMovement = Cast<USideScrollingCharacterMovementComponent>(GetCharacterMovement()))
+	{
+		SideScrollingMovement->RequestDropThrough();
+	}
 }
 
 bool ASideScrollingCharacter::HasDoubleJumped() const
@@ -64,7 +64,7 @@ protected:
 	UPROPERTY(EditAnywhere, Category="Side Scrolling|Wall Jump")
 	float WallJumpVerticalMultiplier = 1.4f;
 
-	/** Collision object type to use for soft collision traces (dropping down floors) */
+	/** Collision object type of soft platforms. Used for drop traces and one-way platform movement */
 	UPROPERTY(EditAnywhere, Category="Side Scrolling|Soft Platforms")
 	TEnumAsByte<ECollisionChannel> SoftCollisionObjectType;
 
@@ -100,10 +100,13 @@ protected:
 public:
 	
 	/** Constructor */
-	ASideScrollingCharacter();
+	ASideScrollingCharacter(const FObjectInitializer& ObjectInitializer);
 
 protected:
 
+	/** Gameplay initialization */
+	virtual void BeginPlay() override;
+
 	/** Gameplay cleanup */
 	virtual void EndPlay(EEndPlayReason::Type EndPlayReason) override;
 
@@ -154,6 +157,13 @@ public:
 
 protected:
 
+	/** Sweeps in front of the character and interacts with the first interactable found */
+	void InteractWithNearest();
+
+	/** Runs the interaction on the server, so server driven interactables react for every player */
+	UFUNCTION(Server, Reliable)
+	void ServerInteract();
+
 	/** Handles advanced jump logic */
 	void MultiJump();
 
@@ -165,8 +175,8 @@ protected:
 
 public:
 
-	/** Sets the soft collision response. True passes, False blocks */
-	void SetSoftCollision(bool bEnabled);
+	/** Drops through the soft platform the character is standing on */
+	void DropThroughSoftPlatform();
 
 public:
 
@@ -0,0 +1,266 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "SideScrollingCharacterMovementComponent.h"
+#include "Components/PrimitiveComponent.h"
+#include "GameFramework/Character.h"
+#include "Engine/World.h"
+
+namespace SideScrollingMovement
+{
+	/** Maximum number of one-way platforms a single move can pass through */
+	static constexpr int32 MaxPassThroughsPerMove = 4;
+
+	/** Height tolerance when deciding if the capsule is landing on top of a platform */
+	static constexpr float LandingTolerance = 2.0f;
+}
+
+/**
+ *  Saved move that also captures the drop-through input,
+ *  so the server and replayed moves drop through the platform on the same move
+ */
+class FSavedMove_SideScrolling : public FSavedMove_Character
+{
+public:
+
+	typedef FSavedMove_Character Super;
+
+	/** Drop-through input */
+	uint8 bSavedWantsToDropThrough : 1;
+
+	virtual void Clear() override
+	{
+		Super::Clear();
+
+		bSavedWantsToDropThrough = false;
+	}
+
+	virtual uint8 GetCompressedFlags() const override
+	{
+		uint8 Result = Super::GetCompressedFlags();
+
+		if (bSavedWantsToDropThrough)
+		{
+			Result |= FLAG_Custom_0;
+		}
+
+		return Result;
+	}
+
+	virtual bool CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const override
+	{
+		// never merge away a drop-through request
+		if (bSavedWantsToDropThrough || static_cast<const FSavedMove_SideScrolling*>(NewMove.Get())->bSavedWantsToDropThrough)
+		{
+			return false;
+		}
+
+		return Super::CanCombineWith(NewMove, InCharacter, MaxDelta);
+	}
+
+	virtual void SetMoveFor(ACharacter* Character, float InDeltaTime, FVector const& NewAccel, FNetworkPredictionData_Client_Character& ClientData) override
+	{
+		Super::SetMoveFor(Character, InDeltaTime, NewAccel, ClientData);
+
+		if (const USideScrollingCharacterMovementComponent* Movement = Cast<USideScrollingCharacterMovementComponent>(Character->GetCharacterMovement()))
+		{
+			bSavedWantsToDropThrough = Movement->bWantsToDropThrough;
+		}
+	}
+};
+
+/**
+ *  Client prediction data that allocates side scrolling saved moves
+ */
+class FNetworkPredictionData_Client_SideScrolling : public FNetworkPredictionData_Client_Character
+{
+public:
+
+	typedef FNetworkPredictionData_Client_Character Super;
+
+	FNetworkPredictionData_Client_SideScrolling(const UCharacterMovementComponent& ClientMovement)
+		: Super(ClientMovement)
+	{
+	}
+
+	virtual FSavedMovePtr AllocateNewMove() override
+	{
+		return FSavedMovePtr(new FSavedMove_SideScrolling());
+	}
+};
+
+USideScrollingCharacterMovementComponent::USideScrollingCharacterMovementComponent()
+{
+	// initialize the flags
+	bWantsToDropThrough = false;
+}
+
+void USideScrollingCharacterMovementComponent::SetOneWayPlatformObjectType(ECollisionChannel ObjectType)
+{
+	OneWayPlatformObjectType = ObjectType;
+	bHasOneWayPlatforms = true;
+}
+
+FNetworkPredictionData_Client* USideScrollingCharacterMovementComponent::GetPredictionData_Client() const
+{
+	if (ClientPredictionData == nullptr)
+	{
+		USideScrollingCharacterMovementComponent* MutableThis = const_cast<USideScrollingCharacterMovementComponent*>(this);
+		MutableThis->ClientPredictionData = new FNetworkPredictionData_Client_SideScrolling(*this);
+	}
+
+	return ClientPredictionData;
+}
+
+void USideScrollingCharacterMovementComponent::UpdateFromCompressedFlags(uint8 Flags)
+{
+	Super::UpdateFromCompressedFlags(Flags);
+
+	bWantsToDropThrough = (Flags & FSavedMove_Character::FLAG_Custom_0) != 0;
+}
+
+void USideScrollingCharacterMovementComponent::UpdateCharacterStateBeforeMovement(float DeltaSeconds)
+{
+	Super::UpdateCharacterStateBeforeMovement(DeltaSeconds);
+
+	// consume the drop-through request as part of the move, so it happens at the same point on every machine
+	if (bWantsToDropThrough)
+	{
+		bWantsToDropThrough = false;
+		DropThroughFloor();
+	}
+}
+
+bool USideScrollingCharacterMovementComponent::DropThroughFloor()
+{
+	// are we standing on a one-way platform?
+	if (!IsMovingOnGround() || !CurrentFloor.IsWalkableFloor() || !IsOneWayPlatform(CurrentFloor.HitResult.GetComponent()))
+	{
+		return false;
+	}
+
+	// ignore it for a while so we don't land back on it before we've cleared it
+	PassThroughPlatform(CurrentFloor.HitResult.GetComponent(), GetWorld()->GetTimeSeconds() + DropThroughTime);
+
+	// start falling
+	SetMovementMode(MOVE_Falling);
+
+	return true;
+}
+
+bool USideScrollingCharacterMovementComponent::IsOneWayPlatform(const UPrimitiveComponent* Component) const
+{
+	return bHasOneWayPlatforms && Component && Component->GetCollisionObjectType() == OneWayPlatformObjectType;
+}
+
+bool USideScrollingCharacterMovementComponent::MoveUpdatedComponentImpl(const FVector& Delta, const FQuat& NewRotation, bool bSweep, FHitResult* OutHit, ETeleportType Teleport)
+{
+	FHitResult Hit;
+	FVector RemainingDelta = Delta;
+	bool bMoved = Super::MoveUpdatedComponentImpl(RemainingDelta, NewRotation, bSweep, &Hit, Teleport);
+
+	// pass through any one-way platforms we hit from below or from the side, and finish the move
+	for (int32 Attempt = 0; bSweep && Attempt < SideScrollingMovement::MaxPassThroughsPerMove && ShouldPassThrough(Hit); ++Attempt)
+	{
+		PassThroughPlatform(Hit.GetComponent(), 0.0);
+
+		// each pass only covers what's left of the previous one
+		RemainingDelta *= (1.0f - Hit.Time);
+
+		Hit.Reset(1.0f, false);
+		bMoved |= Super::MoveUpdatedComponentImpl(RemainingDelta, NewRotation, bSweep, &Hit, Teleport);
+	}
+
+	if (OutHit)
+	{
+		*OutHit = Hit;
+	}
+
+	return bMoved;
+}
+
+void USideScrollingCharacterMovementComponent::OnMovementUpdated(float DeltaSeconds, const FVector& OldLocation, const FVector& OldVelocity)
+{
+	Super::OnMovementUpdated(DeltaSeconds, OldLocation, OldVelocity);
+
+	if (PassThroughPlatforms.IsEmpty() || !UpdatedPrimitive)
+	{
+		return;
+	}
+
+	const double CurrentTime = GetWorld()->GetTimeSeconds();
+	const FBox CapsuleBounds = UpdatedPrimitive->Bounds.GetBox();
+
+	// stop ignoring platforms once the capsule is fully clear of them
+	PassThroughPlatforms.RemoveAllSwap([this, CurrentTime, &CapsuleBounds](const FPassThroughPlatform& Platform)
+	{
+		UPrimitiveComponent* Component = Platform.Component.Get();
+
+		if (!Component)
+		{
+			return true;
+		}
+
+		if (CurrentTime < Platform.IgnoreUntilTime || CapsuleBounds.Intersect(Component->Bounds.GetBox()))
+		{
+			return false;
+		}
+
+		UpdatedPrimitive->IgnoreComponentWhenMoving(Component, false);
+		return true;
+
+	}, EAllowShrinking::No);
+}
+
+bool USideScrollingCharacterMovementComponent::ShouldPassThrough(const FHitResult& Hit) const
+{
+	if (!Hit.bBlockingHit || !IsOneWayPlatform(Hit.GetComponent()) || !CharacterOwner)
+	{
+		return false;
+	}
+
+	// never fall through the platform we're standing on
+	if (Hit.GetComponent() == CharacterOwner->GetMovementBase())
+	{
+		return false;
+	}
+
+	const float CapsuleBottom = Hit.Location.Z - CharacterOwner->GetSimpleCollisionHalfHeight();
+	const float PlatformTop = Hit.GetComponent()->Bounds.GetBox().Max.Z;
+
+	// starting the move inside the platform means we're already passing through it, unless the platform rose into our feet.
+	// In that case the penetration would push us up onto its top, so let it resolve
+	if (Hit.bStartPenetrating)
+	{
+		const bool bPushedOntoTop = Hit.Normal.Z > 0.0f && CapsuleBottom + Hit.PenetrationDepth >= PlatformTop - SideScrollingMovement::LandingTolerance;
+
+		return !bPushedOntoTop;
+	}
+
+	// block the move if we're landing on top of the platform
+	return CapsuleBottom < PlatformTop - SideScrollingMovement::LandingTolerance;
+}
+
+void USideScrollingCharacterMovementComponent::PassThroughPlatform(UPrimitiveComponent* Platform, double IgnoreUntilTime)
+{
+	if (!UpdatedPrimitive)
+	{
+		return;
+	}
+
+	// extend the ignore time if we're already passing through this platform
+	for (FPassThroughPlatform& Existing : PassThroughPlatforms)
+	{
+		if (Existing.Component == Platform)
+		{
+			Existing.IgnoreUntilTime = FMath::Max(Existing.IgnoreUntilTime, IgnoreUntilTime);
+			return;
+		}
+	}
+
+	UpdatedPrimitive->IgnoreComponentWhenMoving(Platform, true);
+
+	FPassThroughPlatform& NewPlatform = PassThroughPlatforms.AddDefaulted_GetRef();
+	NewPlatform.Component = Platform;
+	NewPlatform.IgnoreUntilTime = IgnoreUntilTime;
+}
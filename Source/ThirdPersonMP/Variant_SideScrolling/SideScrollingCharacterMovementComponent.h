@@ -0,0 +1,92 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TPSCharacterMovementComponent.h"
+#include "SideScrollingCharacterMovementComponent.generated.h"
+
+/**
+ *  Character Movement Component for side scrolling characters.
+ *  Implements one-way (soft) platforms as a movement contact filter: platforms hit from below or from the side
+ *  are added to the capsule's move ignore list until the capsule has cleared them, and the character can drop
+ *  through the platform it's standing on. The capsule's collision responses are never changed.
+ *  Drop-through requests are saved with each move, so the server drops the character on the same move the client did.
+ */
+UCLASS()
+class USideScrollingCharacterMovementComponent : public UTPSCharacterMovementComponent
+{
+	GENERATED_BODY()
+
+	friend class FSavedMove_SideScrolling;
+
+	/** If true, a drop-through has been requested and will happen on the next move */
+	uint8 bWantsToDropThrough : 1;
+
+	/** A one-way platform the character is currently passing through */
+	struct FPassThroughPlatform
+	{
+		/** Platform component being ignored */
+		TWeakObjectPtr<UPrimitiveComponent> Component;
+
+		/** Game time until which the platform stays ignored, even if the capsule has cleared it */
+		double IgnoreUntilTime = 0.0;
+	};
+
+	/** Platforms currently being passed through */
+	TArray<FPassThroughPlatform> PassThroughPlatforms;
+
+	/** Collision object type of one-way platforms */
+	TEnumAsByte<ECollisionChannel> OneWayPlatformObjectType = ECC_WorldStatic;
+
+	/** If false, no platform is treated as one-way */
+	bool bHasOneWayPlatforms = false;
+
+protected:
+
+	/** Minimum time a platform stays ignored after dropping through it */
+	UPROPERTY(EditAnywhere, Category="Character Movement: One-Way Platforms", meta = (ClampMin = 0, ClampMax = 2, Units = "s"))
+	float DropThroughTime = 0.25f;
+
+public:
+
+	/** Constructor */
+	USideScrollingCharacterMovementComponent();
+
+	/** Requests a drop through the one-way platform under the character on the next move */
+	void RequestDropThrough() { bWantsToDropThrough = true; }
+
+	/** Sets the collision object type that identifies one-way platforms */
+	void SetOneWayPlatformObjectType(ECollisionChannel ObjectType);
+
+	/** Returns true if the component is a one-way platform */
+	bool IsOneWayPlatform(const UPrimitiveComponent* Component) const;
+
+public:
+
+	// ~begin UCharacterMovementComponent interface
+	virtual FNetworkPredictionData_Client* GetPredictionData_Client() const override;
+	// ~end UCharacterMovementComponent interface
+
+protected:
+
+	// ~begin UCharacterMovementComponent interface
+	virtual void UpdateFromCompressedFlags(uint8 Flags) override;
+	virtual void UpdateCharacterStateBeforeMovement(float DeltaSeconds) override;
+	// ~end UCharacterMovementComponent interface
+
+	/** Drops through the one-way platform the character is standing on. Returns false if the floor isn't a one-way platform */
+	bool DropThroughFloor();
+
+	/** Moves the capsule, passing through any one-way platforms that aren't being landed on */
+	virtual bool MoveUpdatedComponentImpl(const FVector& Delta, const FQuat& NewRotation, bool bSweep, FHitResult* OutHit = nullptr, ETeleportType Teleport = ETeleportType::None) override;
+
+	/** Stops ignoring the platforms the capsule has cleared */
+	virtual void OnMovementUpdated(float DeltaSeconds, const FVector& OldLocation, const FVector& OldVelocity) override;
+
+	/** Returns true if a blocking hit should be ignored so the capsule can pass through a one-way platform */
+	bool ShouldPassThrough(const FHitResult& Hit) const;
+
+	/** Adds a platform to the capsule's move ignore list */
+	void PassThroughPlatform(UPrimitiveComponent* Platform, double IgnoreUntilTime);
+};